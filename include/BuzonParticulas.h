@@ -0,0 +1,81 @@
+#ifndef BUZON_PARTICULAS_H
+#define BUZON_PARTICULAS_H
+
+#include "ConjuntoParticulas.h"
+#include "ColaMPSC.h"
+#include <atomic>
+
+/**
+ * Peticiones de altas y bajas de partículas desde otros hilos.
+ *
+ * Cualquier hilo (entrada, lógica de juego...) puede pedir que se agregue
+ * una partícula o que se borre la de un manejador sin esperar nunca: las
+ * peticiones van a dos colas sin bloqueos. El hilo de simulación las
+ * aplica todas de una vez con aplicar() entre dos pasos, así que el
+ * conjunto sólo lo modifica él y el bucle de simulación no toma cerrojos.
+ *
+ * Las bajas se aplican antes que las altas. Si una cola está llena la
+ * petición se rechaza (pedirAlta/pedirBaja devuelven false) y se cuenta.
+ * Las altas no devuelven manejador: la partícula no existe hasta que se
+ * aplica la petición.
+ */
+class BuzonParticulas {
+private:
+    ColaMPSC<Particula> altas;
+    ColaMPSC<Manejador> bajas;
+    std::atomic<long> rechazadas;
+
+    // Lo que se saca de las colas en un aplicar() (tamaño de las colas)
+    Particula* bufferAltas;
+    Manejador* bufferBajas;
+
+    long totalAltas;
+    long totalBajas;
+
+public:
+    /**
+     * Constructor
+     * @param capacidad Peticiones pendientes como máximo de cada tipo
+     */
+    BuzonParticulas(int capacidad = 4096);
+
+    BuzonParticulas(const BuzonParticulas&) = delete;
+    BuzonParticulas& operator=(const BuzonParticulas&) = delete;
+
+    ~BuzonParticulas();
+
+    /**
+     * Pide que se agregue una partícula. Desde cualquier hilo, sin esperas
+     * @return false si la cola está llena
+     */
+    bool pedirAlta(const Particula& part);
+
+    /**
+     * Pide que se borre una partícula. Desde cualquier hilo, sin esperas
+     * @return false si la cola está llena
+     */
+    bool pedirBaja(Manejador m);
+
+    /**
+     * Aplica las peticiones pendientes: primero todas las bajas, luego
+     * todas las altas en bloque. Sólo desde el hilo que simula el conjunto,
+     * entre dos pasos
+     * @param nube Conjunto de partículas
+     * @return Número de partículas agregadas más borradas
+     */
+    int aplicar(ConjuntoParticulas& nube);
+
+    /**
+     * Peticiones rechazadas por tener la cola llena
+     */
+    long getRechazadas() const;
+
+    /**
+     * Altas y bajas aplicadas (las bajas de manejadores ya no válidos no
+     * cuentan)
+     */
+    long getAltas() const;
+    long getBajas() const;
+};
+
+#endif // BUZON_PARTICULAS_H
@@ -0,0 +1,113 @@
+#ifndef COLA_MPSC_H
+#define COLA_MPSC_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+
+/**
+ * Cola acotada sin bloqueos para varios productores y un consumidor
+ * (esquema de Vyukov).
+ *
+ * Cada celda lleva un número de secuencia que dice de quién es el turno:
+ * un productor reserva una posición con un compare-and-swap sobre la
+ * cabeza, escribe el dato y publica la celda subiendo su secuencia; el
+ * consumidor lee las celdas en orden cuando su secuencia indica que ya
+ * están escritas. Los productores nunca esperan a nadie: si la cola está
+ * llena, encolar() devuelve false. El consumidor no usa operaciones
+ * atómicas de lectura-modificación-escritura.
+ *
+ * T tiene que ser trivialmente copiable (se guarda sin construir).
+ */
+template <class T>
+class ColaMPSC {
+private:
+    static_assert(std::is_trivially_copyable<T>::value, "ColaMPSC necesita datos trivialmente copiables");
+
+    struct Celda {
+        std::atomic<size_t> secuencia;
+        alignas(T) unsigned char dato[sizeof(T)];
+    };
+
+    Celda* celdas;
+    size_t mascara;  // Capacidad - 1 (potencia de 2)
+
+    // Cada extremo en su línea de caché: productores y consumidor no se
+    // estorban
+    alignas(64) std::atomic<size_t> cabeza;  // Siguiente posición a reservar
+    alignas(64) size_t cola;                 // Siguiente posición a leer
+
+public:
+    /**
+     * Constructor
+     * @param capacidad Elementos como mínimo (se redondea a potencia de 2)
+     */
+    ColaMPSC(size_t capacidad) : cabeza(0), cola(0) {
+        size_t c = 2;
+        while (c < capacidad) c *= 2;
+        mascara = c - 1;
+        celdas = static_cast<Celda*>(::operator new(sizeof(Celda) * c));
+        for (size_t i = 0; i < c; i++) {
+            new (&celdas[i].secuencia) std::atomic<size_t>(i);
+        }
+    }
+
+    ColaMPSC(const ColaMPSC&) = delete;
+    ColaMPSC& operator=(const ColaMPSC&) = delete;
+
+    ~ColaMPSC() {
+        ::operator delete(celdas);
+    }
+
+    size_t getCapacidad() const {
+        return mascara + 1;
+    }
+
+    /**
+     * Encola un elemento. Se puede llamar desde cualquier hilo
+     * @return false si la cola está llena
+     */
+    bool encolar(const T& dato) {
+        size_t pos = cabeza.load(std::memory_order_relaxed);
+        while (true) {
+            Celda& c = celdas[pos & mascara];
+            size_t secuencia = c.secuencia.load(std::memory_order_acquire);
+            intptr_t diferencia = (intptr_t)secuencia - (intptr_t)pos;
+            if (diferencia == 0) {
+                // La celda está libre en esta vuelta: se intenta reservar
+                if (cabeza.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    new (c.dato) T(dato);
+                    c.secuencia.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diferencia < 0) {
+                // El consumidor aún no ha leído la celda de la vuelta anterior
+                return false;
+            } else {
+                // Otro productor se ha adelantado
+                pos = cabeza.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Desencola un elemento. Sólo puede llamarla un hilo (el consumidor)
+     * @return false si la cola está vacía
+     */
+    bool desencolar(T& dato) {
+        Celda& c = celdas[cola & mascara];
+        size_t secuencia = c.secuencia.load(std::memory_order_acquire);
+        if ((intptr_t)secuencia - (intptr_t)(cola + 1) < 0) {
+            return false;
+        }
+        dato = *reinterpret_cast<const T*>(c.dato);
+        // La celda queda libre para la vuelta siguiente
+        c.secuencia.store(cola + mascara + 1, std::memory_order_release);
+        cola++;
+        return true;
+    }
+};
+
+#endif // COLA_MPSC_H
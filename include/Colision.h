@@ -0,0 +1,49 @@
+#ifndef COLISION_H
+#define COLISION_H
+
+#include "Fijo.h"
+
+// Candidatas que se comprueban de una vez (bits de la máscara)
+const int TAM_BLOQUE_COLISION = 32;
+
+/**
+ * Comprueba si un círculo choca con cada uno de un bloque contiguo de
+ * candidatos guardados por columnas (SoA). Compara distancias al cuadrado,
+ * sin raíz, varias candidatas por instrucción (AVX2 o SSE2 si están
+ * disponibles).
+ * @param x Centro X del círculo
+ * @param y Centro Y del círculo
+ * @param r Radio del círculo
+ * @param xs Centros X de las candidatas
+ * @param ys Centros Y de las candidatas
+ * @param rs Radios de las candidatas
+ * @param n Número de candidatas (como mucho TAM_BLOQUE_COLISION)
+ * @return Máscara: el bit k vale 1 si el círculo choca con la candidata k
+ */
+unsigned colisionesBloque(float x, float y, float r, const float* xs, const float* ys, const float* rs, int n);
+
+/**
+ * Lo mismo en coma fija: cuadrados en 64 bits, sin redondeos. Sin saltos
+ * dentro del bucle, para que el compilador lo pueda vectorizar
+ */
+unsigned colisionesBloque(Fijo x, Fijo y, Fijo r, const Fijo* xs, const Fijo* ys, const Fijo* rs, int n);
+
+/**
+ * Comparación de choque de un par, la misma que colisionesBloque: todos
+ * los motores de colisiones y Particula::colision la usan para dar
+ * exactamente los mismos pares
+ * @param dx Diferencia de los centros en X
+ * @param dy Diferencia de los centros en Y
+ * @param s Suma de los radios
+ * @return true si dx^2 + dy^2 < s^2
+ */
+inline bool solapan(float dx, float dy, float s) {
+    return dx * dx + dy * dy < s * s;
+}
+
+inline bool solapan(Fijo dx, Fijo dy, Fijo s) {
+    int64_t x = dx.getBruto(), y = dy.getBruto(), r = s.getBruto();
+    return (uint64_t)(x * x) + (uint64_t)(y * y) < (uint64_t)(r * r);
+}
+
+#endif // COLISION_H
@@ -0,0 +1,129 @@
+#ifndef CONJUNTO_ATRACTORES_H
+#define CONJUNTO_ATRACTORES_H
+
+#include "Vector2D.h"
+#include "params.h"
+#include "ParametrosMundo.h"
+
+class ConjuntoParticulas;
+class Particula;
+
+/**
+ * Conjunto de cuerpos grandes ("agujeros negros") que atraen y absorben
+ * a las partículas de una nube.
+ *
+ * Los datos se guardan por columnas (SoA) para que el campo de todos los
+ * atractores se aplique a la nube en un bucle sobre arrays contiguos que
+ * el compilador vectoriza. La absorción no compara cada partícula con cada
+ * atractor: los atractores se indexan en una rejilla uniforme y cada
+ * partícula sólo se compara con los de su celda.
+ */
+class ConjuntoAtractores {
+private:
+    ParametrosMundo mundo;
+
+    // Atractores (SoA)
+    float* x;
+    float* y;
+    float* vx;
+    float* vy;
+    float* radio;
+    int capacidad;
+    int utiles;
+
+    // Rejilla de absorción en formato CSR: los atractores de la celda c
+    // son indices[inicioCelda[c] .. inicioCelda[c+1])
+    int* inicioCelda;
+    int* indices;
+    int capacidadCeldas;
+    int capacidadIndices;
+    int celdasX, celdasY;
+    float tamCelda;
+
+    // Auxiliares de aplicarCampo (posición y aceleración de la nube)
+    float* px;
+    float* py;
+    float* ax;
+    float* ay;
+    int capacidadAux;
+
+    /**
+     * Redimensiona los arrays de atractores conservando su contenido
+     * @param nuevaCapacidad Nueva capacidad
+     */
+    void redimensionar(int nuevaCapacidad);
+
+    /**
+     * Celda de la rejilla que contiene una coordenada (recortada al mundo)
+     */
+    int celda(float v, int numCeldas) const;
+
+public:
+    /**
+     * Constructor: conjunto vacío
+     * @param mundo Mundo en el que se mueven (bordes y rejilla de absorción)
+     */
+    ConjuntoAtractores(const ParametrosMundo& mundo = ParametrosMundo());
+
+    ConjuntoAtractores(const ConjuntoAtractores&) = delete;
+    ConjuntoAtractores& operator=(const ConjuntoAtractores&) = delete;
+
+    /**
+     * Destructor
+     */
+    ~ConjuntoAtractores();
+
+    /**
+     * Agrega un atractor
+     * @param pos Posición del centro
+     * @param radio Radio (su masa es radio^2, como en MotorGravedad)
+     * @param veloc Velocidad (cero para un atractor estático)
+     * @return Posición del atractor en el conjunto
+     */
+    int agregar(const Vector2D& pos, float radio, const Vector2D& veloc = Vector2D());
+
+    /**
+     * Borra un atractor; el último pasa a ocupar su posición
+     * @param pos Posición del atractor
+     */
+    void borrar(int pos);
+
+    int getUtiles() const;
+    const ParametrosMundo& getMundo() const;
+    Vector2D getPos(int i) const;
+    Vector2D getVeloc(int i) const;
+    float getRadio(int i) const;
+
+    /**
+     * Mueve los atractores con su velocidad
+     * @param tipo 0 = mover, 1 = mover+rebotar, 2 = mover+wrap (como ConjuntoParticulas)
+     */
+    void mover(int tipo = 0);
+
+    /**
+     * Aplica a la nube la atracción de todos los atractores en una pasada.
+     * La aceleración resultante se limita en módulo a MAX_ACC
+     * @param nube Partículas atraídas
+     * @param G Constante de gravitación
+     * @param suavizado Distancia de suavizado
+     * @param acumular true para sumar a la aceleración actual (p.ej. la que
+     *        deja MotorGravedad), false para sustituirla
+     */
+    void aplicarCampo(ConjuntoParticulas& nube, float G, float suavizado = 5.0f, bool acumular = false);
+
+    /**
+     * Construye la rejilla de absorción
+     * @param margen Radio máximo de las partículas que se van a consultar
+     */
+    void indexar(float margen);
+
+    /**
+     * Indica si algún atractor toca a la partícula (usa la rejilla de la
+     * última llamada a indexar)
+     * @param p Partícula a comprobar
+     * @return true si la partícula debe ser absorbida
+     */
+    bool absorbe(const Particula& p) const;
+};
+
+#endif // CONJUNTO_ATRACTORES_H
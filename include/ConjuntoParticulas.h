@@ -2,15 +2,110 @@
 #define CONJUNTO_PARTICULAS_H
 
 #include "Particula.h"
+#include "VistaCampo.h"
+
+class ConjuntoAtractores;
+class PoolTrabajo;
+class LotesColisiones;
+class HashEspacial;
+class RejillaOrdenada;
+class ObstaculosEstaticos;
 
 // Tamaño del bloque para redimensionar el array
 const int TAM_BLOQUE = 3;
 
+/**
+ * Contadores de instrumentación de un conjunto de partículas
+ */
+struct EstadisticasConjunto {
+    long paresCandidatos;  // Pares comprobados en gestionarColisiones
+    long colisiones;       // Pares que realmente colisionaban
+    long choques;          // Llamadas a Particula::choque
+    long absorbidas;       // Partículas eliminadas por absorber()
+    long caducadas;        // Partículas eliminadas por envejecer()
+    long redimensiones;    // Veces que se ha reservado un array nuevo
+    long bytesReservados;  // Bytes pedidos al reservar memoria (partículas, manejadores y colisiones)
+    long cambiosCelda;     // Partículas reubicadas en el hash espacial al mover
+    long rebotesObstaculo; // Rebotes en obstáculos estáticos
+
+    EstadisticasConjunto();
+
+    /**
+     * Suma los contadores de otro registro a este
+     * @param otras Contadores a sumar
+     */
+    void sumar(const EstadisticasConjunto& otras);
+};
+
+/**
+ * Referencia estable a una partícula de un conjunto.
+ *
+ * A diferencia de la posición, un manejador sigue apuntando a la misma
+ * partícula aunque se borren otras o se redimensione el array. Cuando la
+ * partícula se borra, el manejador deja de ser válido (su generación ya
+ * no coincide) aunque el hueco se reutilice para otra partícula.
+ */
+struct Manejador {
+    int indice;           // Hueco en la tabla de manejadores
+    unsigned generacion;  // Generación del hueco al crear el manejador
+};
+
 class ConjuntoParticulas {
+public:
+    /**
+     * Fase amplia de gestionarColisiones: cómo se buscan los pares
+     * candidatos. Todos dan exactamente el mismo resultado
+     */
+    enum MotorColisiones {
+        TODOS_CONTRA_TODOS,  // Cada par, por bloques de máscaras
+        REJILLA_ORDENADA,    // Celdas ordenadas con radix (RejillaOrdenada)
+        HASH_ESPACIAL        // Hash incremental (activarHash)
+    };
+
 private:
     Particula* set;        // Array dinámico de partículas
     int capacidad;         // Capacidad total del array
     int utiles;            // Posiciones ocupadas actualmente
+    int capacidadMinima;   // Por debajo de esta capacidad el array no se encoge
+
+    ParametrosMundo mundo; // Tamaño del mundo y límites de las partículas
+    bool mundoFijo;        // El mundo es el de params.h: se usa MundoFijo
+
+    EstadisticasConjunto actual;   // Contadores del paso en curso
+    EstadisticasConjunto ultimo;   // Contadores del último paso cerrado
+    EstadisticasConjunto totales;  // Acumulado de todos los pasos cerrados
+    long pasos;                    // Pasos cerrados con finPaso()
+    long reordenaciones;           // Partículas quitadas (cada una mueve otra de sitio)
+
+    // Tabla de manejadores (slot map). Los arrays de huecos sólo crecen y
+    // son independientes del array de partículas, que sigue siendo denso
+    int* denso;                // denso[i] = hueco de la partícula en la posición i
+    int* posiciones;           // Hueco ocupado: posición de su partícula en 'set'
+                               // Hueco libre: siguiente hueco libre (o -1)
+    unsigned* generaciones;    // Generación actual de cada hueco
+    int capacidadHuecos;       // Tamaño de los arrays de huecos
+    int numHuecos;             // Huecos usados alguna vez
+    int primerLibre;           // Primer hueco de la lista de libres (o -1)
+
+    // Copia por columnas de posiciones y radios para las comprobaciones de
+    // colisión por bloques (sólo crece)
+    Escalar* columnaX;
+    Escalar* columnaY;
+    Escalar* columnaR;
+    int capacidadColumnas;
+
+    // Pares y lotes de gestionarColisiones(pool), creado en el primer uso
+    LotesColisiones* lotes;
+
+    // Hash espacial incremental (nullptr si no está activado)
+    HashEspacial* hash;
+
+    // Fase amplia de las colisiones
+    MotorColisiones motorColisiones;
+    RejillaOrdenada* rejilla;   // Creada en el primer uso
+    int* vecinas;               // Candidatas de una partícula con el hash
+    int capacidadVecinas;
+    long bytesMotores;          // Bytes de hash, rejilla y lotes ya sumados a actual
     
     /**
      * Reserva memoria para el array de partículas
@@ -28,19 +123,92 @@ private:
      * @param nuevaCapacidad Nueva capacidad del array
      */
     void redimensionar(int nuevaCapacidad);
+
+    /**
+     * Encoge el array si sobra más de un bloque, sin bajar de capacidadMinima
+     */
+    void ajustarCapacidad();
+
+    /**
+     * Quita la partícula de una posición sin ajustar la capacidad. La última
+     * partícula pasa a ocupar esa posición
+     * @param pos Posición de la partícula
+     */
+    void quitar(int pos);
+
+    /**
+     * Mueve todas las partículas en un mundo (ParametrosMundo o MundoFijo)
+     * @param m Mundo
+     * @param tipo Tipo de movimiento, como en mover()
+     * @param desde Primera partícula
+     * @param hasta Posición siguiente a la última partícula
+     */
+    template <class Mundo>
+    void moverEn(const Mundo& m, int tipo, int desde, int hasta);
+
+    /**
+     * Tramo del array que corresponde a un hilo del pool: el reparto es
+     * sobre la capacidad, no sobre las partículas útiles, para que cada
+     * hilo trabaje siempre sobre las páginas que tocó primero
+     * @param hilo Número del hilo
+     * @param numHilos Hilos del pool
+     * @param desde Salida: primera posición
+     * @param hasta Salida: posición siguiente a la última
+     */
+    void tramo(int hilo, int numHilos, int& desde, int& hasta) const;
+
+    /**
+     * Asegura que los arrays de huecos tienen sitio para tam huecos
+     * @param tam Número de huecos necesario
+     */
+    void reservarHuecos(int tam);
+
+    /**
+     * Libera la tabla de manejadores
+     */
+    void liberarHuecos();
+
+    /**
+     * Asigna un hueco (reutilizando uno libre si lo hay) a la partícula
+     * que está en la posición indicada
+     * @param pos Posición de la partícula en el array
+     */
+    void asignarHueco(int pos);
+
+    /**
+     * Copia posiciones y radios de las partículas útiles a las columnas
+     */
+    void copiarColumnas();
+
+    /**
+     * Suma a actual los bytes que han reservado el hash, la rejilla y los
+     * lotes desde la última llamada
+     */
+    void contarBytesMotores();
+
+    /**
+     * Resuelve las colisiones buscando los pares en el hash espacial
+     * @param candidatos Salida: pares comprobados
+     * @return Colisiones resueltas
+     */
+    long colisionesHash(long& candidatos);
     
 public:
     /**
      * Constructor por defecto
      * @param n Número inicial de partículas (por defecto 0)
+     * @param mundo Mundo en el que se crean y se mueven (por defecto, el de params.h)
      */
-    ConjuntoParticulas(int n = 0);
+    ConjuntoParticulas(int n = 0, const ParametrosMundo& mundo = ParametrosMundo());
     
     /**
      * Constructor de copia
      * @param otro Conjunto a copiar
      */
     ConjuntoParticulas(const ConjuntoParticulas& otro);
+
+    // La asignación por defecto compartiría los arrays (doble delete)
+    ConjuntoParticulas& operator=(const ConjuntoParticulas&) = delete;
     
     /**
      * Destructor
@@ -58,18 +226,114 @@ public:
      * @return Capacidad del array
      */
     int getCapacidad() const;
+
+    /**
+     * Reserva capacidad para n partículas y la fija como mínima: al borrar,
+     * el array no se encoge por debajo de ella. Con la capacidad reservada,
+     * agregar y borrar no piden memoria
+     * @param n Número de partículas
+     */
+    void reservar(int n);
+
+    /**
+     * Como reservar(n), pero el array nuevo lo escriben por primera vez los
+     * hilos del pool, cada uno su tramo (ver moverParalelo). Así, con los
+     * hilos fijados a CPU de distintos nodos NUMA, las páginas de cada tramo
+     * quedan en el nodo del hilo que lo procesa. Si el array crece después
+     * con agregar(), la copia la hace el hilo que llama y se pierde el
+     * reparto: conviene reservar de antemano
+     * @param n Número de partículas
+     * @param pool Hilos que van a procesar el conjunto
+     */
+    void reservar(int n, PoolTrabajo& pool);
+
+    /**
+     * Capacidad por debajo de la cual el array no se encoge
+     * @return Capacidad mínima
+     */
+    int getCapacidadMinima() const;
+
+    /**
+     * Mundo del conjunto
+     * @return Parámetros del mundo
+     */
+    const ParametrosMundo& getMundo() const;
+
+    /**
+     * Vistas de sólo lectura de las partículas útiles, sin copias. Dejan de
+     * valer si el conjunto cambia de tamaño
+     * @return Vista de las partículas (contigua) o de uno de sus campos
+     */
+    VistaCampo<Particula> vistaParticulas() const;
+    VistaCampo<Vector2D> vistaPosiciones() const;
+    VistaCampo<Vector2D> vistaVelocidades() const;
+    VistaCampo<Vector2D> vistaAceleraciones() const;
     
     /**
      * Agrega una partícula al conjunto
      * @param part Partícula a agregar
+     * @return Manejador estable de la partícula agregada
+     */
+    Manejador agregar(const Particula& part);
+
+    /**
+     * Agrega un bloque de partículas, redimensionando como mucho una vez
+     * @param partes Partículas a agregar
+     * @param n Número de partículas
      */
-    void agregar(const Particula& part);
+    void agregar(const Particula* partes, int n);
     
     /**
-     * Borra una partícula en la posición indicada
+     * Borra una partícula en la posición indicada. La última partícula pasa
+     * a ocupar esa posición; su manejador sigue siendo válido
      * @param pos Posición de la partícula a borrar
      */
     void borrar(int pos);
+
+    /**
+     * Borra la partícula de un manejador (no hace nada si ya no es válido)
+     * @param m Manejador de la partícula
+     */
+    void borrar(Manejador m);
+
+    /**
+     * Borra las partículas de varios manejadores (los que ya no son válidos
+     * se ignoran) y ajusta la capacidad una sola vez
+     * @param m Manejadores
+     * @param n Número de manejadores
+     * @return Partículas borradas
+     */
+    int borrar(const Manejador* m, int n);
+
+    /**
+     * Indica si el manejador corresponde a una partícula que sigue en el conjunto
+     * @param m Manejador a comprobar
+     * @return true si es válido
+     */
+    bool valido(Manejador m) const;
+
+    /**
+     * Obtiene el manejador de la partícula en una posición
+     * @param pos Posición de la partícula
+     * @return Manejador estable de la partícula
+     */
+    Manejador manejador(int pos) const;
+
+    /**
+     * Posición actual de la partícula de un manejador
+     * @param m Manejador de la partícula
+     * @return Posición en el conjunto, o -1 si el manejador no es válido
+     */
+    int posicion(Manejador m) const;
+
+    /**
+     * Obtiene una referencia a la partícula de un manejador válido
+     * @param m Manejador de la partícula
+     * @return Referencia a la partícula
+     */
+    Particula& obtener(Manejador m);
+
+    const Particula& obtener(Manejador m) const;
     
     /**
      * Obtiene una referencia a la partícula en la posición indicada
@@ -97,11 +361,151 @@ public:
      * @param tipo Tipo de movimiento: 0 = mover, 1 = mover+rebotar, 2 = mover+wrap
      */
     void mover(int tipo = 0);
+
+    /**
+     * Como mover(), repartiendo el array entre los hilos del pool: cada
+     * hilo mueve siempre el mismo tramo (el que tocó en reservar(n, pool))
+     * @param pool Hilos
+     * @param tipo Tipo de movimiento: 0 = mover, 1 = mover+rebotar, 2 = mover+wrap
+     */
+    void moverParalelo(PoolTrabajo& pool, int tipo = 0);
     
+    /**
+     * Activa el hash espacial: apunta cada partícula en su celda y, a partir
+     * de aquí, agregar, borrar y reemplazar lo mantienen al día y mover()
+     * reubica sólo las partículas que cambian de celda (cuántas, en
+     * EstadisticasConjunto::cambiosCelda). Si se cambia la posición de una
+     * partícula a través de obtener(), el hash no se entera hasta el
+     * siguiente mover() o actualizarHash(). Las copias del conjunto no
+     * copian el hash
+     * @param tamCelda Lado de las celdas
+     */
+    void activarHash(float tamCelda);
+
+    /**
+     * Desactiva el hash espacial y libera su memoria
+     */
+    void desactivarHash();
+
+    /**
+     * Hash espacial del conjunto
+     * @return El hash, o nullptr si no está activado
+     */
+    const HashEspacial* getHash() const;
+
+    /**
+     * Reubica en el hash las partículas que han cambiado de celda (mover()
+     * ya lo hace)
+     * @return Partículas que han cambiado de celda
+     */
+    int actualizarHash();
+
+    /**
+     * Elige la fase amplia de gestionarColisiones. Con HASH_ESPACIAL, si el
+     * hash no está activado se activa en la siguiente llamada con celdas
+     * de 2 * radio máximo
+     * @param motor Motor de colisiones
+     */
+    void setMotorColisiones(MotorColisiones motor);
+
+    MotorColisiones getMotorColisiones() const;
+
     /**
      * Gestiona las colisiones entre partículas
      */
     void gestionarColisiones();
+
+    /**
+     * Como gestionarColisiones(), pero en paralelo y con exactamente el
+     * mismo resultado: los pares se detectan en paralelo y se resuelven
+     * por lotes sin partículas en común (ver LotesColisiones). Con
+     * HASH_ESPACIAL se hace en el hilo que llama
+     * @param pool Hilos
+     */
+    void gestionarColisiones(PoolTrabajo& pool);
+
+    /**
+     * Hace rebotar las partículas en los obstáculos estáticos que tocan
+     * (ver ObstaculosEstaticos::rebotar). Cada partícula baja por el árbol
+     * de obstáculos: el coste no crece con el número de obstáculos más que
+     * en la profundidad del árbol
+     * @param obstaculos Obstáculos ya construidos
+     * @return Número de rebotes
+     */
+    int rebotarObstaculos(const ObstaculosEstaticos& obstaculos);
+
+    /**
+     * Elimina las partículas que colisionan con un atractor
+     * @param atractor Partícula que absorbe a las que toca
+     * @return Número de partículas absorbidas
+     */
+    int absorber(const Particula& atractor);
+
+    /**
+     * Elimina las partículas que colisionan con cualquiera de los atractores.
+     * Cada partícula sólo se compara con los atractores de su celda
+     * @param atractores Conjunto de atractores (se reindexa)
+     * @return Número de partículas absorbidas
+     */
+    int absorber(ConjuntoAtractores& atractores);
+
+    /**
+     * Descuenta un paso de vida a cada partícula y elimina de una vez las que
+     * caducan (las de VIDA_INFINITA no caducan). Pensado para llamarse al
+     * final de cada paso
+     * @return Número de partículas eliminadas
+     */
+    int envejecer();
+
+    /**
+     * Cierra el paso de simulación en curso: sus contadores pasan a ser los
+     * del último paso y se suman a los totales. La memoria que han pedido
+     * los motores de colisiones se cuenta aquí
+     */
+    void finPaso();
+
+    /**
+     * Contadores del último paso cerrado con finPaso()
+     * @return Estadísticas del paso
+     */
+    const EstadisticasConjunto& getEstadisticasPaso() const;
+
+    /**
+     * Contadores acumulados de todos los pasos cerrados
+     * @return Estadísticas totales
+     */
+    const EstadisticasConjunto& getEstadisticasTotales() const;
+
+    /**
+     * Número de pasos cerrados con finPaso()
+     * @return Pasos
+     */
+    long getPasos() const;
+
+    /**
+     * Número de veces que se ha quitado una partícula. Cada vez, la última
+     * pasa al hueco, así que si no ha cambiado entre dos momentos cada
+     * posición sigue siendo la misma partícula (salvo las agregadas al final)
+     * @return Reordenaciones
+     */
+    long getReordenaciones() const;
+
+    /**
+     * Escribe los contadores en formato de texto de Prometheus (para el
+     * textfile collector de node_exporter). Se escribe en un temporal que
+     * luego se renombra, de modo que nunca se lee un fichero a medias
+     * @param ruta Fichero de salida
+     * @return false si no se pudo escribir
+     */
+    bool volcarPrometheus(const std::string& ruta) const;
+
+    /**
+     * Huella FNV-1a de los bits de todas las partículas útiles (posición,
+     * velocidad, aceleración, radio, tipo y vida, en orden). Dos ejecuciones
+     * han seguido el mismo camino si dan la misma huella en cada paso
+     * @return Huella de 64 bits
+     */
+    uint64_t hashEstado() const;
     
     /**
      * Devuelve una representación en string del conjunto
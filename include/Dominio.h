@@ -0,0 +1,151 @@
+#ifndef DOMINIO_H
+#define DOMINIO_H
+
+#include "ConjuntoParticulas.h"
+#include <atomic>
+#include <pthread.h>
+#include <string>
+
+/**
+ * Partícula tal y como viaja por la memoria compartida (sin punteros, para
+ * que valga en cualquier proceso)
+ */
+struct MensajeParticula {
+    float px, py, vx, vy, ax, ay, radio;
+    int tipo, vida;
+    int clase;  // MIGRA (pasa a ser del vecino) o HALO (copia de sólo lectura)
+
+    static const int MIGRA = 0;
+    static const int HALO = 1;
+};
+
+/**
+ * Resumen de la simulación de una franja
+ */
+struct ResumenFranja {
+    int particulas;      // Partículas de la franja al final
+    long colisiones;     // Pares de la franja: sumando todas las franjas,
+    long paresCandidatos; // cada par cuenta una vez
+    long migradas;       // Partículas enviadas a las franjas vecinas
+    long halo;           // Copias de borde enviadas a las franjas vecinas
+    double segundos;     // Tiempo de la simulación de la franja
+};
+
+/**
+ * Descomposición del mundo en franjas verticales, cada una simulada por un
+ * proceso distinto.
+ *
+ * La franja k es [k * ancho, (k + 1) * ancho) en X, con ancho = maxX /
+ * numFranjas (las de los extremos se extienden hasta el infinito). En cada
+ * paso cada proceso:
+ *  1. mueve sus partículas (rebotando en los bordes del mundo),
+ *  2. envía a la franja vecina las que han salido de la suya (migración) y
+ *     una copia de las que están a menos de 2 * radioMax del borde (halo),
+ *  3. espera en la barrera, recibe lo que le han enviado y vuelve a
+ *     esperar (así nadie escribe el paso siguiente antes de que el vecino
+ *     haya vaciado el actual),
+ *  4. gestiona las colisiones de sus partículas más el halo y descarta el
+ *     halo. Los pares entre dos copias de halo no cuentan en el resumen, y
+ *     los de una partícula con una copia sólo en la franja de la izquierda.
+ *
+ * La comunicación va por anillos de un productor y un consumidor (uno por
+ * cada par de franjas vecinas y sentido) en un segmento de memoria
+ * compartida POSIX, con una barrera pthread compartida entre procesos. Los
+ * anillos tienen sitio para todas las partículas, así que nunca se llenan:
+ * un proceso no puede enviar más partículas de las que tiene.
+ *
+ * Los choques entre una partícula y una copia de halo sólo cambian la
+ * propia: el vecino resuelve el mismo choque para la suya. Como los choques
+ * se resuelven en orden, el resultado no es idéntico al de un solo proceso,
+ * pero se conservan las partículas y cada par cercano se comprueba.
+ *
+ * Los procesos se crean con fork() en ejecutar(): cada uno hereda la nube
+ * inicial y se queda con las partículas de su franja. Al terminar, cada
+ * franja copia sus partículas al segmento para que el proceso original las
+ * recoja.
+ */
+class DescomposicionDominio {
+private:
+    struct Cabecera;
+    struct Anillo;
+
+    int numFranjas;
+    int capacidad;          // Partículas como máximo en todo el mundo
+    ParametrosMundo mundo;
+    float ancho;            // Ancho de cada franja
+    float margenHalo;       // Distancia al borde de las copias de halo
+
+    // Segmento compartido
+    void* segmento;
+    size_t tamSegmento;
+    Cabecera* cabecera;
+    unsigned char* anillos;     // 2 * numFranjas anillos (a la izquierda, a la derecha)
+    size_t tamAnillo;
+    ResumenFranja* resumenes;
+    MensajeParticula* resultados; // capacidad mensajes por franja
+
+    /**
+     * Anillo por el que la franja origen envía a su vecina
+     * @param derecha true para la vecina de la derecha
+     */
+    Anillo* anillo(int origen, bool derecha) const;
+
+    /**
+     * Simula una franja (en el proceso hijo)
+     */
+    void simularFranja(int k, const ConjuntoParticulas& inicial, int pasos);
+
+    static MensajeParticula aMensaje(const Particula& p, int clase);
+    static Particula aParticula(const MensajeParticula& m);
+
+public:
+    /**
+     * Constructor: crea el segmento compartido
+     * @param numFranjas Número de franjas (y de procesos)
+     * @param capacidad Partículas como máximo en el mundo
+     * @param mundo Mundo que se reparte
+     */
+    DescomposicionDominio(int numFranjas, int capacidad, const ParametrosMundo& mundo = ParametrosMundo());
+
+    DescomposicionDominio(const DescomposicionDominio&) = delete;
+    DescomposicionDominio& operator=(const DescomposicionDominio&) = delete;
+
+    /**
+     * Destructor: libera el segmento compartido
+     */
+    ~DescomposicionDominio();
+
+    /**
+     * Indica si el segmento compartido se pudo crear
+     */
+    bool valida() const;
+
+    int getNumFranjas() const;
+
+    /**
+     * Franja a la que pertenece una coordenada X
+     */
+    int franja(float x) const;
+
+    /**
+     * Simula la nube repartida en procesos y espera a que terminen todos.
+     * La nube no se modifica; el resultado se obtiene con recoger()
+     * @param inicial Partículas iniciales (como mucho capacidad)
+     * @param pasos Pasos a simular
+     * @return false si no se pudo crear algún proceso o alguno falló
+     */
+    bool ejecutar(const ConjuntoParticulas& inicial, int pasos);
+
+    /**
+     * Resumen de una franja tras ejecutar()
+     */
+    const ResumenFranja& getResumen(int k) const;
+
+    /**
+     * Agrega a una nube las partículas de todas las franjas tras ejecutar()
+     * @param destino Nube de destino
+     */
+    void recoger(ConjuntoParticulas& destino) const;
+};
+
+#endif // DOMINIO_H
@@ -0,0 +1,74 @@
+#ifndef EMISOR_H
+#define EMISOR_H
+
+#include "ConjuntoParticulas.h"
+
+/**
+ * Fuente de partículas con vida limitada.
+ *
+ * En cada llamada a emitir() crea, en un disco alrededor de su posición,
+ * las partículas que le tocan según su tasa (que puede ser fraccionaria:
+ * la parte sobrante se acumula para el paso siguiente). Cada partícula
+ * recibe una vida al azar entre vidaMin y vidaMax pasos y desaparece en
+ * ConjuntoParticulas::envejecer().
+ *
+ * Con la tasa y la vida acotadas, la nube se estabiliza en torno a
+ * tasa * vida media partículas. Si antes se reserva ocupacionMaxima() en
+ * el conjunto, el régimen estacionario no pide memoria. Sin esa reserva
+ * emitir() amplía el array cuando no cabe el lote, pero no fija la
+ * capacidad mínima: al caducar partículas el conjunto puede encogerse.
+ */
+class Emisor {
+private:
+    Vector2D pos;            // Centro de la zona de emisión
+    float dispersion;        // Radio de la zona de emisión
+    float tasa;              // Partículas por paso
+    float acumulado;         // Fracción de partícula pendiente de emitir
+    Vector2D velocidad;      // Velocidad media de las partículas
+    float dispersionVeloc;   // Desviación máxima de cada componente de la velocidad
+    int vidaMin, vidaMax;    // Vida en pasos
+    float radioMin, radioMax;
+    int tipo;
+
+public:
+    /**
+     * Constructor
+     * @param pos Centro de la zona de emisión
+     * @param tasa Partículas por paso
+     * @param vidaMin Vida mínima (pasos)
+     * @param vidaMax Vida máxima (pasos)
+     * @param velocidad Velocidad media
+     * @param dispersionVeloc Desviación máxima de cada componente de la velocidad
+     */
+    Emisor(const Vector2D& pos = Vector2D(), float tasa = 1.0f, int vidaMin = 100, int vidaMax = 200,
+           const Vector2D& velocidad = Vector2D(), float dispersionVeloc = 2.0f);
+
+    void setPos(const Vector2D& pos);
+    void setTasa(float tasa);
+    void setDispersion(float dispersion);
+    void setVelocidad(const Vector2D& velocidad, float dispersionVeloc);
+    void setVida(int vidaMin, int vidaMax);
+    void setRadio(float radioMin, float radioMax);
+    void setTipo(int tipo);
+
+    Vector2D getPos() const;
+    float getTasa() const;
+
+    /**
+     * Número máximo de partículas vivas de este emisor a la vez
+     * @return Partículas por paso (redondeado hacia arriba) * vida máxima
+     */
+    int ocupacionMaxima() const;
+
+    /**
+     * Agrega a la nube las partículas de este paso. Si no caben, la
+     * capacidad se amplía de una vez para todo el lote, al menos al doble.
+     * No cambia la capacidad mínima de la nube: para que no se encoja,
+     * quien llama reserva antes con nube.reservar(ocupacionMaxima())
+     * @param nube Conjunto que recibe las partículas
+     * @return Número de partículas emitidas
+     */
+    int emitir(ConjuntoParticulas& nube);
+};
+
+#endif // EMISOR_H
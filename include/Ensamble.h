@@ -0,0 +1,104 @@
+#ifndef ENSAMBLE_H
+#define ENSAMBLE_H
+
+#include "ConjuntoParticulas.h"
+#include "PoolTrabajo.h"
+#include <string>
+
+/**
+ * Parámetros de una ejecución del ensamble. Junto con su ParametrosMundo
+ * sustituyen en tiempo de ejecución a las constantes de params.h, de modo
+ * que un barrido de parámetros (incluido el tamaño del mundo) no necesita
+ * recompilar
+ */
+struct ParametrosEjecucion {
+    unsigned semilla;      // Semilla del generador aleatorio de la ejecución
+    int numParticulas;     // Partículas iniciales
+    int modo;              // 0 = mover, 1 = rebotar, 2 = wrap
+    int pasos;             // Pasos como máximo
+    ParametrosMundo mundo; // Tamaño del mundo, velocidad máxima y radios
+    bool colisiones;       // Gestionar colisiones entre partículas
+    int numAtractores;     // Agujeros negros (el primero en el centro)
+    float radioAtractor;
+    float gravedad;        // G del campo de los atractores (0 = sin campo)
+
+    ParametrosEjecucion();
+};
+
+/**
+ * Resumen de una ejecución del ensamble
+ */
+struct ResumenEjecucion {
+    int supervivientes;    // Partículas al final
+    int pasosSimulados;    // Pasos dados (menos que los pedidos si la nube se vació)
+    long paresCandidatos;  // Totales de EstadisticasConjunto
+    long colisiones;
+    long absorbidas;
+    float velocidadMedia;  // Módulo medio de la velocidad al final
+    double segundos;       // Tiempo de la ejecución
+
+    ResumenEjecucion();
+};
+
+/**
+ * Conjunto de simulaciones independientes que se ejecutan en paralelo.
+ *
+ * Cada ejecución crea su propia nube y siembra el generador aleatorio de
+ * su hilo con su semilla, así que sus resultados sólo dependen de sus
+ * parámetros y no de en qué hilo ni en qué orden se ejecute
+ */
+class Ensamble {
+private:
+    ParametrosEjecucion* parametros;
+    ResumenEjecucion* resumenes;
+    int capacidad;
+    int utiles;
+
+public:
+    /**
+     * Constructor: ensamble vacío
+     */
+    Ensamble();
+
+    Ensamble(const Ensamble&) = delete;
+    Ensamble& operator=(const Ensamble&) = delete;
+
+    /**
+     * Destructor
+     */
+    ~Ensamble();
+
+    /**
+     * Agrega una ejecución
+     * @param p Parámetros de la ejecución
+     * @return Índice de la ejecución
+     */
+    int agregar(const ParametrosEjecucion& p);
+
+    int getUtiles() const;
+    const ParametrosEjecucion& getParametros(int i) const;
+    const ResumenEjecucion& getResumen(int i) const;
+
+    /**
+     * Ejecuta todas las simulaciones repartidas en el pool
+     * @param pool Hilos que ejecutan las simulaciones
+     */
+    void ejecutar(PoolTrabajo& pool);
+
+    /**
+     * Ejecuta una simulación en el hilo actual
+     * @param p Parámetros de la ejecución
+     * @return Resumen de la ejecución
+     */
+    static ResumenEjecucion simular(const ParametrosEjecucion& p);
+
+    /**
+     * Escribe los parámetros y el resumen de cada ejecución en CSV, una
+     * fila por ejecución
+     * @param ruta Fichero de salida
+     * @return false si no se pudo escribir
+     */
+    bool volcarCSV(const std::string& ruta) const;
+};
+
+#endif // ENSAMBLE_H
@@ -0,0 +1,75 @@
+#ifndef ESCRITOR_VIDEO_H
+#define ESCRITOR_VIDEO_H
+
+#include "Rasterizador.h"
+#include <cstdio>
+#include <string>
+
+/**
+ * Escribe fotogramas de un Rasterizador como vídeo sin comprimir.
+ *
+ * Formatos:
+ *  - Y4M: YUV 4:2:0 con cabecera YUV4MPEG2, lo leen directamente ffmpeg,
+ *    x264 o mpv (p.ej. "testVideo ... - | ffmpeg -i - salida.mp4")
+ *  - RAW: los píxeles RGBA tal cual, fotograma tras fotograma
+ *
+ * La salida puede ser un fichero o "-" para la salida estándar (tubería).
+ */
+class EscritorVideo {
+public:
+    enum Formato { Y4M, RAW };
+
+private:
+    FILE* salida;        // Fichero o tubería de salida
+    bool propio;         // true si hay que cerrar 'salida' al terminar
+    Formato formato;
+    int ancho;
+    int alto;
+    unsigned char* yuv;  // Buffer del fotograma convertido a YUV 4:2:0
+    long fotogramas;     // Fotogramas escritos
+
+    /**
+     * Convierte el framebuffer RGBA a YUV 4:2:0 (BT.601, rango completo)
+     */
+    void convertirYUV(const ColorRGBA* pixeles);
+
+public:
+    /**
+     * Abre la salida y escribe la cabecera si el formato la tiene
+     * @param ruta Fichero de salida, o "-" para la salida estándar
+     * @param ancho Ancho de los fotogramas (par en Y4M)
+     * @param alto Alto de los fotogramas (par en Y4M)
+     * @param fps Fotogramas por segundo declarados en la cabecera
+     * @param formato Y4M o RAW
+     */
+    EscritorVideo(const std::string& ruta, int ancho, int alto, int fps, Formato formato = Y4M);
+
+    EscritorVideo(const EscritorVideo&) = delete;
+    EscritorVideo& operator=(const EscritorVideo&) = delete;
+
+    /**
+     * Destructor: vacía y cierra la salida
+     */
+    ~EscritorVideo();
+
+    /**
+     * Indica si la salida se abrió correctamente
+     * @return true si se puede escribir
+     */
+    bool abierto() const;
+
+    /**
+     * Añade un fotograma
+     * @param r Rasterizador con el mismo tamaño que el vídeo
+     * @return false si hubo un error de escritura o el tamaño no coincide
+     */
+    bool escribir(const Rasterizador& r);
+
+    /**
+     * Número de fotogramas escritos
+     * @return Fotogramas
+     */
+    long getFotogramas() const;
+};
+
+#endif // ESCRITOR_VIDEO_H
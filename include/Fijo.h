@@ -0,0 +1,160 @@
+#ifndef FIJO_H
+#define FIJO_H
+
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Número en coma fija Q16.16: un entero de 32 bits con 16 bits de parte
+ * fraccionaria (rango [-32768, 32768), paso 1/65536).
+ *
+ * Todas las operaciones son enteras, así que dan el mismo resultado bit a
+ * bit con cualquier compilador, opción u orden de instrucciones: es el
+ * tipo Escalar de Vector2D y Particula con SIMULACION_FIJA. Las sumas y
+ * restas dan la vuelta como enteros sin signo (nunca son comportamiento
+ * indefinido); los productos y cocientes se hacen en 64 bits y se
+ * redondean hacia menos infinito.
+ *
+ * Se construye implícitamente desde int, float y double (redondeando al
+ * más cercano) y se convierte implícitamente a float, para que el código
+ * de pintado, estadísticas, etc. siga leyendo las coordenadas como
+ * float. Una operación entre un Fijo y un float o double se hace en coma
+ * flotante; entre un Fijo y un entero, en coma fija.
+ */
+class Fijo {
+private:
+    int32_t bruto;
+
+    struct Bruto {};
+    constexpr Fijo(int32_t b, Bruto) : bruto(b) {}
+
+    static constexpr int32_t redondear(double v) {
+        return (int32_t)(v * 65536.0 + (v >= 0 ? 0.5 : -0.5));
+    }
+
+public:
+    static constexpr int BITS_FRACCION = 16;
+
+    constexpr Fijo() : bruto(0) {}
+    constexpr Fijo(int v) : bruto((int32_t)((uint32_t)v << BITS_FRACCION)) {}
+    constexpr Fijo(float v) : bruto(redondear(v)) {}
+    constexpr Fijo(double v) : bruto(redondear(v)) {}
+
+    /**
+     * Fijo con una representación entera dada
+     * @param b Valor * 65536
+     */
+    static constexpr Fijo desdeBruto(int32_t b) { return Fijo(b, Bruto()); }
+
+    /**
+     * Representación entera (valor * 65536)
+     */
+    constexpr int32_t getBruto() const { return bruto; }
+
+    constexpr operator float() const { return (float)bruto * (1.0f / 65536.0f); }
+
+    friend constexpr Fijo operator+(Fijo a, Fijo b) {
+        return desdeBruto((int32_t)((uint32_t)a.bruto + (uint32_t)b.bruto));
+    }
+    friend constexpr Fijo operator-(Fijo a, Fijo b) {
+        return desdeBruto((int32_t)((uint32_t)a.bruto - (uint32_t)b.bruto));
+    }
+    friend constexpr Fijo operator*(Fijo a, Fijo b) {
+        return desdeBruto((int32_t)(((int64_t)a.bruto * b.bruto) >> BITS_FRACCION));
+    }
+    // Entre cero da el mayor valor con el signo del dividendo
+    friend constexpr Fijo operator/(Fijo a, Fijo b) {
+        return b.bruto == 0 ? desdeBruto(a.bruto >= 0 ? INT32_MAX : INT32_MIN)
+                            : desdeBruto((int32_t)(((int64_t)a.bruto * 65536) / b.bruto));
+    }
+    constexpr Fijo operator-() const { return desdeBruto((int32_t)(0u - (uint32_t)bruto)); }
+
+    constexpr Fijo& operator+=(Fijo o) { return *this = *this + o; }
+    constexpr Fijo& operator-=(Fijo o) { return *this = *this - o; }
+    constexpr Fijo& operator*=(Fijo o) { return *this = *this * o; }
+    constexpr Fijo& operator/=(Fijo o) { return *this = *this / o; }
+
+    friend constexpr bool operator==(Fijo a, Fijo b) { return a.bruto == b.bruto; }
+    friend constexpr bool operator!=(Fijo a, Fijo b) { return a.bruto != b.bruto; }
+    friend constexpr bool operator<(Fijo a, Fijo b) { return a.bruto < b.bruto; }
+    friend constexpr bool operator<=(Fijo a, Fijo b) { return a.bruto <= b.bruto; }
+    friend constexpr bool operator>(Fijo a, Fijo b) { return a.bruto > b.bruto; }
+    friend constexpr bool operator>=(Fijo a, Fijo b) { return a.bruto >= b.bruto; }
+};
+
+static_assert(std::is_trivially_copyable<Fijo>::value, "Fijo debe ser trivialmente copiable");
+
+/**
+ * Parte entera de la raíz cuadrada de un entero de 64 bits (bit a bit,
+ * sin coma flotante)
+ */
+inline uint64_t raizEntera(uint64_t n) {
+    uint64_t r = 0;
+    uint64_t bit = 1ull << 62;
+    while (bit > n) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (n >= r + bit) {
+            n -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return r;
+}
+
+/**
+ * Raíz cuadrada en coma fija (redondeada hacia abajo). Las negativas dan 0
+ */
+inline Fijo sqrt(Fijo v) {
+    if (v.getBruto() <= 0) {
+        return Fijo();
+    }
+    return Fijo::desdeBruto((int32_t)raizEntera((uint64_t)v.getBruto() << Fijo::BITS_FRACCION));
+}
+
+inline Fijo abs(Fijo v) {
+    return v < Fijo() ? -v : v;
+}
+
+// Operaciones mixtas. Con float o double se hacen en coma flotante; con
+// enteros, en coma fija. Sin ellas, Fijo + float sería ambiguo
+
+template <class A>
+using SiReal = typename std::enable_if<std::is_floating_point<A>::value, A>::type;
+template <class A>
+using SiRealBool = typename std::enable_if<std::is_floating_point<A>::value, bool>::type;
+template <class A>
+using SiEntero = typename std::enable_if<std::is_integral<A>::value, Fijo>::type;
+template <class A>
+using SiEnteroBool = typename std::enable_if<std::is_integral<A>::value, bool>::type;
+
+#define FIJO_MIXTO(op) \
+    template <class A> constexpr SiReal<A> operator op(Fijo a, A b) { return (A)(float)a op b; } \
+    template <class A> constexpr SiReal<A> operator op(A a, Fijo b) { return a op (A)(float)b; } \
+    template <class A> constexpr SiEntero<A> operator op(Fijo a, A b) { return a op Fijo((int)b); } \
+    template <class A> constexpr SiEntero<A> operator op(A a, Fijo b) { return Fijo((int)a) op b; }
+#define FIJO_COMPARACION(op) \
+    template <class A> constexpr SiRealBool<A> operator op(Fijo a, A b) { return (A)(float)a op b; } \
+    template <class A> constexpr SiRealBool<A> operator op(A a, Fijo b) { return a op (A)(float)b; } \
+    template <class A> constexpr SiEnteroBool<A> operator op(Fijo a, A b) { return a op Fijo((int)b); } \
+    template <class A> constexpr SiEnteroBool<A> operator op(A a, Fijo b) { return Fijo((int)a) op b; }
+
+FIJO_MIXTO(+)
+FIJO_MIXTO(-)
+FIJO_MIXTO(*)
+FIJO_MIXTO(/)
+FIJO_COMPARACION(==)
+FIJO_COMPARACION(!=)
+FIJO_COMPARACION(<)
+FIJO_COMPARACION(<=)
+FIJO_COMPARACION(>)
+FIJO_COMPARACION(>=)
+
+#undef FIJO_MIXTO
+#undef FIJO_COMPARACION
+
+#endif // FIJO_H
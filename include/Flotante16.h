@@ -0,0 +1,124 @@
+#ifndef FLOTANTE16_H
+#define FLOTANTE16_H
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Conversión entre float y flotante de 16 bits (IEEE 754 binary16: 1 bit
+ * de signo, 5 de exponente y 10 de mantisa). Se redondea al par más
+ * cercano, como la instrucción F16C, que se usa si está disponible; la
+ * versión en software da los mismos bits.
+ */
+
+/**
+ * Pasa un float a 16 bits
+ * @param f Valor (los mayores de 65504 pasan a infinito)
+ * @return Bits del flotante de 16 bits
+ */
+inline uint16_t aFlotante16(float f) {
+#if defined(__F16C__)
+    return _cvtss_sh(f, _MM_FROUND_TO_NEAREST_INT);
+#else
+    uint32_t b;
+    std::memcpy(&b, &f, sizeof(b));
+    uint16_t signo = (uint16_t)((b >> 16) & 0x8000u);
+    uint32_t absoluto = b & 0x7FFFFFFFu;
+    if (absoluto >= 0x7F800000u) {
+        // Infinito o NaN (el NaN conserva un bit de mantisa)
+        return signo | 0x7C00u | (absoluto > 0x7F800000u ? 0x200u | ((absoluto >> 13) & 0x3FFu) : 0);
+    }
+    if (absoluto >= 0x477FF000u) {
+        // Redondea por encima de 65504
+        return signo | 0x7C00u;
+    }
+    if (absoluto < 0x38800000u) {
+        // Subnormal de 16 bits (o cero): la mantisa con el 1 implícito,
+        // desplazada hasta el exponente mínimo
+        if (absoluto < 0x33000000u) {
+            return signo;
+        }
+        int exponente = (int)(absoluto >> 23);
+        uint32_t mantisa = (absoluto & 0x7FFFFFu) | 0x800000u;
+        int desplazamiento = 126 - exponente;
+        uint32_t resultado = mantisa >> desplazamiento;
+        uint32_t resto = mantisa & ((1u << desplazamiento) - 1);
+        uint32_t mitad = 1u << (desplazamiento - 1);
+        if (resto > mitad || (resto == mitad && (resultado & 1))) {
+            resultado++;
+        }
+        return signo | (uint16_t)resultado;
+    }
+    // Normal: se cambia el sesgo del exponente y se redondea la mantisa (el
+    // acarreo pasa al exponente, que es lo correcto)
+    uint32_t resultado = (absoluto - 0x38000000u) >> 13;
+    uint32_t resto = absoluto & 0x1FFFu;
+    if (resto > 0x1000u || (resto == 0x1000u && (resultado & 1))) {
+        resultado++;
+    }
+    return signo | (uint16_t)resultado;
+#endif
+}
+
+/**
+ * Pasa un float a 16 bits con redondeo estocástico: sube al siguiente con
+ * probabilidad igual a la fracción que se pierde, así que en media no se
+ * pierde nada (sumar algo menor que medio ulp no se queda siempre en cero).
+ * Fuera del rango normal (subnormales, grandes, infinito, NaN) redondea al
+ * más cercano
+ * @param f Valor
+ * @param azar Bits aleatorios (se usan los 13 bajos)
+ * @return Bits del flotante de 16 bits
+ */
+inline uint16_t aFlotante16(float f, uint32_t azar) {
+    uint32_t b;
+    std::memcpy(&b, &f, sizeof(b));
+    uint32_t absoluto = b & 0x7FFFFFFFu;
+    if (absoluto < 0x38800000u || absoluto >= 0x477FE000u) {
+        return aFlotante16(f);
+    }
+    // Los 13 bits que se descartan más un azar de 13 bits: hay acarreo con
+    // probabilidad igual a la fracción descartada
+    absoluto += azar & 0x1FFFu;
+    return (uint16_t)((b >> 16) & 0x8000u) | (uint16_t)((absoluto - 0x38000000u) >> 13);
+}
+
+/**
+ * Pasa 16 bits a float (exacto: todo flotante de 16 bits cabe en un float)
+ * @param h Bits del flotante de 16 bits
+ * @return Valor
+ */
+inline float deFlotante16(uint16_t h) {
+#if defined(__F16C__)
+    return _cvtsh_ss(h);
+#else
+    uint32_t signo = (uint32_t)(h & 0x8000u) << 16;
+    uint32_t exponente = (h >> 10) & 0x1Fu;
+    uint32_t mantisa = h & 0x3FFu;
+    uint32_t b;
+    if (exponente == 0x1Fu) {
+        b = signo | 0x7F800000u | (mantisa << 13);
+    } else if (exponente != 0) {
+        b = signo | ((exponente + 112) << 23) | (mantisa << 13);
+    } else if (mantisa == 0) {
+        b = signo;
+    } else {
+        // Subnormal: se normaliza
+        exponente = 113;
+        while ((mantisa & 0x400u) == 0) {
+            mantisa <<= 1;
+            exponente--;
+        }
+        b = signo | (exponente << 23) | ((mantisa & 0x3FFu) << 13);
+    }
+    float f;
+    std::memcpy(&f, &b, sizeof(f));
+    return f;
+#endif
+}
+
+#endif // FLOTANTE16_H
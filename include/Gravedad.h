@@ -0,0 +1,130 @@
+#ifndef GRAVEDAD_H
+#define GRAVEDAD_H
+
+#include "ConjuntoParticulas.h"
+
+/**
+ * Motor de gravedad de N cuerpos.
+ *
+ * Escribe en la aceleración de cada partícula la atracción de todas las
+ * demás y de los atractores (que no se mueven). La masa de un cuerpo es
+ * radio^2, así que un atractor de radio 35 pesa como ~50 partículas medias.
+ *
+ * Hay dos modos:
+ *  - DIRECTO: suma de todos los pares, O(n^2). Es exacto y sirve de referencia
+ *  - BARNES_HUT: árbol cuaternario, O(n log n). Un nodo de lado s a distancia
+ *    d se trata como un solo cuerpo si s/d < theta; theta = 0 equivale a la
+ *    suma directa y valores mayores cambian precisión por velocidad
+ *
+ * El árbol y los arrays auxiliares se reutilizan entre llamadas, de modo que
+ * tras los primeros pasos calcular() no reserva memoria.
+ */
+class MotorGravedad {
+public:
+    enum Modo { DIRECTO, BARNES_HUT };
+
+private:
+    /**
+     * Nodo del árbol cuaternario
+     */
+    struct Nodo {
+        float x0, y0, lado;   // Región cuadrada que cubre el nodo
+        float masa;           // Masa total contenida
+        float sx, sy;         // Momento (masa*posición); luego centro de masas
+        int hijo;             // Índice del primero de sus 4 hijos, o -1 si es hoja
+        int cuerpo;           // En una hoja: cuerpo que contiene, -1 vacía, -2 varios
+    };
+
+    Modo modo;
+    float G;          // Constante de gravitación
+    float theta;      // Criterio de apertura de Barnes-Hut
+    float suavizado;  // Distancia de suavizado (evita fuerzas infinitas)
+
+    // Cuerpos en formato SoA: primero las partículas y luego los atractores
+    float* x;
+    float* y;
+    float* m;
+    float* ax;
+    float* ay;
+    int capacidadCuerpos;
+    int numCuerpos;
+
+    // Árbol cuaternario en un array de nodos
+    Nodo* nodos;
+    int capacidadNodos;
+    int numNodos;
+
+    /**
+     * Copia posiciones y masas de la nube y los atractores a los arrays SoA
+     */
+    void recogerCuerpos(const ConjuntoParticulas& nube, const Particula* atractores, int numAtractores);
+
+    /**
+     * Añade 4 hijos vacíos a un nodo
+     * @param padre Índice del nodo
+     */
+    void subdividir(int padre);
+
+    /**
+     * Construye el árbol cuaternario con los cuerpos recogidos
+     */
+    void construirArbol();
+
+    /**
+     * Inserta un cuerpo en el árbol
+     * @param c Índice del cuerpo
+     */
+    void insertar(int c);
+
+    /**
+     * Aceleración sobre los cuerpos [0, n) con la suma directa
+     */
+    void sumaDirecta(int n);
+
+    /**
+     * Aceleración sobre los cuerpos [0, n) recorriendo el árbol
+     */
+    void sumaArbol(int n);
+
+public:
+    /**
+     * Constructor
+     * @param modo DIRECTO o BARNES_HUT
+     * @param G Constante de gravitación
+     * @param theta Criterio de apertura (sólo en BARNES_HUT)
+     * @param suavizado Distancia de suavizado
+     */
+    MotorGravedad(Modo modo = BARNES_HUT, float G = 1.0f, float theta = 0.5f, float suavizado = 5.0f);
+
+    MotorGravedad(const MotorGravedad&) = delete;
+    MotorGravedad& operator=(const MotorGravedad&) = delete;
+
+    /**
+     * Destructor
+     */
+    ~MotorGravedad();
+
+    void setModo(Modo modo);
+    void setG(float G);
+    void setTheta(float theta);
+    void setSuavizado(float suavizado);
+    Modo getModo() const;
+    float getTheta() const;
+
+    /**
+     * Sustituye la aceleración de cada partícula de la nube por la atracción
+     * gravitatoria, limitada en módulo a MAX_ACC
+     * @param nube Partículas que se atraen entre sí
+     * @param atractores Cuerpos fijos que atraen a la nube (puede ser nullptr)
+     * @param numAtractores Número de atractores
+     */
+    void calcular(ConjuntoParticulas& nube, const Particula* atractores = nullptr, int numAtractores = 0);
+
+    /**
+     * Número de nodos del último árbol construido
+     * @return Nodos
+     */
+    int getNumNodos() const;
+};
+
+#endif // GRAVEDAD_H
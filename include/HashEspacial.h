@@ -0,0 +1,155 @@
+#ifndef HASH_ESPACIAL_H
+#define HASH_ESPACIAL_H
+
+#include "Particula.h"
+#include <cmath>
+
+/**
+ * Hash espacial incremental de las partículas de un conjunto.
+ *
+ * El plano se divide en celdas cuadradas de lado tamCelda y cada celda
+ * (cx, cy) va a un cubo de una tabla de tamaño fijo, así que vale también
+ * para un mundo sin límites. Cada cubo es una lista doblemente enlazada de
+ * índices de partícula (los enlaces están en arrays por partícula, sin
+ * nodos sueltos), de modo que sacar o meter una partícula es O(1).
+ *
+ * El hash recuerda la celda de cada partícula. actualizar() recorre las
+ * posiciones y sólo reubica las que han cambiado de celda: con MAX_VEL <= 7
+ * y celdas del tamaño de un par de diámetros, en cada paso cambia una
+ * fracción pequeña. Los índices son los del array del conjunto: al quitar
+ * una partícula, la última ocupa su índice también en el hash.
+ *
+ * Varias celdas pueden caer en el mismo cubo: las consultas devuelven
+ * candidatas, que el que llama filtra por distancia.
+ */
+class HashEspacial {
+private:
+    float tamCelda;
+    float inverso;      // 1 / tamCelda
+    int numCubos;       // Potencia de 2
+    int* cabeza;        // Primera partícula de cada cubo (o -1)
+
+    // Por partícula (sólo crecen)
+    int* siguiente;     // Siguiente del mismo cubo (o -1)
+    int* anterior;      // Anterior del mismo cubo (o -1)
+    int* celdaX;        // Celda en la que está apuntada
+    int* celdaY;
+    int capacidad;
+    int numElementos;
+    long bytesReservados;   // Bytes pedidos al reservar memoria
+
+    /**
+     * Cubo de una celda
+     */
+    int cubo(int cx, int cy) const {
+        unsigned h = (unsigned)cx * 73856093u ^ (unsigned)cy * 19349663u;
+        return (int)(h & (unsigned)(numCubos - 1));
+    }
+
+    /**
+     * Celda que contiene una coordenada
+     */
+    int celda(float v) const {
+        return (int)std::floor(v * inverso);
+    }
+
+    void enlazar(int i);
+    void desenlazar(int i);
+
+    /**
+     * Asegura sitio para tam partículas
+     */
+    void reservar(int tam);
+
+public:
+    /**
+     * Constructor: hash vacío
+     * @param tamCelda Lado de las celdas
+     * @param numCubos Tamaño de la tabla (se redondea a potencia de 2)
+     */
+    HashEspacial(float tamCelda, int numCubos = 4096);
+
+    HashEspacial(const HashEspacial&) = delete;
+    HashEspacial& operator=(const HashEspacial&) = delete;
+
+    ~HashEspacial();
+
+    float getTamCelda() const;
+    int getNumElementos() const;
+
+    /**
+     * Bytes pedidos al reservar memoria desde que se creó
+     */
+    long getBytesReservados() const;
+
+    /**
+     * Vacía el hash y apunta las partículas [0, n) en su celda
+     * @param set Partículas
+     * @param n Número de partículas
+     */
+    void reconstruir(const Particula* set, int n);
+
+    /**
+     * Apunta una partícula nueva, que debe ser la siguiente del array
+     * (índice getNumElementos())
+     * @param pos Posición de la partícula
+     */
+    void insertar(const Vector2D& pos);
+
+    /**
+     * Quita la partícula i; la última pasa a ocupar el índice i, igual que
+     * en ConjuntoParticulas
+     * @param i Índice de la partícula quitada
+     */
+    void quitar(int i);
+
+    /**
+     * Comprueba la celda de la partícula i y la reubica si ha cambiado
+     * @param i Índice de la partícula
+     * @param pos Posición actual
+     * @return true si ha cambiado de celda
+     */
+    bool reubicar(int i, const Vector2D& pos);
+
+    /**
+     * Comprueba la celda de todas las partículas y reubica sólo las que
+     * han cambiado
+     * @param set Partículas (tantas como getNumElementos())
+     * @return Número de partículas que han cambiado de celda
+     */
+    int actualizar(const Particula* set);
+
+    /**
+     * Celda en la que está apuntada la partícula i
+     */
+    int getCeldaX(int i) const;
+    int getCeldaY(int i) const;
+
+    /**
+     * Llama a f(j) para cada partícula j apuntada en una celda que toca el
+     * cuadrado de centro (x, y) y semilado radio. Puede incluir partículas
+     * de otras celdas que comparten cubo; nunca repite una partícula
+     * @param x Centro
+     * @param y Centro
+     * @param radio Semilado del cuadrado
+     * @param f Función que recibe el índice de cada candidata
+     */
+    template <class F>
+    void paraCadaCandidata(float x, float y, float radio, F f) const {
+        int x0 = celda(x - radio), x1 = celda(x + radio);
+        int y0 = celda(y - radio), y1 = celda(y + radio);
+        for (int cy = y0; cy <= y1; cy++) {
+            for (int cx = x0; cx <= x1; cx++) {
+                for (int j = cabeza[cubo(cx, cy)]; j != -1; j = siguiente[j]) {
+                    // Sólo las de la propia celda: así otra celda del mismo
+                    // cubo no devuelve dos veces la misma partícula
+                    if (celdaX[j] == cx && celdaY[j] == cy) {
+                        f(j);
+                    }
+                }
+            }
+        }
+    }
+};
+
+#endif // HASH_ESPACIAL_H
@@ -0,0 +1,101 @@
+#ifndef INSTANTANEA_H
+#define INSTANTANEA_H
+
+#include "ConjuntoParticulas.h"
+
+/**
+ * Copia inmutable de las posiciones de un conjunto en un paso dado.
+ *
+ * La publica el hilo de simulación y la lee el de pintado, de modo que el
+ * pintado nunca accede al ConjuntoParticulas mientras se está simulando.
+ * La memoria se reutiliza entre capturas: sólo crece cuando el conjunto
+ * tiene más partículas que la capacidad reservada.
+ */
+class Instantanea {
+private:
+    float* x;              // Coordenada X de cada partícula
+    float* y;              // Coordenada Y de cada partícula
+    float* radio;          // Radio de cada partícula
+    int* tipo;             // Tipo de cada partícula
+    int capacidad;         // Capacidad de los arrays
+    int utiles;            // Partículas capturadas
+    int capacidadConjunto; // Capacidad del conjunto en el momento de la captura
+    long paso;             // Número de paso de simulación
+    long reordenaciones;   // getReordenaciones() del conjunto al capturar
+    double tiempo;         // Instante de publicación (segundos)
+
+    /**
+     * Asegura espacio para al menos tam partículas (no conserva datos)
+     * @param tam Número de partículas
+     */
+    void reservarMemoria(int tam);
+
+    /**
+     * Libera la memoria de los arrays
+     */
+    void liberarMemoria();
+
+public:
+    /**
+     * Constructor por defecto: instantánea vacía
+     */
+    Instantanea();
+
+    /**
+     * Constructor de copia
+     * @param otra Instantánea a copiar
+     */
+    Instantanea(const Instantanea& otra);
+
+    /**
+     * Destructor
+     */
+    ~Instantanea();
+
+    /**
+     * Operador de asignación (reutiliza la memoria si cabe)
+     * @param otra Instantánea a copiar
+     * @return Referencia a esta instantánea
+     */
+    Instantanea& operator=(const Instantanea& otra);
+
+    /**
+     * Copia las posiciones, radios y tipos del conjunto
+     * @param nube Conjunto a capturar
+     * @param paso Número de paso de simulación
+     * @param tiempo Instante de la captura en segundos
+     */
+    void capturar(const ConjuntoParticulas& nube, long paso, double tiempo);
+
+    /**
+     * Indica si esta instantánea y la anterior son de pasos consecutivos y
+     * contienen las mismas partículas en el mismo orden, y por tanto se
+     * pueden interpolar
+     * @param anterior Instantánea del paso previo
+     * @return true si se pueden interpolar
+     */
+    bool interpolable(const Instantanea& anterior) const;
+
+    /**
+     * Interpola una coordenada entre dos instantáneas interpolables; si el
+     * salto es mayor que medio mundo la partícula ha dado la vuelta (wrap)
+     * y no tiene sentido interpolar
+     * @param a Coordenada en la instantánea anterior
+     * @param b Coordenada en la actual
+     * @param alfa Fracción del intervalo transcurrida, en [0, 1]
+     * @param tamMundo Tamaño del mundo en el eje de la coordenada
+     * @return Coordenada interpolada (b si ha dado la vuelta)
+     */
+    static float interpolar(float a, float b, float alfa, float tamMundo);
+
+    int getUtiles() const;
+    int getCapacidadConjunto() const;
+    long getPaso() const;
+    double getTiempo() const;
+    float getX(int i) const;
+    float getY(int i) const;
+    float getRadio(int i) const;
+    int getTipo(int i) const;
+};
+
+#endif // INSTANTANEA_H
@@ -0,0 +1,127 @@
+#ifndef INTERACCIONES_H
+#define INTERACCIONES_H
+
+#include "ConjuntoParticulas.h"
+
+/**
+ * Motor de interacción por tipos ("particle life").
+ *
+ * Cada par de tipos (a, b) tiene una fuerza y un alcance: una partícula de
+ * tipo a se siente atraída (fuerza > 0) o repelida (fuerza < 0) por las de
+ * tipo b que estén a menos del alcance. La matriz no tiene por qué ser
+ * simétrica. A muy corta distancia todos los tipos se repelen, para que las
+ * partículas no se amontonen en un punto.
+ *
+ * Las partículas se copian a arrays SoA ordenados por celda y, dentro de
+ * cada celda, por tipo (ordenación por cuentas). Así los vecinos de tipo b
+ * de una celda forman un bloque contiguo que se recorre con un único par
+ * de coeficientes, en un bucle sin saltos que el compilador vectoriza
+ * (con -O3 -fno-math-errno, para que la raíz cuadrada no sea una llamada).
+ * Las celdas miden al menos el mayor alcance: basta mirar las 3x3 vecinas.
+ *
+ * Las partículas con un tipo fuera de [0, numTipos) no sienten ni ejercen
+ * fuerza. La rejilla y la periodicidad usan el mundo de la nube
+ * (nube.getMundo()).
+ */
+class MotorInteracciones {
+private:
+    int numTipos;
+    float* fuerza;      // fuerza[a * numTipos + b]: efecto de b sobre a
+    float* alcance;     // alcance[a * numTipos + b]
+    float escala;       // Aceleración por unidad de fuerza
+    float rozamiento;   // Fracción de la velocidad que se frena cada paso
+    bool periodico;     // Distancias con la imagen más cercana (modo wrap)
+
+    // Partículas ordenadas (SoA) y su posición en la nube
+    float* x;
+    float* y;
+    float* ax;
+    float* ay;
+    int* orden;
+    int* clave;         // Celda * numTipos + tipo de cada partícula de la nube (-1 si no cuenta)
+    int capacidadParticulas;
+
+    // Bloque (celda, tipo) k: partículas ordenadas [inicio[k], inicio[k+1])
+    int* inicio;
+    int capacidadBloques;
+    int celdasX, celdasY;
+    float tamX, tamY;
+    float anchoMundo, altoMundo; // Mundo de la nube de la última llamada
+
+    /**
+     * Copia la nube a los arrays SoA ordenados por celda y tipo
+     * @return Número de partículas que participan
+     */
+    int ordenar(const ConjuntoParticulas& nube);
+
+    /**
+     * Celda de la rejilla que contiene una coordenada (recortada al mundo)
+     */
+    int celda(float v, float tam, int numCeldas) const;
+
+    /**
+     * Celdas vecinas (3x3, sin repetir) de una celda
+     * @param vecinas Salida, como mucho 9 celdas
+     * @return Número de celdas vecinas
+     */
+    int vecinas(int cx, int cy, int* vecinas) const;
+
+public:
+    /**
+     * Constructor: todas las fuerzas a cero
+     * @param numTipos Número de tipos (como mínimo 1)
+     * @param alcance Alcance de todos los pares
+     * @param escala Aceleración por unidad de fuerza
+     * @param rozamiento Fracción de la velocidad que se frena cada paso
+     */
+    MotorInteracciones(int numTipos, float alcance = 40.0f, float escala = 0.3f, float rozamiento = 0.05f);
+
+    MotorInteracciones(const MotorInteracciones&) = delete;
+    MotorInteracciones& operator=(const MotorInteracciones&) = delete;
+
+    /**
+     * Destructor
+     */
+    ~MotorInteracciones();
+
+    int getNumTipos() const;
+    float getFuerza(int a, int b) const;
+    float getAlcance(int a, int b) const;
+
+    /**
+     * Fija la fuerza que ejercen las partículas de tipo b sobre las de tipo a
+     * @param fuerza Positiva atrae, negativa repele (normalmente en [-1, 1])
+     */
+    void setFuerza(int a, int b, float fuerza);
+
+    /**
+     * Fija el alcance de la fuerza de b sobre a
+     * @param alcance Distancia máxima (mayor que cero)
+     */
+    void setAlcance(int a, int b, float alcance);
+
+    void setEscala(float escala);
+    void setRozamiento(float rozamiento);
+
+    /**
+     * Elige si las distancias dan la vuelta por los bordes
+     * @param periodico true para el modo wrap
+     */
+    void setPeriodico(bool periodico);
+
+    /**
+     * Fuerzas aleatorias en [-1, 1] y alcances aleatorios en el rango dado
+     */
+    void aleatorizar(float alcanceMin, float alcanceMax);
+
+    /**
+     * Sustituye (o incrementa) la aceleración de cada partícula por la que
+     * le causan sus vecinas según la matriz de tipos, limitada en módulo a
+     * MAX_ACC
+     * @param nube Partículas que interactúan
+     * @param acumular true para sumar a la aceleración actual
+     */
+    void calcular(ConjuntoParticulas& nube, bool acumular = false);
+};
+
+#endif // INTERACCIONES_H
@@ -0,0 +1,112 @@
+#ifndef LOTES_COLISIONES_H
+#define LOTES_COLISIONES_H
+
+#include "Vector2D.h"
+#include "ParesPorHilo.h"
+
+class PoolTrabajo;
+
+/**
+ * Pares que colisionan en un paso, repartidos en lotes independientes para
+ * resolverlos en paralelo con el mismo resultado que en serie.
+ *
+ * Los pares se detectan en paralelo (cada hilo un tramo de filas i, con
+ * tramos de igual trabajo) y se juntan en el orden serie: i creciente y,
+ * para cada i, j creciente. Después se colorean las aristas con un
+ * voraz que respeta ese orden: el lote de un par es uno más que el último
+ * lote de cualquiera de sus dos partículas. Así
+ *  - dos pares de un mismo lote no comparten partícula: se pueden
+ *    resolver a la vez sin carreras,
+ *  - los pares de cada partícula quedan en lotes crecientes, en el mismo
+ *    orden que en serie, y como los choques de partículas distintas
+ *    conmutan, resolver lote a lote da exactamente el resultado serie.
+ *
+ * Todos los arrays sólo crecen.
+ */
+class LotesColisiones {
+private:
+    ParesPorHilo hilos;     // Pares encontrados por cada hilo
+
+    // Pares en orden serie y su lote
+    int* parI;
+    int* parJ;
+    int* lote;
+    int numPares;
+    int capacidadPares;
+
+    // Pares ordenados por lote: los del lote l son orden[inicio[l] .. inicio[l+1])
+    int* orden;
+    int* inicio;
+    int numLotes;
+    int capacidadLotes;
+
+    int* ultimo;        // Último lote de cada partícula
+    int capacidadUltimo;
+
+    long bytesReservados;   // Bytes pedidos al reservar memoria (sin contar hilos)
+
+    /**
+     * Asegura sitio para numPares pares en orden serie
+     */
+    void reservarPares();
+
+public:
+    LotesColisiones();
+
+    LotesColisiones(const LotesColisiones&) = delete;
+    LotesColisiones& operator=(const LotesColisiones&) = delete;
+
+    ~LotesColisiones();
+
+    /**
+     * Busca en paralelo todos los pares (i < j) de círculos que se solapan
+     * @param x Centros X (por columnas)
+     * @param y Centros Y
+     * @param r Radios
+     * @param n Número de círculos
+     * @param pool Hilos
+     */
+    void detectar(const Escalar* x, const Escalar* y, const Escalar* r, int n, PoolTrabajo& pool);
+
+    /**
+     * Toma pares ya detectados (p.ej. por RejillaOrdenada) en lugar de
+     * detectarlos. Deben venir en orden serie: i creciente y, para cada i,
+     * j creciente
+     * @param i Primera partícula de cada par
+     * @param j Segunda partícula de cada par
+     * @param n Número de pares
+     */
+    void cargar(const int* i, const int* j, int n);
+
+    /**
+     * Reparte los pares detectados en lotes sin partículas en común
+     * @param n Número de partículas
+     */
+    void repartir(int n);
+
+    int getPares() const;
+    int getLotes() const;
+
+    /**
+     * Primer par del lote l (en el orden por lotes)
+     */
+    int inicioLote(int l) const;
+
+    /**
+     * Posición siguiente al último par del lote l
+     */
+    int finLote(int l) const;
+
+    /**
+     * Partículas del par k en el orden por lotes
+     */
+    int getI(int k) const;
+    int getJ(int k) const;
+
+    /**
+     * Bytes pedidos al reservar memoria desde que se creó
+     */
+    long getBytesReservados() const;
+};
+
+#endif // LOTES_COLISIONES_H
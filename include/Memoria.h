@@ -0,0 +1,64 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <cstddef>
+
+/*
+ * Reserva de memoria para arrays grandes y topología NUMA.
+ *
+ * Linux coloca cada página en el nodo NUMA del hilo que la escribe por
+ * primera vez (first touch). reservarPaginas() devuelve memoria sin tocar,
+ * de modo que el reparto entre nodos lo decide quien la inicialice: si cada
+ * hilo de trabajo escribe primero el tramo que luego va a procesar, sus
+ * accesos son locales.
+ *
+ * La topología se lee de /sys/devices/system/node sin depender de libnuma;
+ * si no está disponible se supone un único nodo con todas las CPU.
+ */
+
+// Tamaño de página enorme (transparent huge pages en x86-64)
+const size_t TAM_PAGINA_ENORME = 2 * 1024 * 1024;
+
+/**
+ * Reserva memoria sin inicializar. A partir de TAM_PAGINA_ENORME bytes se
+ * proyecta con mmap alineada a página enorme y se pide al núcleo que use
+ * páginas enormes (madvise); por debajo, con operator new
+ * @param bytes Bytes a reservar
+ * @return Memoria reservada (lanza std::bad_alloc si no hay)
+ */
+void* reservarPaginas(size_t bytes);
+
+/**
+ * Libera memoria de reservarPaginas()
+ * @param p Memoria (puede ser nullptr)
+ * @param bytes Los mismos bytes que se pidieron al reservarla
+ */
+void liberarPaginas(void* p, size_t bytes);
+
+/**
+ * Número de nodos NUMA de la máquina (como mínimo 1)
+ */
+int numNodos();
+
+/**
+ * CPU de un nodo NUMA
+ * @param nodo Nodo
+ * @param cpus Salida
+ * @param max Tamaño de cpus
+ * @return Número de CPU del nodo (como mucho max)
+ */
+int cpusDeNodo(int nodo, int* cpus, int max);
+
+/**
+ * Fija el hilo que llama a una CPU
+ * @return false si no se pudo
+ */
+bool fijarHilo(int cpu);
+
+/**
+ * Nodo NUMA en el que está la página de una dirección
+ * @return Nodo, o -1 si no se sabe (p.ej. la página aún no se ha tocado)
+ */
+int nodoDeDireccion(const void* p);
+
+#endif // MEMORIA_H
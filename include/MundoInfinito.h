@@ -0,0 +1,182 @@
+#ifndef MUNDO_INFINITO_H
+#define MUNDO_INFINITO_H
+
+#include "ConjuntoParticulas.h"
+#include <string>
+
+/**
+ * Mundo sin límites dividido en trozos cuadrados de lado fijo.
+ *
+ * Cada trozo tiene su propio ConjuntoParticulas con posiciones locales en
+ * [0, lado), de modo que la precisión no se degrada lejos del origen. Una
+ * partícula que sale de su trozo pasa al vecino correspondiente al final
+ * del paso (las colisiones sólo se comprueban dentro de cada trozo).
+ *
+ * Sólo se simulan los trozos cercanos a la cámara (a distancia de Chebyshev
+ * radioActivo o menos, en trozos). Los demás se congelan: sus partículas se
+ * serializan por columnas, se comprimen y se guardan en memoria o en disco,
+ * y el ConjuntoParticulas se libera. El trozo se recupera cuando la cámara
+ * vuelve a acercarse, así que la memoria ocupada depende del radio activo y
+ * no del tamaño del mundo. Las partículas que llegan a un trozo guardado
+ * (al cruzar un borde o con agregar) esperan sin comprimir en una lista del
+ * trozo y se le unen cuando se recupera: el trozo no se descomprime y
+ * vuelve a comprimir en cada paso en que le llega una.
+ *
+ * Al guardar y recuperar un trozo las partículas se conservan exactamente,
+ * pero sus manejadores dejan de ser válidos.
+ */
+class MundoInfinito {
+public:
+    enum Almacen { MEMORIA, DISCO };
+
+private:
+    /**
+     * Trozo del mundo
+     */
+    struct Trozo {
+        int cx, cy;                      // Coordenadas del trozo
+        ConjuntoParticulas* particulas;  // Partículas (nullptr si está guardado)
+        unsigned char* datos;            // Partículas comprimidas (sólo en MEMORIA)
+        int tamDatos;                    // Bytes comprimidos
+        int numParticulas;               // Partículas guardadas
+        Particula* pendientes;           // Llegadas mientras está guardado (sólo crece)
+        int numPendientes;
+        int capacidadPendientes;
+    };
+
+    float lado;
+    int radioActivo;
+    Almacen almacen;
+    std::string directorio;
+    ParametrosMundo mundoTrozo;  // Mundo de cada trozo: lado x lado
+
+    Trozo* trozos;
+    int capacidadTrozos;
+    int numTrozos;
+
+    // Tabla hash (direccionamiento abierto) de coordenadas -> trozo
+    int* tabla;
+    int capacidadTabla;  // Potencia de 2
+
+    // Buffers de serialización (sólo crecen)
+    unsigned char* crudo;
+    unsigned char* comprimido;
+    int capacidadBuffers;
+
+    long pasos;
+    long cargas;
+    long descargas;
+
+    /**
+     * Posición de un trozo en la tabla hash: la suya o la vacía donde iría
+     */
+    int buscarHueco(int cx, int cy) const;
+
+    /**
+     * Duplica la tabla hash y recoloca los trozos
+     */
+    void ampliarTabla();
+
+    /**
+     * Índice del trozo de unas coordenadas, creándolo vacío si no existe
+     */
+    int obtenerTrozo(int cx, int cy);
+
+    /**
+     * Asegura que los buffers de serialización tienen sitio para n bytes
+     * (más el peor caso de la compresión)
+     */
+    void reservarBuffers(int n);
+
+    /**
+     * Serializa, comprime y guarda un trozo; libera sus partículas
+     * @param t Índice del trozo
+     */
+    void guardar(int t);
+
+    /**
+     * Recupera las partículas de un trozo guardado
+     * @param t Índice del trozo
+     */
+    void cargar(int t);
+
+    /**
+     * Deja una partícula (en posición local) en un trozo: en su nube si
+     * está activo o en sus pendientes si está guardado
+     * @param t Índice del trozo
+     * @param p Partícula
+     */
+    void depositar(int t, const Particula& p);
+
+    /**
+     * Fichero de un trozo en DISCO
+     */
+    std::string rutaTrozo(int cx, int cy) const;
+
+public:
+    /**
+     * Constructor
+     * @param lado Lado de cada trozo
+     * @param radioActivo Trozos alrededor de la cámara que se simulan
+     * @param almacen MEMORIA (comprimido) o DISCO
+     * @param directorio Carpeta de los ficheros de los trozos (en DISCO)
+     */
+    MundoInfinito(float lado = MAX_X, int radioActivo = 2, Almacen almacen = MEMORIA,
+                  const std::string& directorio = ".");
+
+    MundoInfinito(const MundoInfinito&) = delete;
+    MundoInfinito& operator=(const MundoInfinito&) = delete;
+
+    /**
+     * Destructor: libera los trozos y borra sus ficheros
+     */
+    ~MundoInfinito();
+
+    /**
+     * Agrega una partícula en una posición global del mundo (la posición
+     * de la partícula se ignora)
+     * @param x Coordenada X global
+     * @param y Coordenada Y global
+     * @param part Partícula
+     */
+    void agregar(double x, double y, const Particula& part);
+
+    /**
+     * Avanza un paso: guarda o recupera trozos según la cámara, mueve y
+     * gestiona las colisiones de los trozos activos y pasa a su trozo las
+     * partículas que han cruzado un borde
+     * @param camX Coordenada X global de la cámara
+     * @param camY Coordenada Y global de la cámara
+     */
+    void avanzar(double camX, double camY);
+
+    /**
+     * Partículas del trozo si está activo
+     * @return Conjunto del trozo, o nullptr si no existe o está guardado
+     */
+    const ConjuntoParticulas* trozo(int cx, int cy) const;
+
+    float getLado() const;
+    int getTrozos() const;
+    int getTrozosActivos() const;
+
+    /**
+     * Partículas de todo el mundo, activas y guardadas (con las pendientes)
+     */
+    long getParticulas() const;
+
+    /**
+     * Bytes reservados para las partículas de los trozos activos
+     */
+    long getBytesActivos() const;
+
+    /**
+     * Bytes comprimidos de los trozos guardados (en memoria o en disco)
+     */
+    long getBytesGuardados() const;
+
+    long getCargas() const;
+    long getDescargas() const;
+};
+
+#endif // MUNDO_INFINITO_H
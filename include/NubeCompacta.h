@@ -0,0 +1,169 @@
+#ifndef NUBE_COMPACTA_H
+#define NUBE_COMPACTA_H
+
+#include "ConjuntoParticulas.h"
+#include <cstdint>
+
+class PoolTrabajo;
+class RejillaOrdenada;
+
+/**
+ * Nube de partículas en formato comprimido, para nubes tan grandes que no
+ * caben en memoria (o en las que el paso va limitado por el ancho de banda)
+ * como Particula, que ocupa más de 32 bytes.
+ *
+ * Cada partícula ocupa BYTES_POR_PARTICULA bytes, en columnas:
+ *  - posición: 16 bits por eje, en coma fija sobre el mundo ampliado en
+ *    radioMax por cada lado (paso de (maxX + 2 radioMax) / 65535),
+ *  - velocidad y aceleración: flotantes de 16 bits (Flotante16.h),
+ *  - radio: índice de 8 bits en una tabla de 256 radios repartidos entre
+ *    radioMin y radioMax del mundo (los de fuera se recortan),
+ *  - tipo: 8 bits.
+ * La vida no se guarda: las partículas de la nube compacta no caducan.
+ *
+ * Los núcleos descomprimen cada partícula al vuelo, le aplican en float el
+ * mismo movimiento que Particula (mover, rebotar y wrap) y la vuelven a
+ * comprimir, así que cada paso lee y escribe menos de la mitad de bytes.
+ * Las posiciones fuera del mundo ampliado se recortan a su borde.
+ *
+ * Al comprimir tras mover, posición y velocidad se redondean de forma
+ * estocástica: redondeando al más cercano, una partícula que avanza 9.4
+ * códigos por paso avanzaría siempre 9, y una aceleración pequeña no
+ * cambiaría nunca la velocidad. El azar sale de un hash de la partícula y
+ * del número de paso, así que el resultado no depende de los hilos.
+ *
+ * Un choque intercambia velocidades y aceleraciones, que se intercambian
+ * comprimidas, sin pérdida. La detección usa la RejillaOrdenada sobre
+ * columnas descomprimidas, en el orden de ConjuntoParticulas.
+ */
+class NubeCompacta {
+private:
+    ParametrosMundo mundo;
+    bool mundoFijo;         // El mundo es el de params.h: se usa MundoFijo
+
+    // Cuantización de las posiciones
+    float origenX, origenY; // Coordenada del código 0
+    float pasoX, pasoY;     // Distancia entre códigos consecutivos
+    float escalaX, escalaY; // 1 / paso
+
+    // Tabla de radios
+    float radios[256];
+    float escalaRadio;      // Índices por unidad de radio
+
+    // Columnas comprimidas (sólo crecen)
+    uint16_t* px;
+    uint16_t* py;
+    uint16_t* vx;
+    uint16_t* vy;
+    uint16_t* ax;
+    uint16_t* ay;
+    uint8_t* indicesRadio;
+    uint8_t* tipos;
+    int capacidad;
+    int utiles;
+    long pasos;             // Pasos movidos (semilla del redondeo)
+
+    // Columnas descomprimidas para detectar colisiones (sólo crecen)
+    Escalar* columnaX;
+    Escalar* columnaY;
+    Escalar* columnaR;
+    int capacidadColumnas;
+    RejillaOrdenada* rejilla;
+
+    void redimensionar(int nuevaCapacidad);
+
+    /**
+     * Código de posición: floor((v - origen) * escala + azar), recortado.
+     * Con azar = 0.5 es el más cercano; con azar uniforme en [0, 1), en
+     * media es exacto
+     */
+    uint16_t codificar(float v, float origen, float escala, float azar) const;
+    uint8_t indiceRadio(float r) const;
+
+    /**
+     * Mueve las partículas [desde, hasta) en el mundo m
+     */
+    template <class Mundo>
+    void moverEn(const Mundo& m, int tipo, int desde, int hasta);
+
+public:
+    // Bytes de cada partícula comprimida
+    static constexpr int BYTES_POR_PARTICULA = 6 * sizeof(uint16_t) + 2 * sizeof(uint8_t);
+
+    /**
+     * Constructor: nube vacía
+     * @param mundo Mundo de las partículas (fija la cuantización)
+     */
+    NubeCompacta(const ParametrosMundo& mundo = ParametrosMundo());
+
+    /**
+     * Constructor: comprime todas las partículas de un conjunto, en su mundo
+     * @param conjunto Conjunto de partida
+     */
+    explicit NubeCompacta(const ConjuntoParticulas& conjunto);
+
+    NubeCompacta(const NubeCompacta&) = delete;
+    NubeCompacta& operator=(const NubeCompacta&) = delete;
+
+    ~NubeCompacta();
+
+    int getUtiles() const;
+    const ParametrosMundo& getMundo() const;
+
+    /**
+     * Distancia entre dos posiciones representables en cada eje (el error
+     * de una posición comprimida es como mucho la mitad)
+     */
+    float getPasoX() const;
+    float getPasoY() const;
+
+    /**
+     * Agrega una partícula, comprimida
+     * @param p Partícula
+     */
+    void agregar(const Particula& p);
+
+    /**
+     * Partícula descomprimida
+     * @param i Posición
+     * @return Copia de la partícula
+     */
+    Particula obtener(int i) const;
+
+    /**
+     * Comprime una partícula en la posición i
+     * @param i Posición
+     * @param p Partícula
+     */
+    void reemplazar(int i, const Particula& p);
+
+    /**
+     * Agrega a un conjunto todas las partículas descomprimidas
+     * @param destino Conjunto de destino
+     */
+    void volcar(ConjuntoParticulas& destino) const;
+
+    /**
+     * Mueve todas las partículas
+     * @param tipo Tipo de movimiento: 0 = mover, 1 = mover+rebotar, 2 = mover+wrap
+     */
+    void mover(int tipo = 0);
+
+    /**
+     * Mueve las partículas repartidas entre los hilos del pool, cada uno en
+     * un tramo (el resultado es el mismo que con mover)
+     * @param pool Hilos
+     * @param tipo Tipo de movimiento
+     */
+    void moverParalelo(PoolTrabajo& pool, int tipo = 0);
+
+    /**
+     * Resuelve los choques: mismos pares y mismo orden que
+     * ConjuntoParticulas::gestionarColisiones con REJILLA_ORDENADA
+     * @param pool Hilos para buscar los pares (nullptr = en este hilo)
+     * @return Número de colisiones
+     */
+    int gestionarColisiones(PoolTrabajo* pool = nullptr);
+};
+
+#endif // NUBE_COMPACTA_H
@@ -0,0 +1,149 @@
+#ifndef OBSTACULOS_ESTATICOS_H
+#define OBSTACULOS_ESTATICOS_H
+
+#include "Particula.h"
+#include "Colision.h"
+
+// Profundidad máxima de la jerarquía (los nodos más hondos son hojas)
+const int PROFUNDIDAD_MAX_BVH = 48;
+
+/**
+ * Obstáculos circulares que no se mueven, en una jerarquía de volúmenes
+ * envolventes (BVH) que se construye una vez.
+ *
+ * Antes, un obstáculo era una Particula(1) más de la nube: se comprobaba
+ * contra todas las demás partículas, incluidos los otros obstáculos, y el
+ * choque le pasaba la velocidad de la partícula que lo golpeaba. Aquí los
+ * obstáculos van aparte: cada partícula de la nube baja por el árbol
+ * descartando las cajas que no toca, con un coste O(log n), y los
+ * obstáculos nunca se comparan entre sí.
+ *
+ * El árbol se construye con la heurística de superficie (SAH) por
+ * intervalos: en cada nodo se prueban cortes en los dos ejes (12
+ * intervalos de centros por eje) y se elige el de menor coste esperado,
+ * semiperímetro de cada lado por número de obstáculos, o una hoja si
+ * partir no sale a cuenta. Los obstáculos se reordenan para que los de
+ * cada hoja estén seguidos. Los nodos van en un array plano: los hijos de
+ * un nodo interior son primero y primero + 1.
+ *
+ * Todo va en Escalar y los intervalos se calculan con aritmética del
+ * propio tipo: con SIMULACION_FIJA el árbol y los rebotes salen iguales en
+ * cualquier máquina.
+ */
+class ObstaculosEstaticos {
+private:
+    /**
+     * Nodo del árbol. Si cuenta > 0 es una hoja con los obstáculos
+     * [primero, primero + cuenta); si no, sus hijos son primero y primero + 1
+     */
+    struct Nodo {
+        Escalar minX, minY, maxX, maxY;
+        int primero;
+        int cuenta;
+    };
+
+    // Obstáculos (SoA), en el orden del árbol tras construir()
+    Escalar* x;
+    Escalar* y;
+    Escalar* radio;
+    int capacidad;
+    int utiles;
+
+    Nodo* nodos;
+    int numNodos;
+    int capacidadNodos;
+    int profundidad;
+
+    void redimensionar(int nuevaCapacidad);
+
+    /**
+     * Caja de los obstáculos del nodo
+     */
+    void ajustarCaja(Nodo& nodo) const;
+
+    /**
+     * Parte un nodo (o lo deja como hoja) y sigue con sus hijos
+     */
+    void subdividir(int indice, int nivel);
+
+    void intercambiar(int a, int b);
+
+public:
+    /**
+     * Constructor: sin obstáculos
+     */
+    ObstaculosEstaticos();
+
+    ObstaculosEstaticos(const ObstaculosEstaticos&) = delete;
+    ObstaculosEstaticos& operator=(const ObstaculosEstaticos&) = delete;
+
+    ~ObstaculosEstaticos();
+
+    /**
+     * Agrega un obstáculo. No cuenta en las consultas hasta el siguiente
+     * construir()
+     * @param pos Centro
+     * @param radio Radio
+     */
+    void agregar(const Vector2D& pos, Escalar radio);
+
+    /**
+     * Construye el árbol con todos los obstáculos. Cambia su orden
+     */
+    void construir();
+
+    int getUtiles() const;
+    Vector2D getPos(int i) const;
+    Escalar getRadio(int i) const;
+
+    /**
+     * Nodos y profundidad del árbol del último construir()
+     */
+    int getNodos() const;
+    int getProfundidad() const;
+
+    /**
+     * Llama a f(k) para cada obstáculo k que se solapa con el círculo
+     * @param px Centro del círculo
+     * @param py Centro del círculo
+     * @param pr Radio del círculo
+     * @param f Función que recibe el índice del obstáculo
+     */
+    template <class F>
+    void paraCadaSolapado(Escalar px, Escalar py, Escalar pr, F f) const {
+        if (numNodos == 0) {
+            return;
+        }
+        int pila[PROFUNDIDAD_MAX_BVH + 2];
+        int n = 0;
+        pila[n++] = 0;
+        while (n > 0) {
+            const Nodo& nodo = nodos[pila[--n]];
+            if (px + pr < nodo.minX || px - pr > nodo.maxX || py + pr < nodo.minY || py - pr > nodo.maxY) {
+                continue;
+            }
+            if (nodo.cuenta > 0) {
+                for (int k = nodo.primero; k < nodo.primero + nodo.cuenta; k++) {
+                    if (solapan(x[k] - px, y[k] - py, pr + radio[k])) {
+                        f(k);
+                    }
+                }
+            } else {
+                pila[n++] = nodo.primero + 1;
+                pila[n++] = nodo.primero;
+            }
+        }
+    }
+
+    /**
+     * Hace rebotar una partícula en los obstáculos que toca: la velocidad
+     * se refleja respecto a la normal de cada contacto si la partícula se
+     * acerca al obstáculo (si ya se aleja no se toca, para que no quede
+     * atrapada dentro)
+     * @param p Partícula
+     * @return Número de rebotes
+     */
+    int rebotar(Particula& p) const;
+};
+
+#endif // OBSTACULOS_ESTATICOS_H
@@ -0,0 +1,52 @@
+#ifndef PARAMETROS_MUNDO_H
+#define PARAMETROS_MUNDO_H
+
+#include "params.h"
+
+/**
+ * Parámetros del mundo elegidos en tiempo de ejecución: tamaño, velocidad
+ * máxima y rango de radios de las partículas nuevas. Por defecto valen lo
+ * mismo que las constantes de params.h.
+ *
+ * Particula::mover/rebotar/wrap son plantillas sobre el tipo del mundo:
+ * con ParametrosMundo leen los campos del objeto y con MundoFijo leen
+ * constantes de compilación con los mismos nombres, de modo que el bucle
+ * con los valores de params.h es tan rápido como cuando eran constantes.
+ */
+struct ParametrosMundo {
+    float maxX;       // Ancho del mundo
+    float maxY;       // Alto del mundo
+    float maxVel;     // Velocidad máxima de cada componente
+    float radioMin;   // Radio de las partículas aleatorias
+    float radioMax;
+
+    ParametrosMundo();
+
+    /**
+     * Mundo de un tamaño dado con el resto de valores de params.h
+     * @param maxX Ancho
+     * @param maxY Alto
+     */
+    ParametrosMundo(float maxX, float maxY);
+
+    /**
+     * Indica si todos los valores coinciden con los de params.h (y por
+     * tanto se puede usar MundoFijo)
+     * @return true si es el mundo de params.h
+     */
+    bool esFijo() const;
+};
+
+/**
+ * Mundo de params.h con los mismos nombres que ParametrosMundo, pero como
+ * constantes de compilación
+ */
+struct MundoFijo {
+    static constexpr float maxX = MAX_X;
+    static constexpr float maxY = MAX_Y;
+    static constexpr float maxVel = MAX_VEL;
+    static constexpr float radioMin = MIN_R;
+    static constexpr float radioMax = MAX_R;
+};
+
+#endif // PARAMETROS_MUNDO_H
@@ -0,0 +1,102 @@
+#ifndef PARES_POR_HILO_H
+#define PARES_POR_HILO_H
+
+/**
+ * Listas de pares (i, j) encontrados en paralelo, una por hilo.
+ *
+ * Cada hilo sólo agrega a la suya, así que crecen sin sincronizar. Si el
+ * hilo h recorre el tramo h de filas i, concatenar las listas en orden de
+ * hilo da los pares en orden serie. Las listas sólo crecen: tras las
+ * primeras llamadas agregar() no pide memoria.
+ */
+class ParesPorHilo {
+private:
+    /**
+     * Pares de un hilo
+     */
+    struct Lista {
+        int* i;
+        int* j;
+        int n;
+        int capacidad;
+        long bytes;     // Bytes pedidos por esta lista (cada hilo cuenta los suyos)
+    };
+
+    Lista* listas;
+    int numHilos;
+    long bytesLiberados;    // Bytes de las listas de antes de preparar() y de los arrays de listas
+
+    /**
+     * Duplica la capacidad de una lista
+     */
+    static void crecer(Lista& l);
+
+public:
+    ParesPorHilo();
+
+    ParesPorHilo(const ParesPorHilo&) = delete;
+    ParesPorHilo& operator=(const ParesPorHilo&) = delete;
+
+    ~ParesPorHilo();
+
+    /**
+     * Ajusta el número de listas (si cambia, se pierden las anteriores)
+     * @param hilos Número de hilos
+     */
+    void preparar(int hilos);
+
+    /**
+     * Vacía la lista de un hilo, sin liberar memoria
+     * @param h Hilo
+     */
+    void vaciar(int h);
+
+    /**
+     * Agrega un par a la lista de un hilo
+     * @param h Hilo
+     * @param i Primera partícula
+     * @param j Segunda partícula
+     */
+    void agregar(int h, int i, int j);
+
+    /**
+     * Pares de la lista de un hilo
+     * @param h Hilo
+     */
+    int getPares(int h) const;
+
+    /**
+     * Segundas partículas de la lista de un hilo (se pueden reordenar)
+     * @param h Hilo
+     */
+    int* paresJ(int h);
+
+    /**
+     * Pares de todas las listas
+     */
+    int total() const;
+
+    /**
+     * Copia todos los pares, concatenando las listas en orden de hilo
+     * @param i Destino de las primeras partículas (total() como mínimo)
+     * @param j Destino de las segundas
+     */
+    void concatenar(int* i, int* j) const;
+
+    /**
+     * Bytes pedidos al reservar memoria desde que se creó
+     */
+    long getBytesReservados() const;
+};
+
+inline void ParesPorHilo::agregar(int h, int i, int j) {
+    Lista& l = listas[h];
+    if (l.n >= l.capacidad) {
+        crecer(l);
+    }
+    l.i[l.n] = i;
+    l.j[l.n] = j;
+    l.n++;
+}
+
+#endif // PARES_POR_HILO_H
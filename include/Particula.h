@@ -3,6 +3,7 @@
 
 #include "Vector2D.h"
 #include "params.h"
+#include "ParametrosMundo.h"
 #include <string>
 #include <cstdlib>
 #include <ctime>
@@ -12,34 +13,50 @@ private:
     Vector2D pos;   // posición
     Vector2D acel;  // aceleración
     Vector2D veloc; // velocidad
-    float radio;
+    Escalar radio;
     int tipo;
+    int vida;       // pasos que le quedan, o VIDA_INFINITA
 
 public:
     // Constructor con valor por defecto
     Particula(int tipoPart = 0);
+
+    // Constructor de una partícula aleatoria (tipo 0) o estática en un mundo dado
+    Particula(const ParametrosMundo& mundo, int tipoPart = 0);
     
     // Constructor con parámetros
-    Particula(const Vector2D& pos, const Vector2D& acel, const Vector2D& veloc, float radio, int tipo);
+    Particula(const Vector2D& pos, const Vector2D& acel, const Vector2D& veloc, Escalar radio, int tipo);
     
-    // Métodos get/set
-    Vector2D getPos() const;
-    Vector2D getAcel() const;
-    Vector2D getVeloc() const;
-    float getRadio() const;
-    int getTipo() const;
+    // Métodos get/set. Los get devuelven referencias para que los bucles
+    // que sólo leen (p.ej. getPos().getX()) no creen copias
+    const Vector2D& getPos() const { return pos; }
+    const Vector2D& getAcel() const { return acel; }
+    const Vector2D& getVeloc() const { return veloc; }
+    Escalar getRadio() const { return radio; }
+    int getTipo() const { return tipo; }
+    int getVida() const { return vida; }
     
     void setPos(const Vector2D& pos);
     void setAcel(const Vector2D& acel);
     void setVeloc(const Vector2D& veloc);
-    void setRadio(float radio);
+    void setRadio(Escalar radio);
+    void setTipo(int tipo);
+    void setVida(int vida);
     
-    // Métodos de movimiento y colisión
+    // Métodos de movimiento y colisión (en el mundo de params.h)
     void mover();
     void rebotar();
     void wrap();
+
+    // Movimiento en otro mundo: Mundo es ParametrosMundo o MundoFijo
+    template <class Mundo> void mover(const Mundo& mundo);
+    template <class Mundo> void rebotar(const Mundo& mundo);
+    template <class Mundo> void wrap(const Mundo& mundo);
     bool colision(const Particula& otra) const;
     void choque(Particula& otra);
+
+    // Descuenta un paso de vida; devuelve true si la partícula ha caducado
+    bool envejecer();
     
     // Representación como string
     std::string toString() const;
@@ -0,0 +1,145 @@
+#ifndef PERFILADOR_H
+#define PERFILADOR_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Perfilador por fases con coste nulo cuando está desactivado.
+ *
+ * Se activa compilando con -DPERFILADO. Sin esa macro, PERFIL_AMBITO y
+ * PERFIL_FIN_FRAME no generan código. Con ella, cada PERFIL_AMBITO mide el
+ * tiempo hasta el final de su bloque (con rdtsc en x86, steady_clock en el
+ * resto) y lo suma a la fase indicada. PERFIL_FIN_FRAME cierra el frame
+ * del hilo actual: el total de cada fase pasa a su histórico, del que se
+ * sacan p50/p99/max.
+ *
+ * Cada hilo tiene su propio registro, así que medir no requiere bloqueos.
+ * informe() y exportarTraza() leen los registros de todos los hilos, por lo
+ * que deben llamarse cuando los hilos medidos ya han terminado o están
+ * parados.
+ */
+
+// Límites de los registros de cada hilo
+const int PERFIL_MAX_FASES = 16;    // Fases distintas en todo el programa
+const int PERFIL_MAX_FRAMES = 8192; // Frames guardados por fase (los últimos)
+const int PERFIL_MAX_HILOS = 16;    // Hilos medidos
+
+class Perfilador {
+private:
+    /**
+     * Evento para la traza de Chrome
+     */
+    struct Evento {
+        int fase;
+        uint64_t inicio;
+        uint64_t duracion;
+    };
+
+    int id;                                         // Identificador del hilo
+    uint64_t actual[PERFIL_MAX_FASES];              // Acumulado del frame en curso
+    bool usada[PERFIL_MAX_FASES];                   // Fases vistas en este hilo
+    uint64_t* muestras[PERFIL_MAX_FASES];           // Histórico circular por fase
+    long frames;                                    // Frames cerrados
+    Evento* eventos;                                // Eventos de traza (o nullptr)
+    int maxEventos;
+    int numEventos;
+
+    Perfilador(int id);
+
+public:
+    Perfilador(const Perfilador&) = delete;
+    Perfilador& operator=(const Perfilador&) = delete;
+    ~Perfilador();
+
+    /**
+     * Registro del hilo que llama (se crea la primera vez)
+     * @return Perfilador del hilo actual
+     */
+    static Perfilador& hilo();
+
+    /**
+     * Obtiene el índice de una fase, registrándola si es nueva
+     * @param nombre Nombre de la fase (literal de cadena)
+     * @return Índice de la fase, o -1 si no caben más
+     */
+    static int fase(const char* nombre);
+
+    /**
+     * Lee el reloj del perfilador (ciclos o nanosegundos)
+     * @return Marca de tiempo
+     */
+    static uint64_t reloj();
+
+    /**
+     * Activa la grabación de eventos para exportarTraza()
+     * @param maxEventos Eventos que se guardan como máximo por hilo
+     */
+    static void activarTraza(int maxEventos);
+
+    /**
+     * Suma un intervalo a una fase del frame en curso
+     * @param fase Índice de la fase
+     * @param inicio Marca de tiempo inicial
+     * @param fin Marca de tiempo final
+     */
+    void acumular(int fase, uint64_t inicio, uint64_t fin);
+
+    /**
+     * Cierra el frame en curso del hilo
+     */
+    void finFrame();
+
+    /**
+     * Percentil del total por frame de una fase en este hilo, sobre los
+     * últimos PERFIL_MAX_FRAMES frames cerrados
+     * @param fase Índice de la fase
+     * @param p Percentil de 0 a 100 (100 es el máximo)
+     * @return Unidades de reloj(), o 0 si la fase no tiene frames
+     */
+    uint64_t percentil(int fase, int p) const;
+
+    /**
+     * Tabla con p50, p99 y máximo por hilo y fase, en milisegundos por frame
+     * @return Texto del informe
+     */
+    static std::string informe();
+
+    /**
+     * Escribe los eventos grabados en formato trace_event de Chrome
+     * (se abre en chrome://tracing o en ui.perfetto.dev)
+     * @param ruta Fichero de salida
+     * @return false si no se pudo escribir
+     */
+    static bool exportarTraza(const std::string& ruta);
+};
+
+/**
+ * Mide desde su construcción hasta su destrucción
+ */
+class AmbitoPerfil {
+private:
+    int fase;
+    uint64_t inicio;
+
+public:
+    explicit AmbitoPerfil(int fase) : fase(fase), inicio(Perfilador::reloj()) {}
+    ~AmbitoPerfil() {
+        Perfilador::hilo().acumular(fase, inicio, Perfilador::reloj());
+    }
+};
+
+#define PERFIL_CONCAT2(a, b) a##b
+#define PERFIL_CONCAT(a, b) PERFIL_CONCAT2(a, b)
+
+#ifdef PERFILADO
+#define PERFIL_AMBITO(nombre) \
+    static const int PERFIL_CONCAT(perfilFase, __LINE__) = Perfilador::fase(nombre); \
+    AmbitoPerfil PERFIL_CONCAT(perfilAmbito, __LINE__)(PERFIL_CONCAT(perfilFase, __LINE__))
+#define PERFIL_FIN_FRAME() Perfilador::hilo().finFrame()
+#else
+#define PERFIL_AMBITO(nombre) ((void)0)
+#define PERFIL_FIN_FRAME() ((void)0)
+#endif
+
+#endif // PERFILADOR_H
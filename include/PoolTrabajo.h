@@ -0,0 +1,134 @@
+#ifndef POOL_TRABAJO_H
+#define POOL_TRABAJO_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+/**
+ * Pool de hilos con robo de trabajo para bucles de tareas independientes.
+ *
+ * paraCada(n, f) reparte los índices [0, n) en un rango contiguo por hilo.
+ * Cada hilo consume su rango por delante; cuando se le acaba, roba la
+ * mitad trasera del rango de otro hilo. Así, aunque unas tareas tarden
+ * mucho más que otras (p.ej. una nube que se vacía pronto frente a otra
+ * que llega al final), ningún hilo se queda parado mientras quede trabajo.
+ *
+ * Los hilos se crean una vez y esperan dormidos entre llamadas. La tarea
+ * se pasa por referencia (sin copiarla a un std::function), así que lanzar
+ * un trabajo no pide memoria.
+ */
+class PoolTrabajo {
+private:
+    /**
+     * Referencia a una tarea f(int) de cualquier tipo, sin copiarla. Sólo
+     * vale mientras f exista: lanzar() espera a que termine el trabajo
+     */
+    struct Tarea {
+        const void* objeto;
+        void (*llamar)(const void* objeto, int i);
+
+        template <class F>
+        explicit Tarea(const F& f)
+            : objeto(&f), llamar([](const void* o, int i) { (*static_cast<const F*>(o))(i); }) {}
+    };
+
+    /**
+     * Índices pendientes de un hilo: [inicio, fin)
+     */
+    struct Cola {
+        std::mutex m;
+        int inicio;
+        int fin;
+    };
+
+    std::thread* hilos;
+    Cola* colas;
+    int numHilos;
+
+    std::mutex m;
+    std::condition_variable hayTrabajo;
+    std::condition_variable terminado;
+    const Tarea* tarea;                     // Tarea del trabajo en curso
+    long trabajo;                           // Número del trabajo en curso
+    int activos;                            // Hilos que no han acabado el trabajo en curso
+    bool conRobo;                           // El trabajo en curso permite robar
+    bool salir;
+    std::atomic<long> robos;
+
+    /**
+     * Bucle de cada hilo del pool
+     * @param id Número del hilo
+     */
+    void trabajar(int id);
+
+    /**
+     * Saca el siguiente índice de la cola propia
+     * @return false si la cola está vacía
+     */
+    bool tomar(int id, int& indice);
+
+    /**
+     * Roba la mitad trasera de la cola de otro hilo y la pasa a la propia
+     * @return false si no queda trabajo en ninguna cola
+     */
+    bool robar(int id);
+
+    /**
+     * Reparte las colas, lanza el trabajo y espera a que termine
+     * @param n Número de tareas
+     * @param f Tarea
+     * @param robo true si los hilos pueden robarse índices
+     */
+    void lanzar(int n, const Tarea& f, bool robo);
+
+public:
+    /**
+     * Constructor
+     * @param numHilos Hilos del pool (0 = uno por núcleo)
+     */
+    PoolTrabajo(int numHilos = 0);
+
+    PoolTrabajo(const PoolTrabajo&) = delete;
+    PoolTrabajo& operator=(const PoolTrabajo&) = delete;
+
+    /**
+     * Destructor: despierta a los hilos y espera a que terminen
+     */
+    ~PoolTrabajo();
+
+    int getNumHilos() const;
+
+    /**
+     * Rangos robados desde que se creó el pool
+     * @return Número de robos
+     */
+    long getRobos() const;
+
+    /**
+     * Ejecuta f(i) para cada i en [0, n) repartido entre los hilos del pool
+     * y espera a que terminen todas. Cada índice se ejecuta exactamente una
+     * vez, en un hilo cualquiera
+     * @param n Número de tareas
+     * @param f Tarea: cualquier función o lambda que reciba un int
+     */
+    template <class F>
+    void paraCada(int n, const F& f) {
+        lanzar(n, Tarea(f), true);
+    }
+
+    /**
+     * Ejecuta f(h) exactamente una vez en cada hilo h del pool, sin robos,
+     * y espera a que terminen todos. Sirve para que cada hilo trabaje
+     * siempre sobre el mismo tramo de un array (p.ej. el que tocó primero,
+     * para que sus páginas estén en su nodo NUMA)
+     * @param f Tarea, recibe el número de hilo
+     */
+    template <class F>
+    void enCadaHilo(const F& f) {
+        lanzar(numHilos, Tarea(f), false);
+    }
+};
+
+#endif // POOL_TRABAJO_H
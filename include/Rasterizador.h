@@ -0,0 +1,101 @@
+#ifndef RASTERIZADOR_H
+#define RASTERIZADOR_H
+
+#include <cstdint>
+#include <string>
+
+// Color RGBA empaquetado: en memoria los bytes quedan en orden R, G, B, A
+typedef uint32_t ColorRGBA;
+
+/**
+ * Construye un color RGBA
+ * @return Color empaquetado
+ */
+inline ColorRGBA colorRGBA(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255) {
+    return (ColorRGBA)r | ((ColorRGBA)g << 8) | ((ColorRGBA)b << 16) | ((ColorRGBA)a << 24);
+}
+
+// Los mismos colores que usa raylib en el visor
+const ColorRGBA RGBA_RAYWHITE = colorRGBA(245, 245, 245);
+const ColorRGBA RGBA_RED      = colorRGBA(230, 41, 55);
+const ColorRGBA RGBA_BLUE     = colorRGBA(0, 121, 241);
+const ColorRGBA RGBA_BLACK    = colorRGBA(0, 0, 0);
+const ColorRGBA RGBA_GREEN    = colorRGBA(0, 228, 48);
+const ColorRGBA RGBA_YELLOW   = colorRGBA(253, 249, 0);
+const ColorRGBA RGBA_MAGENTA  = colorRGBA(255, 0, 255);
+
+/**
+ * Rasterizador por software sobre un framebuffer RGBA en memoria.
+ *
+ * Todas las primitivas se reducen a tramos horizontales, que se rellenan
+ * con instrucciones SIMD (AVX2 o SSE2 según el compilador) escribiendo
+ * varios píxeles por instrucción. No necesita ventana ni GPU.
+ */
+class Rasterizador {
+private:
+    ColorRGBA* pixeles;  // Framebuffer, fila a fila
+    int ancho;           // Ancho en píxeles
+    int alto;            // Alto en píxeles
+
+    /**
+     * Rellena los píxeles [x0, x1) de la fila y (ya recortados)
+     */
+    void tramo(int y, int x0, int x1, ColorRGBA color);
+
+public:
+    /**
+     * Constructor
+     * @param ancho Ancho del framebuffer en píxeles
+     * @param alto Alto del framebuffer en píxeles
+     */
+    Rasterizador(int ancho, int alto);
+
+    Rasterizador(const Rasterizador&) = delete;
+    Rasterizador& operator=(const Rasterizador&) = delete;
+
+    /**
+     * Destructor
+     */
+    ~Rasterizador();
+
+    int getAncho() const;
+    int getAlto() const;
+
+    /**
+     * Acceso de sólo lectura al framebuffer (ancho*alto píxeles)
+     * @return Puntero al primer píxel
+     */
+    const ColorRGBA* getPixeles() const;
+
+    /**
+     * Rellena todo el framebuffer con un color
+     * @param color Color de fondo
+     */
+    void limpiar(ColorRGBA color);
+
+    /**
+     * Pinta un círculo relleno (mismo criterio que DrawCircle de raylib)
+     * @param cx Centro X en píxeles
+     * @param cy Centro Y en píxeles
+     * @param radio Radio en píxeles
+     * @param color Color de relleno
+     */
+    void circulo(float cx, float cy, float radio, ColorRGBA color);
+
+    /**
+     * Pinta un rectángulo relleno
+     */
+    void rectangulo(int x, int y, int w, int h, ColorRGBA color);
+
+    /**
+     * Pinta texto con una fuente de mapa de bits de 5x7
+     * @param texto Texto a pintar (las minúsculas se pintan como mayúsculas)
+     * @param x Esquina superior izquierda X
+     * @param y Esquina superior izquierda Y
+     * @param tam Tamaño de letra, con el mismo significado que en DrawText
+     * @param color Color del texto
+     */
+    void texto(const std::string& texto, int x, int y, int tam, ColorRGBA color);
+};
+
+#endif // RASTERIZADOR_H
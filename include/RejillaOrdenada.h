@@ -0,0 +1,140 @@
+#ifndef REJILLA_ORDENADA_H
+#define REJILLA_ORDENADA_H
+
+#include "Vector2D.h"
+#include "ParesPorHilo.h"
+
+class PoolTrabajo;
+
+/**
+ * Fase amplia de colisiones por ordenación, sin tabla hash.
+ *
+ * En cada llamada:
+ *  1. calcula la celda de cada partícula en una rejilla que cubre su caja
+ *     envolvente, con celdas de lado 2 * radio máximo (dos círculos que se
+ *     tocan están en la misma celda o en celdas vecinas),
+ *  2. ordena los pares (celda, índice) con una ordenación radix LSD de 8
+ *     bits por pasada; cada hilo cuenta y reparte su tramo, así que la
+ *     ordenación es estable y sale igual con cualquier número de hilos,
+ *  3. saca el inicio de cada celda en el array ordenado (las partículas de
+ *     la celda c son [inicio[c], inicio[c+1])),
+ *  4. para cada partícula i recorre las 3x3 celdas vecinas y apunta los
+ *     pares (i, j) con j > i que se solapan (solapan()), con j creciente.
+ *
+ * Los pares salen en el mismo orden que en la comprobación de todos contra
+ * todos (i creciente, j creciente), con la misma comparación, así que
+ * resolverlos en ese orden da exactamente el mismo resultado.
+ *
+ * Todos los arrays sólo crecen: tras las primeras llamadas no se pide
+ * memoria. Si el pool es nullptr todo se hace en el hilo que llama.
+ */
+class RejillaOrdenada {
+private:
+    /**
+     * Resultados parciales del tramo de un hilo
+     */
+    struct Tramo {
+        long candidatos;
+        float minX, minY, maxX, maxY, maxR;  // Caja del tramo
+    };
+
+    Tramo* hilos;
+    int numHilos;
+    ParesPorHilo pares;     // Pares encontrados por cada hilo
+
+    // Por partícula
+    unsigned* celdaDe;      // Celda de la partícula i (orden original)
+    unsigned* clave;        // Celdas ordenadas
+    int* indice;            // Partícula de cada celda ordenada
+    unsigned* claveAux;     // Destino de cada pasada de la radix
+    int* indiceAux;
+    Escalar* xs;            // Posiciones y radios en el orden de las celdas
+    Escalar* ys;
+    Escalar* rs;
+    int capacidad;
+
+    // Rejilla
+    float minX, minY;
+    float tamCelda;
+    int celdasX, celdasY;
+    int* inicio;            // celdasX * celdasY + 1
+    int capacidadCeldas;
+
+    unsigned* cuentas;      // 256 por hilo
+    int capacidadCuentas;
+
+    // Pares en orden serie
+    int* parI;
+    int* parJ;
+    int numPares;
+    int capacidadPares;
+    long candidatos;
+    long bytesReservados;   // Bytes pedidos al reservar memoria (sin contar pares)
+
+    /**
+     * Ajusta los buffers de los hilos al pool
+     */
+    void prepararHilos(int hilos);
+
+    /**
+     * Asegura sitio para n partículas
+     */
+    void reservar(int n);
+
+    /**
+     * Ordenación radix de (clave, indice) por la celda
+     */
+    void ordenar(int n, PoolTrabajo* pool);
+
+public:
+    RejillaOrdenada();
+
+    RejillaOrdenada(const RejillaOrdenada&) = delete;
+    RejillaOrdenada& operator=(const RejillaOrdenada&) = delete;
+
+    ~RejillaOrdenada();
+
+    /**
+     * Busca todos los pares (i < j) de círculos que se solapan
+     * @param x Centros X (por columnas)
+     * @param y Centros Y
+     * @param r Radios
+     * @param n Número de círculos
+     * @param pool Hilos (nullptr = en el hilo que llama)
+     * @return Número de pares
+     */
+    int buscarPares(const Escalar* x, const Escalar* y, const Escalar* r, int n, PoolTrabajo* pool = nullptr);
+
+    int getPares() const;
+
+    /**
+     * Partículas del par k (orden serie)
+     */
+    int getI(int k) const;
+    int getJ(int k) const;
+
+    /**
+     * Arrays de pares en orden serie
+     */
+    const int* paresI() const;
+    const int* paresJ() const;
+
+    /**
+     * Pares comprobados con la distancia en la última búsqueda
+     */
+    long getCandidatos() const;
+
+    /**
+     * Rejilla de la última búsqueda
+     */
+    int getCeldasX() const;
+    int getCeldasY() const;
+    float getTamCelda() const;
+
+    /**
+     * Bytes pedidos al reservar memoria desde que se creó
+     */
+    long getBytesReservados() const;
+};
+
+#endif // REJILLA_ORDENADA_H
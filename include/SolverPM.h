@@ -0,0 +1,119 @@
+#ifndef SOLVER_PM_H
+#define SOLVER_PM_H
+
+#include "ConjuntoParticulas.h"
+#include <complex>
+
+/**
+ * Solver de gravedad partícula-malla (PM) para nubes muy densas.
+ *
+ * Cada paso:
+ *  1. Reparte la masa de las partículas (radio^2) en una rejilla que cubre
+ *     el mundo (maxX x maxY) con el esquema cloud-in-cell (cada partícula pesa en
+ *     las 4 celdas más cercanas).
+ *  2. Calcula el potencial con FFT: la convolución de la masa con la
+ *     función de Green -G/sqrt(r^2 + e^2), la misma ley que MotorGravedad,
+ *     es un producto en el espacio de frecuencias.
+ *  3. Deriva la aceleración del potencial por diferencias centradas y la
+ *     interpola a cada partícula con los mismos pesos del reparto.
+ *
+ * El coste es O(M log M + n) para una rejilla de M celdas y n partículas.
+ * La resolución está limitada al tamaño de celda: por debajo de esa
+ * distancia las fuerzas se suavizan.
+ *
+ * Contornos:
+ *  - PERIODICO (modo wrap): el mundo es un toro; la convolución circular
+ *    de la FFT suma la imagen más cercana de cada masa, como si las
+ *    distancias se midieran dando la vuelta por los bordes
+ *  - AISLADO (modo rebotar): no hay masa fuera del mundo; la rejilla se
+ *    dobla con ceros (método de Hockney) para que no haya imágenes
+ */
+class SolverPM {
+public:
+    enum Contorno { PERIODICO, AISLADO };
+
+private:
+    typedef std::complex<float> Complejo;
+
+    Contorno contorno;
+    float G;
+    int nx, ny;        // Celdas de la rejilla física (potencias de 2)
+    int fx, fy;        // Tamaño de las FFT (el doble en AISLADO)
+    float hx, hy;      // Tamaño de celda
+
+    Complejo* verde;   // Transformada de la función de Green (fx*fy)
+    Complejo* malla;   // Masa -> potencial (fx*fy)
+    Complejo* columna; // Auxiliar para las FFT por columnas
+    Complejo* raicesX; // Raíces de la unidad para FFT de tamaño fx
+    Complejo* raicesY; // Raíces de la unidad para FFT de tamaño fy
+    float* gx;         // Aceleración en la rejilla física (nx*ny)
+    float* gy;
+
+    /**
+     * FFT compleja in situ de tamaño potencia de 2
+     * @param a Datos
+     * @param n Tamaño
+     * @param raices Raíces exp(-2*pi*i*k/n), k < n/2
+     * @param inversa true para la transformada inversa (sin normalizar)
+     */
+    static void fft(Complejo* a, int n, const Complejo* raices, bool inversa);
+
+    /**
+     * FFT 2D de la rejilla de tamaño fx*fy (filas y luego columnas)
+     */
+    void fft2D(Complejo* datos, bool inversa);
+
+    /**
+     * Pesos cloud-in-cell de una coordenada: celdas i0 e i0+1 y peso de i0+1
+     * @return false si ninguna de las dos celdas está en la rejilla
+     */
+    bool pesos(float v, float h, int n, int& i0, int& i1, float& t) const;
+
+    /**
+     * Precalcula la transformada de la función de Green
+     * @param suavizado Distancia de suavizado
+     */
+    void prepararVerde(float suavizado);
+
+public:
+    /**
+     * Constructor
+     * @param celdasX Celdas en X (se redondea a potencia de 2)
+     * @param celdasY Celdas en Y (se redondea a potencia de 2)
+     * @param contorno PERIODICO o AISLADO
+     * @param G Constante de gravitación
+     * @param suavizado Distancia de suavizado (como mínimo, una celda)
+     * @param mundo Mundo que cubre la rejilla (el de las nubes que se calculen)
+     */
+    SolverPM(int celdasX = 128, int celdasY = 128, Contorno contorno = AISLADO,
+             float G = 1.0f, float suavizado = 5.0f, const ParametrosMundo& mundo = ParametrosMundo());
+
+    SolverPM(const SolverPM&) = delete;
+    SolverPM& operator=(const SolverPM&) = delete;
+
+    /**
+     * Destructor
+     */
+    ~SolverPM();
+
+    /**
+     * Contorno que corresponde a un modo de movimiento de ConjuntoParticulas
+     * @param modo 1 = rebotar, 2 = wrap
+     * @return PERIODICO para wrap, AISLADO en otro caso
+     */
+    static Contorno contornoPara(int modo);
+
+    int getCeldasX() const;
+    int getCeldasY() const;
+    Contorno getContorno() const;
+
+    /**
+     * Sustituye (o incrementa) la aceleración de cada partícula por la
+     * gravitatoria calculada en la malla, limitada en módulo a MAX_ACC
+     * @param nube Partículas que se atraen entre sí
+     * @param acumular true para sumar a la aceleración actual
+     */
+    void calcular(ConjuntoParticulas& nube, bool acumular = false);
+};
+
+#endif // SOLVER_PM_H
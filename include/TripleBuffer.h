@@ -0,0 +1,71 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>
+
+/**
+ * Triple buffer sin bloqueos para un productor y un consumidor.
+ *
+ * El productor escribe siempre en su propio buffer y lo publica
+ * intercambiándolo con el buffer intermedio; el consumidor recoge el
+ * intermedio cuando hay uno nuevo. Ninguno de los dos espera nunca al otro:
+ * el productor puede publicar más rápido de lo que se consume (los
+ * intermedios no leídos se sobrescriben) y el consumidor siempre lee el
+ * último estado completo.
+ */
+template <class T>
+class TripleBuffer {
+private:
+    // Bit que indica que el buffer intermedio contiene datos no leídos
+    static const unsigned NUEVO = 4u;
+
+    T buffers[3];
+    std::atomic<unsigned> intermedio;  // Índice del intermedio (+ bit NUEVO)
+    unsigned escritura;                // Índice propiedad del productor
+    unsigned lectura;                  // Índice propiedad del consumidor
+
+public:
+    TripleBuffer() : intermedio(1), escritura(0), lectura(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /**
+     * Buffer en el que el productor prepara el siguiente estado
+     * @return Referencia al buffer de escritura
+     */
+    T& escribir() {
+        return buffers[escritura];
+    }
+
+    /**
+     * Publica el buffer de escritura como último estado disponible
+     */
+    void publicar() {
+        unsigned anterior = intermedio.exchange(escritura | NUEVO, std::memory_order_acq_rel);
+        escritura = anterior & ~NUEVO;
+    }
+
+    /**
+     * Recoge el último estado publicado, si lo hay
+     * @return true si el buffer de lectura ha cambiado
+     */
+    bool actualizar() {
+        if ((intermedio.load(std::memory_order_relaxed) & NUEVO) == 0) {
+            return false;
+        }
+        unsigned anterior = intermedio.exchange(lectura, std::memory_order_acq_rel);
+        lectura = anterior & ~NUEVO;
+        return true;
+    }
+
+    /**
+     * Último estado recogido por el consumidor
+     * @return Referencia constante al buffer de lectura
+     */
+    const T& leer() const {
+        return buffers[lectura];
+    }
+};
+
+#endif // TRIPLE_BUFFER_H
@@ -1,34 +1,169 @@
 #ifndef VECTOR2D_H
 #define VECTOR2D_H
 
+#include "Fijo.h"
 #include <string>
+#include <sstream>
 #include <cmath>
+#include <type_traits>
 
-class Vector2D {
+// Longitud de (x, y) sin pasar por x*x + y*y en el tipo T (que en coma
+// fija se desborda con valores mayores de 181)
+inline float hipotenusa(float x, float y) {
+    return std::sqrt(x*x + y*y);
+}
+
+inline double hipotenusa(double x, double y) {
+    return std::sqrt(x*x + y*y);
+}
+
+inline Fijo hipotenusa(Fijo x, Fijo y) {
+    int64_t x2 = (int64_t)x.getBruto() * x.getBruto();
+    int64_t y2 = (int64_t)y.getBruto() * y.getBruto();
+    return Fijo::desdeBruto((int32_t)raizEntera((uint64_t)x2 + (uint64_t)y2));
+}
+
+/**
+ * Vector de dos componentes de tipo T.
+ *
+ * Todo está en la cabecera y es constexpr (salvo lo que necesita una raíz
+ * cuadrada), de modo que los bucles de Particula y ConjuntoParticulas se
+ * pueden expandir en línea y vectorizar sin optimización en el enlazado.
+ * Es trivialmente copiable: se puede copiar con memcpy y guardar en arrays
+ * sin construir.
+ */
+template <class T>
+class Vector2DT {
 private:
-    float x, y;
+    T x, y;
 
 public:
+    using Componente = T;
+
     // Constructor con valores por defecto
-    Vector2D(float x = 0.0f, float y = 0.0f);
-    
+    constexpr Vector2DT(T x = T(0), T y = T(0)) : x(x), y(y) {}
+
     // Métodos get/set
-    float getX() const;
-    float getY() const;
-    void setX(float x);
-    void setY(float y);
-    void setXY(float x, float y);
-    
-    // Operaciones con vectores
-    void sumar(const Vector2D& otro);
-    void escalar(float factor);
-    float modulo() const;
-    void normalizar();
-    float distancia(const Vector2D& otro) const;
-    
+    constexpr T getX() const { return x; }
+    constexpr T getY() const { return y; }
+    constexpr void setX(T x) { this->x = x; }
+    constexpr void setY(T y) { this->y = y; }
+    constexpr void setXY(T x, T y) {
+        this->x = x;
+        this->y = y;
+    }
+
+    // Operaciones con vectores (nombres de siempre)
+
+    // Suma otro vector al actual
+    constexpr void sumar(const Vector2DT& otro) {
+        x += otro.x;
+        y += otro.y;
+    }
+
+    // Multiplica el vector por un factor escalar
+    constexpr void escalar(T factor) {
+        x *= factor;
+        y *= factor;
+    }
+
+    // Calcula el módulo (longitud) del vector
+    T modulo() const {
+        return hipotenusa(x, y);
+    }
+
+    // Normaliza el vector (lo convierte en vector unitario)
+    void normalizar() {
+        T mod = modulo();
+        if (mod > T(0)) {
+            T inv = T(1) / mod;
+            x *= inv;
+            y *= inv;
+        }
+    }
+
+    // Calcula la distancia euclidea entre este vector y otro
+    T distancia(const Vector2DT& otro) const {
+        return hipotenusa(x - otro.x, y - otro.y);
+    }
+
+    // Cuadrado de la distancia (sin raíz: para comparar distancias)
+    constexpr T distancia2(const Vector2DT& otro) const {
+        T dx = x - otro.x;
+        T dy = y - otro.y;
+        return dx*dx + dy*dy;
+    }
+
+    // Cuadrado del módulo
+    constexpr T modulo2() const {
+        return x*x + y*y;
+    }
+
+    // Producto escalar
+    constexpr T producto(const Vector2DT& otro) const {
+        return x*otro.x + y*otro.y;
+    }
+
+    // Producto vectorial (componente z del de los vectores en el plano)
+    constexpr T cruz(const Vector2DT& otro) const {
+        return x*otro.y - y*otro.x;
+    }
+
+    // Operadores
+    constexpr Vector2DT operator+(const Vector2DT& otro) const { return Vector2DT(x + otro.x, y + otro.y); }
+    constexpr Vector2DT operator-(const Vector2DT& otro) const { return Vector2DT(x - otro.x, y - otro.y); }
+    constexpr Vector2DT operator-() const { return Vector2DT(-x, -y); }
+    constexpr Vector2DT operator*(T factor) const { return Vector2DT(x * factor, y * factor); }
+    constexpr Vector2DT operator/(T divisor) const { return Vector2DT(x / divisor, y / divisor); }
+
+    constexpr Vector2DT& operator+=(const Vector2DT& otro) {
+        sumar(otro);
+        return *this;
+    }
+    constexpr Vector2DT& operator-=(const Vector2DT& otro) {
+        x -= otro.x;
+        y -= otro.y;
+        return *this;
+    }
+    constexpr Vector2DT& operator*=(T factor) {
+        escalar(factor);
+        return *this;
+    }
+    constexpr Vector2DT& operator/=(T divisor) {
+        x /= divisor;
+        y /= divisor;
+        return *this;
+    }
+
+    constexpr bool operator==(const Vector2DT& otro) const { return x == otro.x && y == otro.y; }
+    constexpr bool operator!=(const Vector2DT& otro) const { return !(*this == otro); }
+
     // Representación como string
-    std::string toString() const;
+    std::string toString() const {
+        std::ostringstream oss;
+        oss << "(" << x << "," << y << ")";
+        return oss.str();
+    }
 };
 
-#endif // VECTOR2D_H
+// Escalar por la izquierda (el tipo sale del vector: 2.0f * v vale
+// también con componentes en coma fija)
+template <class T>
+constexpr Vector2DT<T> operator*(typename Vector2DT<T>::Componente factor, const Vector2DT<T>& v) {
+    return v * factor;
+}
+
+// Escalar de la simulación: float, o coma fija Q16.16 compilando con
+// -DSIMULACION_FIJA (resultados idénticos en cualquier máquina)
+#ifdef SIMULACION_FIJA
+using Escalar = Fijo;
+#else
+using Escalar = float;
+#endif
 
+// Vector de las partículas
+using Vector2D = Vector2DT<Escalar>;
+
+static_assert(std::is_trivially_copyable<Vector2D>::value, "Vector2D debe ser trivialmente copiable");
+
+#endif // VECTOR2D_H
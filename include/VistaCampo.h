@@ -0,0 +1,67 @@
+#ifndef VISTA_CAMPO_H
+#define VISTA_CAMPO_H
+
+#include <cstddef>
+
+/**
+ * Vista de sólo lectura de un campo de todos los elementos de un array,
+ * sin copiarlo (como un span con paso). Por ejemplo, las posiciones de un
+ * ConjuntoParticulas son el campo pos de cada Particula: están separadas
+ * sizeof(Particula) bytes entre sí.
+ *
+ * La vista deja de valer en cuanto el array cambia de tamaño (agregar,
+ * borrar, reservar...), igual que una referencia de obtener().
+ */
+template <class T>
+class VistaCampo {
+private:
+    const unsigned char* base;  // Primer elemento
+    int n;                      // Número de elementos
+    size_t paso;                // Bytes entre elementos consecutivos
+
+public:
+    /**
+     * Iterador hacia delante, para recorrer la vista con for (x : vista)
+     */
+    class Iterador {
+    private:
+        const unsigned char* p;
+        size_t paso;
+
+    public:
+        constexpr Iterador(const unsigned char* p, size_t paso) : p(p), paso(paso) {}
+        const T& operator*() const { return *reinterpret_cast<const T*>(p); }
+        Iterador& operator++() {
+            p += paso;
+            return *this;
+        }
+        constexpr bool operator!=(const Iterador& otro) const { return p != otro.p; }
+        constexpr bool operator==(const Iterador& otro) const { return p == otro.p; }
+    };
+
+    /**
+     * Constructor
+     * @param primero Campo del primer elemento (puede ser nullptr si n es 0)
+     * @param n Número de elementos
+     * @param paso Bytes entre elementos (por defecto, contiguos)
+     */
+    VistaCampo(const T* primero, int n, size_t paso = sizeof(T))
+        : base(reinterpret_cast<const unsigned char*>(primero)), n(n), paso(paso) {}
+
+    const T& operator[](int i) const {
+        return *reinterpret_cast<const T*>(base + i * paso);
+    }
+
+    int getUtiles() const { return n; }
+    size_t getPaso() const { return paso; }
+
+    /**
+     * Indica si los elementos están seguidos, sin nada entre medias
+     */
+    bool contigua() const { return paso == sizeof(T); }
+
+    Iterador begin() const { return Iterador(base, paso); }
+    Iterador end() const { return Iterador(base + n * paso, paso); }
+};
+
+#endif // VISTA_CAMPO_H
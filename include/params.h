@@ -1,37 +1,60 @@
 #ifndef PARAMS_H
 #define PARAMS_H
 
+#include <random>
+
 // Dimensiones del mundo
-const int MAX_X = 600;
-const int MAX_Y = 600;
+constexpr int MAX_X = 600;
+constexpr int MAX_Y = 600;
 
 // Límites de velocidad y aceleración
-const int MAX_VEL = 7;
-const float MAX_ACC = 2.0;
+constexpr int MAX_VEL = 7;
+constexpr float MAX_ACC = 2.0;
 
 // Valores para el radio
-const float RADIO = 3.0;
-const float MIN_R = 3.0;
-const float MAX_R = 7.0;
+constexpr float RADIO = 3.0;
+constexpr float MIN_R = 3.0;
+constexpr float MAX_R = 7.0;
 
 // Valor de tolerancia
-const float EPSILON = 0.01;
+constexpr float EPSILON = 0.01;
 
 // Parámetros para el rebote de partículas
-const float FACTOR_REBOTE = 1.2f;      // Factor multiplicador para la velocidad tras rebote
-const float VELOCIDAD_MIN_REBOTE = 1.5f; // Velocidad mínima tras rebote
-const float MARGEN_SEPARACION = 0.5f;  // Distancia para separar del borde tras rebote
-const float IMPULSO_ESQUINA = 1.1f;    // Impulso adicional al rebotar en esquinas
-const float REDUC_ACEL = 0.7f;         // Factor de reducción de aceleración tras rebote
-const float UMBRAL_ACEL = 0.05f;       // Umbral para considerar aceleración significativa
-const float FACTOR_ACEL_ALEATORIA = 0.1f; // Factor para nueva aceleración aleatoria
+constexpr float FACTOR_REBOTE = 1.2f;      // Factor multiplicador para la velocidad tras rebote
+constexpr float VELOCIDAD_MIN_REBOTE = 1.5f; // Velocidad mínima tras rebote
+constexpr float MARGEN_SEPARACION = 0.5f;  // Distancia para separar del borde tras rebote
+constexpr float IMPULSO_ESQUINA = 1.1f;    // Impulso adicional al rebotar en esquinas
+constexpr float REDUC_ACEL = 0.7f;         // Factor de reducción de aceleración tras rebote
+constexpr float UMBRAL_ACEL = 0.05f;       // Umbral para considerar aceleración significativa
+constexpr float FACTOR_ACEL_ALEATORIA = 0.1f; // Factor para nueva aceleración aleatoria
+
+// Vida de las partículas (en pasos de simulación)
+constexpr int VIDA_INFINITA = -1;          // Valor de vida de las partículas que no caducan
+
+// Generador de números aleatorios del hilo actual. Cada hilo tiene el suyo,
+// de modo que varias simulaciones en paralelo no se pisan el estado y cada
+// una es reproducible a partir de su semilla
+inline std::minstd_rand& generadorAleatorio() {
+    thread_local std::minstd_rand generador(1);
+    return generador;
+}
 
+// Fija la semilla del generador del hilo actual
+inline void sembrarAleatorio(unsigned semilla) {
+    generadorAleatorio().seed(semilla);
+}
 
 // Función para generar números aleatorios en un rango min y max
 inline float aleatorio(float min, float max) {
-    float r = rand() / static_cast<float>(RAND_MAX);
+    std::minstd_rand& g = generadorAleatorio();
+    float r = (g() - g.min()) / static_cast<float>(g.max() - g.min());
     float rango = max - min;
     return (r * rango + min);
 }
 
+// Entero aleatorio en [min, max]
+inline int aleatorioEntero(int min, int max) {
+    return min + (int)(generadorAleatorio()() % (unsigned)(max - min + 1));
+}
+
 #endif // PARAMS_H
\ No newline at end of file
@@ -0,0 +1,70 @@
+#include "BuzonParticulas.h"
+#include "Perfilador.h"
+
+BuzonParticulas::BuzonParticulas(int capacidad)
+    : altas(capacidad > 0 ? capacidad : 1), bajas(capacidad > 0 ? capacidad : 1), rechazadas(0),
+      totalAltas(0), totalBajas(0) {
+    // Particula no se construye: el buffer se reserva sin inicializar
+    bufferAltas = static_cast<Particula*>(::operator new(sizeof(Particula) * altas.getCapacidad()));
+    bufferBajas = new Manejador[bajas.getCapacidad()];
+}
+
+BuzonParticulas::~BuzonParticulas() {
+    ::operator delete(bufferAltas);
+    delete[] bufferBajas;
+}
+
+bool BuzonParticulas::pedirAlta(const Particula& part) {
+    if (altas.encolar(part)) {
+        return true;
+    }
+    rechazadas.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool BuzonParticulas::pedirBaja(Manejador m) {
+    if (bajas.encolar(m)) {
+        return true;
+    }
+    rechazadas.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+/**
+ * Aplica las peticiones pendientes en bloque. Sólo se sacan tantas como
+ * caben en los buffers (la capacidad de las colas): lo que se encole
+ * mientras tanto queda para el siguiente aplicar()
+ * @param nube Conjunto de partículas
+ * @return Número de partículas agregadas más borradas
+ */
+int BuzonParticulas::aplicar(ConjuntoParticulas& nube) {
+    PERFIL_AMBITO("buzon");
+
+    int numBajas = 0;
+    while (numBajas < (int)bajas.getCapacidad() && bajas.desencolar(bufferBajas[numBajas])) {
+        numBajas++;
+    }
+    int borradas = nube.borrar(bufferBajas, numBajas);
+
+    int numAltas = 0;
+    while (numAltas < (int)altas.getCapacidad() && altas.desencolar(bufferAltas[numAltas])) {
+        numAltas++;
+    }
+    nube.agregar(bufferAltas, numAltas);
+
+    totalAltas += numAltas;
+    totalBajas += borradas;
+    return numAltas + borradas;
+}
+
+long BuzonParticulas::getRechazadas() const {
+    return rechazadas.load(std::memory_order_relaxed);
+}
+
+long BuzonParticulas::getAltas() const {
+    return totalAltas;
+}
+
+long BuzonParticulas::getBajas() const {
+    return totalBajas;
+}
@@ -0,0 +1,57 @@
+#include "Colision.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Máscara de choques de un círculo con un bloque de candidatas: hay choque
+ * si dx^2 + dy^2 < (r + rk)^2
+ * @return Bit k a 1 si el círculo choca con la candidata k
+ */
+unsigned colisionesBloque(float x, float y, float r, const float* xs, const float* ys, const float* rs, int n) {
+    unsigned mascara = 0;
+    int k = 0;
+#if defined(__AVX2__)
+    __m256 x8 = _mm256_set1_ps(x), y8 = _mm256_set1_ps(y), r8 = _mm256_set1_ps(r);
+    for (; k + 8 <= n; k += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + k), x8);
+        __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + k), y8);
+        __m256 s = _mm256_add_ps(_mm256_loadu_ps(rs + k), r8);
+        __m256 d2 = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+        __m256 choca = _mm256_cmp_ps(d2, _mm256_mul_ps(s, s), _CMP_LT_OQ);
+        mascara |= (unsigned)_mm256_movemask_ps(choca) << k;
+    }
+#endif
+#if defined(__SSE2__)
+    __m128 x4 = _mm_set1_ps(x), y4 = _mm_set1_ps(y), r4 = _mm_set1_ps(r);
+    for (; k + 4 <= n; k += 4) {
+        __m128 dx = _mm_sub_ps(_mm_loadu_ps(xs + k), x4);
+        __m128 dy = _mm_sub_ps(_mm_loadu_ps(ys + k), y4);
+        __m128 s = _mm_add_ps(_mm_loadu_ps(rs + k), r4);
+        __m128 d2 = _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy));
+        __m128 choca = _mm_cmplt_ps(d2, _mm_mul_ps(s, s));
+        mascara |= (unsigned)_mm_movemask_ps(choca) << k;
+    }
+#endif
+    for (; k < n; k++) {
+        float dx = xs[k] - x;
+        float dy = ys[k] - y;
+        float s = rs[k] + r;
+        mascara |= (unsigned)(dx * dx + dy * dy < s * s) << k;
+    }
+    return mascara;
+}
+
+/**
+ * Máscara de choques en coma fija. Cada cuadrado cabe en 62 bits y la
+ * suma de dos en 63, así que se comparan sin signo y sin desbordes
+ * @return Bit k a 1 si el círculo choca con la candidata k
+ */
+unsigned colisionesBloque(Fijo x, Fijo y, Fijo r, const Fijo* xs, const Fijo* ys, const Fijo* rs, int n) {
+    unsigned mascara = 0;
+    for (int k = 0; k < n; k++) {
+        mascara |= (unsigned)solapan(xs[k] - x, ys[k] - y, rs[k] + r) << k;
+    }
+    return mascara;
+}
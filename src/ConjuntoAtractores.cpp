@@ -0,0 +1,293 @@
+#include "ConjuntoAtractores.h"
+#include "ConjuntoParticulas.h"
+#include "Perfilador.h"
+#include <cmath>
+
+// Número máximo de celdas por eje de la rejilla de absorción
+const int MAX_CELDAS_EJE = 256;
+
+ConjuntoAtractores::ConjuntoAtractores(const ParametrosMundo& mundo)
+    : mundo(mundo), x(nullptr), y(nullptr), vx(nullptr), vy(nullptr), radio(nullptr),
+      capacidad(0), utiles(0),
+      inicioCelda(nullptr), indices(nullptr), capacidadCeldas(0), capacidadIndices(0),
+      celdasX(0), celdasY(0), tamCelda(1.0f),
+      px(nullptr), py(nullptr), ax(nullptr), ay(nullptr), capacidadAux(0) {}
+
+ConjuntoAtractores::~ConjuntoAtractores() {
+    delete[] x;
+    delete[] y;
+    delete[] vx;
+    delete[] vy;
+    delete[] radio;
+    delete[] inicioCelda;
+    delete[] indices;
+    delete[] px;
+    delete[] py;
+    delete[] ax;
+    delete[] ay;
+}
+
+/**
+ * Redimensiona los arrays de atractores conservando su contenido
+ * @param nuevaCapacidad Nueva capacidad
+ */
+void ConjuntoAtractores::redimensionar(int nuevaCapacidad) {
+    float** columnas[5] = {&x, &y, &vx, &vy, &radio};
+    for (float** col : columnas) {
+        float* nueva = new float[nuevaCapacidad];
+        for (int i = 0; i < utiles; i++) {
+            nueva[i] = (*col)[i];
+        }
+        delete[] *col;
+        *col = nueva;
+    }
+    capacidad = nuevaCapacidad;
+}
+
+/**
+ * Agrega un atractor
+ * @param pos Posición del centro
+ * @param r Radio
+ * @param veloc Velocidad
+ * @return Posición del atractor en el conjunto
+ */
+int ConjuntoAtractores::agregar(const Vector2D& pos, float r, const Vector2D& veloc) {
+    if (utiles >= capacidad) {
+        redimensionar(capacidad + TAM_BLOQUE);
+    }
+    x[utiles] = pos.getX();
+    y[utiles] = pos.getY();
+    vx[utiles] = veloc.getX();
+    vy[utiles] = veloc.getY();
+    radio[utiles] = r;
+    celdasX = celdasY = 0;  // La rejilla ya no vale
+    return utiles++;
+}
+
+/**
+ * Borra un atractor; el último pasa a ocupar su posición
+ * @param pos Posición del atractor
+ */
+void ConjuntoAtractores::borrar(int pos) {
+    if (pos >= 0 && pos < utiles) {
+        utiles--;
+        x[pos] = x[utiles];
+        y[pos] = y[utiles];
+        vx[pos] = vx[utiles];
+        vy[pos] = vy[utiles];
+        radio[pos] = radio[utiles];
+        celdasX = celdasY = 0;  // La rejilla ya no vale
+    }
+}
+
+int ConjuntoAtractores::getUtiles() const {
+    return utiles;
+}
+
+const ParametrosMundo& ConjuntoAtractores::getMundo() const {
+    return mundo;
+}
+
+Vector2D ConjuntoAtractores::getPos(int i) const {
+    return Vector2D(x[i], y[i]);
+}
+
+Vector2D ConjuntoAtractores::getVeloc(int i) const {
+    return Vector2D(vx[i], vy[i]);
+}
+
+float ConjuntoAtractores::getRadio(int i) const {
+    return radio[i];
+}
+
+/**
+ * Mueve los atractores con su velocidad, rebotando o envolviendo en los
+ * bordes con el mismo criterio que Particula
+ * @param tipo 0 = mover, 1 = mover+rebotar, 2 = mover+wrap
+ */
+void ConjuntoAtractores::mover(int tipo) {
+    const float maxX = mundo.maxX, maxY = mundo.maxY;
+    for (int i = 0; i < utiles; i++) {
+        x[i] += vx[i];
+        y[i] += vy[i];
+        float r = radio[i];
+
+        if (tipo == 1) {
+            if (x[i] - r <= 0 || x[i] + r >= maxX) {
+                vx[i] = -vx[i];
+                x[i] = (x[i] - r < 0) ? r : (x[i] + r > maxX ? maxX - r : x[i]);
+            }
+            if (y[i] - r <= 0 || y[i] + r >= maxY) {
+                vy[i] = -vy[i];
+                y[i] = (y[i] - r < 0) ? r : (y[i] + r > maxY ? maxY - r : y[i]);
+            }
+        } else if (tipo == 2) {
+            if (x[i] + r < 0) x[i] = maxX - r;
+            else if (x[i] - r > maxX) x[i] = r;
+            if (y[i] + r < 0) y[i] = maxY - r;
+            else if (y[i] - r > maxY) y[i] = r;
+        }
+    }
+}
+
+/**
+ * Aplica a la nube la atracción de todos los atractores en una pasada.
+ * El bucle interno recorre la nube en arrays contiguos, sin saltos ni
+ * llamadas, con un único atractor fijo: es el que se vectoriza
+ * @param nube Partículas atraídas
+ * @param G Constante de gravitación
+ * @param suavizado Distancia de suavizado
+ * @param acumular true para sumar a la aceleración actual
+ */
+void ConjuntoAtractores::aplicarCampo(ConjuntoParticulas& nube, float G, float suavizado, bool acumular) {
+    PERFIL_AMBITO("campoAtractores");
+
+    int n = nube.getUtiles();
+    if (n > capacidadAux) {
+        delete[] px;
+        delete[] py;
+        delete[] ax;
+        delete[] ay;
+        capacidadAux = n;
+        px = new float[n];
+        py = new float[n];
+        ax = new float[n];
+        ay = new float[n];
+    }
+
+    for (int i = 0; i < n; i++) {
+        const Particula& p = nube.obtener(i);
+        px[i] = p.getPos().getX();
+        py[i] = p.getPos().getY();
+        ax[i] = acumular ? (float)p.getAcel().getX() : 0.0f;
+        ay[i] = acumular ? (float)p.getAcel().getY() : 0.0f;
+    }
+
+    float e2 = suavizado * suavizado;
+    for (int a = 0; a < utiles; a++) {
+        float xa = x[a], ya = y[a];
+        float gm = G * radio[a] * radio[a];
+        for (int i = 0; i < n; i++) {
+            float dx = xa - px[i];
+            float dy = ya - py[i];
+            float d2 = dx * dx + dy * dy + e2;
+            float inv = gm / (d2 * std::sqrt(d2));
+            ax[i] += dx * inv;
+            ay[i] += dy * inv;
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        float mod2 = ax[i] * ax[i] + ay[i] * ay[i];
+        if (mod2 > MAX_ACC * MAX_ACC) {
+            float f = MAX_ACC / std::sqrt(mod2);
+            ax[i] *= f;
+            ay[i] *= f;
+        }
+        nube.obtener(i).setAcel(Vector2D(ax[i], ay[i]));
+    }
+}
+
+/**
+ * Celda de la rejilla que contiene una coordenada. Las coordenadas fuera
+ * del mundo se recortan a la celda del borde: como el recorte es monótono,
+ * dos intervalos que se solapan siguen compartiendo alguna celda
+ */
+int ConjuntoAtractores::celda(float v, int numCeldas) const {
+    int c = (int)std::floor(v / tamCelda);
+    if (c < 0) return 0;
+    if (c >= numCeldas) return numCeldas - 1;
+    return c;
+}
+
+/**
+ * Construye la rejilla de absorción: cada atractor se apunta en todas las
+ * celdas que toca su círculo ampliado con el margen
+ * @param margen Radio máximo de las partículas que se van a consultar
+ */
+void ConjuntoAtractores::indexar(float margen) {
+    float maxRadio = 0;
+    for (int a = 0; a < utiles; a++) {
+        if (radio[a] > maxRadio) maxRadio = radio[a];
+    }
+
+    // Celdas del tamaño del mayor alcance: cada atractor ocupa a lo sumo 3x3
+    tamCelda = maxRadio + margen;
+    float minimo = (mundo.maxX > mundo.maxY ? mundo.maxX : mundo.maxY) / (float)MAX_CELDAS_EJE;
+    if (tamCelda < minimo) tamCelda = minimo;
+    celdasX = (int)std::ceil(mundo.maxX / tamCelda);
+    celdasY = (int)std::ceil(mundo.maxY / tamCelda);
+    int numCeldas = celdasX * celdasY;
+
+    if (numCeldas + 1 > capacidadCeldas) {
+        delete[] inicioCelda;
+        capacidadCeldas = numCeldas + 1;
+        inicioCelda = new int[capacidadCeldas];
+    }
+    for (int c = 0; c <= numCeldas; c++) {
+        inicioCelda[c] = 0;
+    }
+
+    // Primera pasada: cuántos atractores caen en cada celda
+    for (int a = 0; a < utiles; a++) {
+        float alcance = radio[a] + margen;
+        int cx0 = celda(x[a] - alcance, celdasX), cx1 = celda(x[a] + alcance, celdasX);
+        int cy0 = celda(y[a] - alcance, celdasY), cy1 = celda(y[a] + alcance, celdasY);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                inicioCelda[cy * celdasX + cx + 1]++;
+            }
+        }
+    }
+    for (int c = 0; c < numCeldas; c++) {
+        inicioCelda[c + 1] += inicioCelda[c];
+    }
+
+    int total = inicioCelda[numCeldas];
+    if (total > capacidadIndices) {
+        delete[] indices;
+        capacidadIndices = total;
+        indices = new int[capacidadIndices];
+    }
+
+    // Segunda pasada: rellenar, usando inicioCelda como cursor y
+    // restaurándolo después
+    for (int a = 0; a < utiles; a++) {
+        float alcance = radio[a] + margen;
+        int cx0 = celda(x[a] - alcance, celdasX), cx1 = celda(x[a] + alcance, celdasX);
+        int cy0 = celda(y[a] - alcance, celdasY), cy1 = celda(y[a] + alcance, celdasY);
+        for (int cy = cy0; cy <= cy1; cy++) {
+            for (int cx = cx0; cx <= cx1; cx++) {
+                indices[inicioCelda[cy * celdasX + cx]++] = a;
+            }
+        }
+    }
+    for (int c = numCeldas; c > 0; c--) {
+        inicioCelda[c] = inicioCelda[c - 1];
+    }
+    inicioCelda[0] = 0;
+}
+
+/**
+ * Indica si algún atractor toca a la partícula
+ * @param p Partícula a comprobar
+ * @return true si la partícula debe ser absorbida
+ */
+bool ConjuntoAtractores::absorbe(const Particula& p) const {
+    if (utiles == 0 || celdasX == 0) return false;
+
+    float xp = p.getPos().getX();
+    float yp = p.getPos().getY();
+    int c = celda(yp, celdasY) * celdasX + celda(xp, celdasX);
+
+    for (int k = inicioCelda[c]; k < inicioCelda[c + 1]; k++) {
+        int a = indices[k];
+        float dx = x[a] - xp;
+        float dy = y[a] - yp;
+        float suma = radio[a] + p.getRadio();
+        if (dx * dx + dy * dy < suma * suma) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,5 +1,66 @@
 #include "ConjuntoParticulas.h"
+#include "ConjuntoAtractores.h"
+#include "Perfilador.h"
+#include "Memoria.h"
+#include "Colision.h"
+#include "LotesColisiones.h"
+#include "HashEspacial.h"
+#include "RejillaOrdenada.h"
+#include "ObstaculosEstaticos.h"
+#include <algorithm>
+#include "PoolTrabajo.h"
 #include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+// Pares por debajo de los cuales un lote se resuelve sin el pool
+const int UMBRAL_LOTE_PARALELO = 1024;
+
+// El array se reserva sin construir: las posiciones libres no se tocan y
+// las partículas se destruyen sin llamar a nada
+static_assert(std::is_trivially_destructible<Particula>::value,
+              "ConjuntoParticulas necesita partículas trivialmente destruibles");
+
+/**
+ * Reserva un array de partículas sin construirlas (sin llamar a rand()
+ * en cada posición, como haría new Particula[tam]). Los arrays grandes van
+ * en páginas enormes que nadie ha tocado todavía
+ */
+static Particula* reservarArray(int tam) {
+    return static_cast<Particula*>(reservarPaginas(sizeof(Particula) * tam));
+}
+
+/**
+ * Libera un array de reservarArray()
+ */
+static void liberarArray(Particula* set, int tam) {
+    liberarPaginas(set, sizeof(Particula) * tam);
+}
+
+// Contadores de instrumentación
+
+EstadisticasConjunto::EstadisticasConjunto()
+    : paresCandidatos(0), colisiones(0), choques(0), absorbidas(0), caducadas(0),
+      redimensiones(0), bytesReservados(0), cambiosCelda(0), rebotesObstaculo(0) {}
+
+/**
+ * Suma los contadores de otro registro a este
+ * @param otras Contadores a sumar
+ */
+void EstadisticasConjunto::sumar(const EstadisticasConjunto& otras) {
+    paresCandidatos += otras.paresCandidatos;
+    colisiones += otras.colisiones;
+    choques += otras.choques;
+    absorbidas += otras.absorbidas;
+    caducadas += otras.caducadas;
+    redimensiones += otras.redimensiones;
+    bytesReservados += otras.bytesReservados;
+    cambiosCelda += otras.cambiosCelda;
+    rebotesObstaculo += otras.rebotesObstaculo;
+}
 
 // Métodos privados para manejo de memoria
 
@@ -11,9 +72,10 @@ void ConjuntoParticulas::reservarMemoria(int tam) {
     // Solo reservamos si el tamaño es positivo
     if (tam > 0) {
         // Reservar un array de partículas del tamaño indicado
-        set = new Particula[tam];
+        set = reservarArray(tam);
         // Actualizar la capacidad
         capacidad = tam;
+        actual.bytesReservados += (long)tam * sizeof(Particula);
     } else {
         // Si el tamaño es 0 o negativo, inicializamos a valores por defecto
         set = nullptr;
@@ -29,7 +91,7 @@ void ConjuntoParticulas::reservarMemoria(int tam) {
 void ConjuntoParticulas::liberarMemoria() {
     // Solo liberamos memoria si hay algo que liberar
     if (set != nullptr) {
-        delete[] set;
+        liberarArray(set, capacidad);
         set = nullptr;
     }
     // Reiniciamos los contadores
@@ -51,16 +113,18 @@ void ConjuntoParticulas::redimensionar(int nuevaCapacidad) {
         }
         
         // Creamos un array temporal con la nueva capacidad
-        Particula* temp = new Particula[nuevaCapacidad];
+        Particula* temp = reservarArray(nuevaCapacidad);
+        actual.redimensiones++;
+        actual.bytesReservados += (long)nuevaCapacidad * sizeof(Particula);
         
         // Copiamos las partículas útiles (como máximo la nueva capacidad)
         int elementosACopiar = (nuevaCapacidad < utiles) ? nuevaCapacidad : utiles;
         for (int i = 0; i < elementosACopiar; i++) {
-            temp[i] = set[i];
+            new (&temp[i]) Particula(set[i]);
         }
         
         // Liberamos la memoria del array antiguo
-        delete[] set;
+        liberarArray(set, capacidad);
         
         // Actualizamos el array y la capacidad
         set = temp;
@@ -73,27 +137,124 @@ void ConjuntoParticulas::redimensionar(int nuevaCapacidad) {
     }
 }
 
+/**
+ * Encoge el array si sobra más de un bloque, sin bajar de capacidadMinima
+ */
+void ConjuntoParticulas::ajustarCapacidad() {
+    int objetivo = (utiles > capacidadMinima) ? utiles : capacidadMinima;
+    if ((capacidad - objetivo) > TAM_BLOQUE) {
+        redimensionar(objetivo);
+    }
+}
+
+/**
+ * Asegura que los arrays de huecos tienen sitio para tam huecos. Crecen al
+ * doble para que agregar partículas una a una no reserve en cada llamada
+ * @param tam Número de huecos necesario
+ */
+void ConjuntoParticulas::reservarHuecos(int tam) {
+    if (tam <= capacidadHuecos) {
+        return;
+    }
+
+    int nuevaCapacidad = (capacidadHuecos * 2 > tam) ? capacidadHuecos * 2 : tam;
+    int* nuevoDenso = new int[nuevaCapacidad];
+    int* nuevasPosiciones = new int[nuevaCapacidad];
+    unsigned* nuevasGeneraciones = new unsigned[nuevaCapacidad];
+    actual.bytesReservados += (long)nuevaCapacidad * (2 * sizeof(int) + sizeof(unsigned));
+
+    // Copiamos las tablas: los huecos conservan su índice y generación
+    for (int i = 0; i < utiles && i < capacidadHuecos; i++) {
+        nuevoDenso[i] = denso[i];
+    }
+    for (int h = 0; h < numHuecos; h++) {
+        nuevasPosiciones[h] = posiciones[h];
+        nuevasGeneraciones[h] = generaciones[h];
+    }
+
+    liberarHuecos();
+    denso = nuevoDenso;
+    posiciones = nuevasPosiciones;
+    generaciones = nuevasGeneraciones;
+    capacidadHuecos = nuevaCapacidad;
+}
+
+/**
+ * Libera la tabla de manejadores (no modifica numHuecos ni la lista de libres)
+ */
+void ConjuntoParticulas::liberarHuecos() {
+    delete[] denso;
+    delete[] posiciones;
+    delete[] generaciones;
+    denso = nullptr;
+    posiciones = nullptr;
+    generaciones = nullptr;
+    capacidadHuecos = 0;
+}
+
+/**
+ * Asigna un hueco a la partícula que está en la posición indicada
+ * @param pos Posición de la partícula en el array
+ */
+void ConjuntoParticulas::asignarHueco(int pos) {
+    int hueco;
+    if (primerLibre != -1) {
+        // Reutilizamos un hueco libre; su generación ya se incrementó al liberarlo
+        hueco = primerLibre;
+        primerLibre = posiciones[hueco];
+    } else {
+        reservarHuecos(numHuecos + 1);
+        hueco = numHuecos;
+        generaciones[hueco] = 0;
+        numHuecos++;
+    }
+    posiciones[hueco] = pos;
+    denso[pos] = hueco;
+}
+
 // Implementación de los métodos públicos
 
 /**
  * Constructor que crea un conjunto con n partículas aleatorias
  * @param n Número de partículas iniciales (por defecto 0)
+ * @param mundo Mundo en el que se crean y se mueven
  */
-ConjuntoParticulas::ConjuntoParticulas(int n) {
+ConjuntoParticulas::ConjuntoParticulas(int n, const ParametrosMundo& mundo)
+    : mundo(mundo), mundoFijo(mundo.esFijo()) {
     // Inicialmente no hay array
     set = nullptr;
     capacidad = 0;
     utiles = 0;
+    capacidadMinima = 0;
+    pasos = 0;
+    reordenaciones = 0;
+    denso = nullptr;
+    posiciones = nullptr;
+    generaciones = nullptr;
+    capacidadHuecos = 0;
+    numHuecos = 0;
+    primerLibre = -1;
+    columnaX = columnaY = columnaR = nullptr;
+    capacidadColumnas = 0;
+    lotes = nullptr;
+    hash = nullptr;
+    motorColisiones = TODOS_CONTRA_TODOS;
+    rejilla = nullptr;
+    vecinas = nullptr;
+    capacidadVecinas = 0;
+    bytesMotores = 0;
     
     // Si se solicitan partículas iniciales, las creamos
     if (n > 0) {
-        // Reservar memoria para n partículas
+        // Reservar memoria para n partículas y sus manejadores
         reservarMemoria(n);
+        reservarHuecos(n);
         
         // Crear n partículas aleatorias utilizando el constructor por defecto de Particula
         for (int i = 0; i < n; i++) {
             // El constructor por defecto de Particula crea una partícula aleatoria
-            set[i] = Particula();
+            new (&set[i]) Particula(mundo);
+            asignarHueco(i);
             utiles++;
         }
     }
@@ -103,11 +264,30 @@ ConjuntoParticulas::ConjuntoParticulas(int n) {
  * Constructor de copia
  * @param otro Conjunto a copiar
  */
-ConjuntoParticulas::ConjuntoParticulas(const ConjuntoParticulas& otro) {
+ConjuntoParticulas::ConjuntoParticulas(const ConjuntoParticulas& otro)
+    : mundo(otro.mundo), mundoFijo(otro.mundoFijo) {
     // Inicializamos el nuevo conjunto como vacío
     set = nullptr;
     capacidad = 0;
     utiles = 0;
+    capacidadMinima = 0;
+    pasos = 0;
+    reordenaciones = 0;
+    denso = nullptr;
+    posiciones = nullptr;
+    generaciones = nullptr;
+    capacidadHuecos = 0;
+    numHuecos = 0;
+    primerLibre = -1;
+    columnaX = columnaY = columnaR = nullptr;
+    capacidadColumnas = 0;
+    lotes = nullptr;
+    hash = nullptr;
+    motorColisiones = otro.motorColisiones;
+    rejilla = nullptr;
+    vecinas = nullptr;
+    capacidadVecinas = 0;
+    bytesMotores = 0;
     
     // Copiamos el conjunto si tiene elementos
     if (otro.utiles > 0) {
@@ -116,11 +296,25 @@ ConjuntoParticulas::ConjuntoParticulas(const ConjuntoParticulas& otro) {
         
         // Copiamos cada partícula útil
         for (int i = 0; i < otro.utiles; i++) {
-            set[i] = otro.set[i];
+            new (&set[i]) Particula(otro.set[i]);
         }
         
         // Actualizamos el contador de útiles
         utiles = otro.utiles;
+        capacidadMinima = otro.capacidadMinima;
+
+        // Copiamos la tabla de manejadores tal cual, de modo que los
+        // manejadores del original sirven también para la copia
+        reservarHuecos(otro.capacidadHuecos);
+        for (int i = 0; i < utiles; i++) {
+            denso[i] = otro.denso[i];
+        }
+        for (int h = 0; h < otro.numHuecos; h++) {
+            posiciones[h] = otro.posiciones[h];
+            generaciones[h] = otro.generaciones[h];
+        }
+        numHuecos = otro.numHuecos;
+        primerLibre = otro.primerLibre;
     }
 }
 
@@ -129,6 +323,36 @@ ConjuntoParticulas::ConjuntoParticulas(const ConjuntoParticulas& otro) {
  */
 ConjuntoParticulas::~ConjuntoParticulas() {
     liberarMemoria();
+    liberarHuecos();
+    delete[] columnaX;
+    delete[] columnaY;
+    delete[] columnaR;
+    delete lotes;
+    delete hash;
+    delete rejilla;
+    delete[] vecinas;
+}
+
+/**
+ * Copia posiciones y radios de las partículas útiles a las columnas, que
+ * sólo crecen
+ */
+void ConjuntoParticulas::copiarColumnas() {
+    if (utiles > capacidadColumnas) {
+        delete[] columnaX;
+        delete[] columnaY;
+        delete[] columnaR;
+        capacidadColumnas = utiles;
+        columnaX = new Escalar[capacidadColumnas];
+        columnaY = new Escalar[capacidadColumnas];
+        columnaR = new Escalar[capacidadColumnas];
+        actual.bytesReservados += (long)capacidadColumnas * 3 * sizeof(Escalar);
+    }
+    for (int i = 0; i < utiles; i++) {
+        columnaX[i] = set[i].getPos().getX();
+        columnaY[i] = set[i].getPos().getY();
+        columnaR[i] = set[i].getRadio();
+    }
 }
 
 /**
@@ -147,11 +371,90 @@ int ConjuntoParticulas::getCapacidad() const {
     return capacidad;
 }
 
+/**
+ * Reserva capacidad para n partículas y la fija como mínima
+ * @param n Número de partículas
+ */
+void ConjuntoParticulas::reservar(int n) {
+    if (n < 0) {
+        return;
+    }
+    capacidadMinima = n;
+    if (n > capacidad) {
+        redimensionar(n);
+    }
+    reservarHuecos(n);
+}
+
+/**
+ * Reserva capacidad para n partículas con el array nuevo escrito por
+ * primera vez por los hilos del pool, cada uno su tramo
+ * @param n Número de partículas
+ * @param pool Hilos que van a procesar el conjunto
+ */
+void ConjuntoParticulas::reservar(int n, PoolTrabajo& pool) {
+    if (n < 0) {
+        return;
+    }
+    capacidadMinima = n;
+    if (n > capacidad) {
+        Particula* temp = reservarArray(n);
+        actual.redimensiones++;
+        actual.bytesReservados += (long)n * sizeof(Particula);
+
+        Particula* viejo = set;
+        int viejos = utiles;
+        int capacidadVieja = capacidad;
+        capacidad = n;
+        pool.enCadaHilo([&](int h) {
+            int desde, hasta;
+            tramo(h, pool.getNumHilos(), desde, hasta);
+            // Se escribe el tramo entero, también las posiciones libres
+            std::memset(static_cast<void*>(temp + desde), 0, sizeof(Particula) * (hasta - desde));
+            for (int i = desde; i < hasta && i < viejos; i++) {
+                new (&temp[i]) Particula(viejo[i]);
+            }
+        });
+        liberarArray(viejo, capacidadVieja);
+        set = temp;
+    }
+    reservarHuecos(n);
+}
+
+int ConjuntoParticulas::getCapacidadMinima() const {
+    return capacidadMinima;
+}
+
+const ParametrosMundo& ConjuntoParticulas::getMundo() const {
+    return mundo;
+}
+
+/**
+ * Vistas de las partículas útiles: cada campo se lee directamente del
+ * array, saltando sizeof(Particula) bytes de una partícula a la siguiente
+ */
+VistaCampo<Particula> ConjuntoParticulas::vistaParticulas() const {
+    return VistaCampo<Particula>(set, utiles);
+}
+
+VistaCampo<Vector2D> ConjuntoParticulas::vistaPosiciones() const {
+    return VistaCampo<Vector2D>((utiles > 0) ? &set[0].getPos() : nullptr, utiles, sizeof(Particula));
+}
+
+VistaCampo<Vector2D> ConjuntoParticulas::vistaVelocidades() const {
+    return VistaCampo<Vector2D>((utiles > 0) ? &set[0].getVeloc() : nullptr, utiles, sizeof(Particula));
+}
+
+VistaCampo<Vector2D> ConjuntoParticulas::vistaAceleraciones() const {
+    return VistaCampo<Vector2D>((utiles > 0) ? &set[0].getAcel() : nullptr, utiles, sizeof(Particula));
+}
+
 /**
  * Agrega una partícula al conjunto
  * @param part Partícula a agregar
+ * @return Manejador estable de la partícula agregada
  */
-void ConjuntoParticulas::agregar(const Particula& part) {
+Manejador ConjuntoParticulas::agregar(const Particula& part) {
     // Si no hay espacio, aumentamos la capacidad
     if (utiles >= capacidad) {
         // Aumentamos en TAM_BLOQUE unidades
@@ -159,8 +462,65 @@ void ConjuntoParticulas::agregar(const Particula& part) {
     }
     
     // Agregamos la partícula al final del array y aumentamos útiles
-    set[utiles] = part;
+    new (&set[utiles]) Particula(part);
+    asignarHueco(utiles);
+    if (hash != nullptr) {
+        hash->insertar(part.getPos());
+    }
     utiles++;
+
+    return manejador(utiles - 1);
+}
+
+/**
+ * Agrega un bloque de partículas, redimensionando como mucho una vez
+ * @param partes Partículas a agregar
+ * @param n Número de partículas
+ */
+void ConjuntoParticulas::agregar(const Particula* partes, int n) {
+    if (n <= 0) {
+        return;
+    }
+    if (utiles + n > capacidad) {
+        redimensionar(utiles + n);
+    }
+    reservarHuecos(utiles + n);
+    for (int k = 0; k < n; k++) {
+        new (&set[utiles]) Particula(partes[k]);
+        asignarHueco(utiles);
+        if (hash != nullptr) {
+            hash->insertar(partes[k].getPos());
+        }
+        utiles++;
+    }
+}
+
+/**
+ * Quita la partícula de una posición sin ajustar la capacidad
+ * @param pos Posición de la partícula (válida)
+ */
+void ConjuntoParticulas::quitar(int pos) {
+    // El hueco de la partícula borrada pasa a la lista de libres con una
+    // generación nueva, lo que invalida sus manejadores
+    int hueco = denso[pos];
+    generaciones[hueco]++;
+    posiciones[hueco] = primerLibre;
+    primerLibre = hueco;
+
+    // Reemplazamos la partícula a borrar con la última útil, que se
+    // lleva su hueco consigo (y su sitio en el hash)
+    if (hash != nullptr) {
+        hash->quitar(pos);
+    }
+    set[pos] = set[utiles - 1];
+    denso[pos] = denso[utiles - 1];
+    if (pos != utiles - 1) {
+        posiciones[denso[pos]] = pos;
+    }
+    
+    // Reducimos el contador de útiles
+    utiles--;
+    reordenaciones++;
 }
 
 /**
@@ -170,18 +530,83 @@ void ConjuntoParticulas::agregar(const Particula& part) {
 void ConjuntoParticulas::borrar(int pos) {
     // Verificar que la posición sea válida
     if (pos >= 0 && pos < utiles) {
-        // Reemplazamos la partícula a borrar con la última útil
-        set[pos] = set[utiles - 1];
-        
-        // Reducimos el contador de útiles
-        utiles--;
-        
+        quitar(pos);
+
         // Verificamos si hay espacio extra que podemos liberar
-        if ((capacidad - utiles) > TAM_BLOQUE) {
-            // Redimensionamos para que la capacidad coincida con el número de partículas
-            redimensionar(utiles);
+        ajustarCapacidad();
+    }
+}
+
+/**
+ * Borra la partícula de un manejador (no hace nada si ya no es válido)
+ * @param m Manejador de la partícula
+ */
+void ConjuntoParticulas::borrar(Manejador m) {
+    borrar(posicion(m));
+}
+
+/**
+ * Borra las partículas de varios manejadores y ajusta la capacidad una
+ * sola vez. Un manejador repetido deja de ser válido tras el primer borrado
+ * @param m Manejadores
+ * @param n Número de manejadores
+ * @return Partículas borradas
+ */
+int ConjuntoParticulas::borrar(const Manejador* m, int n) {
+    int borradas = 0;
+    for (int k = 0; k < n; k++) {
+        if (valido(m[k])) {
+            quitar(posicion(m[k]));
+            borradas++;
         }
     }
+    if (borradas > 0) {
+        ajustarCapacidad();
+    }
+    return borradas;
+}
+
+/**
+ * Indica si el manejador corresponde a una partícula que sigue en el conjunto
+ * @param m Manejador a comprobar
+ * @return true si es válido
+ */
+bool ConjuntoParticulas::valido(Manejador m) const {
+    return m.indice >= 0 && m.indice < numHuecos && generaciones[m.indice] == m.generacion;
+}
+
+/**
+ * Obtiene el manejador de la partícula en una posición
+ * @param pos Posición de la partícula
+ * @return Manejador estable de la partícula
+ */
+Manejador ConjuntoParticulas::manejador(int pos) const {
+    Manejador m;
+    m.indice = denso[pos];
+    m.generacion = generaciones[m.indice];
+    return m;
+}
+
+/**
+ * Posición actual de la partícula de un manejador
+ * @param m Manejador de la partícula
+ * @return Posición en el conjunto, o -1 si el manejador no es válido
+ */
+int ConjuntoParticulas::posicion(Manejador m) const {
+    return valido(m) ? posiciones[m.indice] : -1;
+}
+
+/**
+ * Obtiene una referencia a la partícula de un manejador válido
+ * @param m Manejador de la partícula
+ * @return Referencia a la partícula
+ */
+Particula& ConjuntoParticulas::obtener(Manejador m) {
+    return set[posiciones[m.indice]];
+}
+
+const Particula& ConjuntoParticulas::obtener(Manejador m) const {
+    return set[posiciones[m.indice]];
 }
 
 /**
@@ -207,29 +632,130 @@ void ConjuntoParticulas::reemplazar(int pos, const Particula& part) {
     if (pos >= 0 && pos < utiles) {
         // Reemplazamos la partícula en la posición indicada
         set[pos] = part;
+        if (hash != nullptr) {
+            hash->reubicar(pos, part.getPos());
+        }
     }
 }
 
 /**
- * Mueve todas las partículas del conjunto según el tipo indicado
+ * Mueve todas las partículas del conjunto según el tipo indicado. Con el
+ * mundo de params.h el bucle se instancia con MundoFijo, cuyos límites son
+ * constantes de compilación
  * @param tipo Tipo de movimiento: 0 = mover, 1 = mover+rebotar, 2 = mover+wrap
  */
 void ConjuntoParticulas::mover(int tipo) {
-    // Iterar por todas las partículas útiles
-    for (int i = 0; i < utiles; i++) {
+    PERFIL_AMBITO("mover");
+
+    if (mundoFijo) {
+        moverEn(MundoFijo(), tipo, 0, utiles);
+    } else {
+        moverEn(mundo, tipo, 0, utiles);
+    }
+    if (hash != nullptr) {
+        actualizarHash();
+    }
+}
+
+/**
+ * Tramo del array de un hilo: el reparto es sobre la capacidad para que no
+ * cambie al agregar o borrar partículas
+ * @param hilo Número del hilo
+ * @param numHilos Hilos del pool
+ * @param desde Salida: primera posición
+ * @param hasta Salida: posición siguiente a la última
+ */
+void ConjuntoParticulas::tramo(int hilo, int numHilos, int& desde, int& hasta) const {
+    desde = (int)((long)capacidad * hilo / numHilos);
+    hasta = (int)((long)capacidad * (hilo + 1) / numHilos);
+}
+
+/**
+ * Mueve las partículas repartidas entre los hilos del pool, cada uno en su
+ * tramo. Cada partícula sólo la toca un hilo, así que no hay carreras
+ * @param pool Hilos
+ * @param tipo Tipo de movimiento: 0 = mover, 1 = mover+rebotar, 2 = mover+wrap
+ */
+void ConjuntoParticulas::moverParalelo(PoolTrabajo& pool, int tipo) {
+    PERFIL_AMBITO("mover");
+
+    pool.enCadaHilo([&](int h) {
+        int desde, hasta;
+        tramo(h, pool.getNumHilos(), desde, hasta);
+        if (hasta > utiles) hasta = utiles;
+        if (mundoFijo) {
+            moverEn(MundoFijo(), tipo, desde, hasta);
+        } else {
+            moverEn(mundo, tipo, desde, hasta);
+        }
+    });
+    if (hash != nullptr) {
+        actualizarHash();
+    }
+}
+
+/**
+ * Activa el hash espacial con todas las partículas actuales
+ * @param tamCelda Lado de las celdas
+ */
+void ConjuntoParticulas::activarHash(float tamCelda) {
+    desactivarHash();
+    hash = new HashEspacial(tamCelda);
+    hash->reconstruir(set, utiles);
+}
+
+void ConjuntoParticulas::desactivarHash() {
+    if (hash != nullptr) {
+        // Lo que reservó se cuenta antes de perderlo
+        contarBytesMotores();
+        bytesMotores -= hash->getBytesReservados();
+        delete hash;
+        hash = nullptr;
+    }
+}
+
+const HashEspacial* ConjuntoParticulas::getHash() const {
+    return hash;
+}
+
+/**
+ * Reubica en el hash las partículas que han cambiado de celda
+ * @return Partículas que han cambiado de celda
+ */
+int ConjuntoParticulas::actualizarHash() {
+    if (hash == nullptr) {
+        return 0;
+    }
+    PERFIL_AMBITO("hash");
+    int cambios = hash->actualizar(set);
+    actual.cambiosCelda += cambios;
+    return cambios;
+}
+
+/**
+ * Mueve las partículas de un tramo en un mundo
+ * @param m Mundo (ParametrosMundo o MundoFijo)
+ * @param tipo Tipo de movimiento: 0 = mover, 1 = mover+rebotar, 2 = mover+wrap
+ * @param desde Primera partícula
+ * @param hasta Posición siguiente a la última partícula
+ */
+template <class Mundo>
+void ConjuntoParticulas::moverEn(const Mundo& m, int tipo, int desde, int hasta) {
+    // Iterar por las partículas del tramo
+    for (int i = desde; i < hasta; i++) {
         // Siempre aplicamos el método mover
-        set[i].mover();
+        set[i].mover(m);
         
         // Según el tipo, aplicamos comportamientos adicionales
         switch (tipo) {
             case 1:
                 // Mover con rebote
-                set[i].rebotar();
+                set[i].rebotar(m);
                 break;
                 
             case 2:
                 // Mover con wrap
-                set[i].wrap();
+                set[i].wrap(m);
                 break;
                 
             default:
@@ -239,20 +765,386 @@ void ConjuntoParticulas::mover(int tipo) {
     }
 }
 
+void ConjuntoParticulas::setMotorColisiones(MotorColisiones motor) {
+    motorColisiones = motor;
+}
+
+ConjuntoParticulas::MotorColisiones ConjuntoParticulas::getMotorColisiones() const {
+    return motorColisiones;
+}
+
 /**
- * Gestiona las colisiones entre partículas
+ * Gestiona las colisiones entre partículas. Los pares se resuelven siempre
+ * en el mismo orden (i creciente y, para cada i, j creciente), sea cual sea
+ * el motor que los busca
  */
 void ConjuntoParticulas::gestionarColisiones() {
-    // Verificar cada par de partículas
+    PERFIL_AMBITO("gestionarColisiones");
+
+    long colisiones = 0;
+    long candidatos = 0;
+
+    // El choque sólo intercambia velocidades y aceleraciones, así que las
+    // columnas de posiciones siguen valiendo durante todo el recorrido
+    copiarColumnas();
+    switch (motorColisiones) {
+        case REJILLA_ORDENADA:
+            if (rejilla == nullptr) {
+                rejilla = new RejillaOrdenada();
+            }
+            colisiones = rejilla->buscarPares(columnaX, columnaY, columnaR, utiles);
+            for (int k = 0; k < colisiones; k++) {
+                set[rejilla->getI(k)].choque(set[rejilla->getJ(k)]);
+            }
+            candidatos = rejilla->getCandidatos();
+            break;
+
+        case HASH_ESPACIAL:
+            colisiones = colisionesHash(candidatos);
+            break;
+
+        default:
+            // Cada partícula contra las siguientes, por bloques
+            for (int i = 0; i < utiles - 1; i++) {
+                Escalar xi = columnaX[i], yi = columnaY[i], ri = columnaR[i];
+                for (int j0 = i + 1; j0 < utiles; j0 += TAM_BLOQUE_COLISION) {
+                    int n = (utiles - j0 < TAM_BLOQUE_COLISION) ? utiles - j0 : TAM_BLOQUE_COLISION;
+                    unsigned mascara = colisionesBloque(xi, yi, ri, columnaX + j0, columnaY + j0, columnaR + j0, n);
+                    // Los pares se resuelven en el mismo orden que uno a uno
+                    while (mascara != 0) {
+                        int j = j0 + __builtin_ctz(mascara);
+                        mascara &= mascara - 1;
+                        set[i].choque(set[j]);
+                        colisiones++;
+                    }
+                }
+            }
+            // Todos contra todos: n*(n-1)/2 pares candidatos
+            if (utiles > 1) {
+                candidatos = (long)utiles * (utiles - 1) / 2;
+            }
+            break;
+    }
+
+    actual.paresCandidatos += candidatos;
+    actual.colisiones += colisiones;
+    actual.choques += colisiones;
+}
+
+/**
+ * Resuelve las colisiones con el hash espacial: para cada i, las
+ * candidatas j > i del cuadrado de semilado ri + radio máximo, ordenadas
+ * para resolverlas con j creciente. Usa las columnas ya copiadas
+ * @param candidatos Salida: pares comprobados
+ * @return Colisiones resueltas
+ */
+long ConjuntoParticulas::colisionesHash(long& candidatos) {
+    Escalar maxR = 0;
+    for (int i = 0; i < utiles; i++) {
+        if (columnaR[i] > maxR) maxR = columnaR[i];
+    }
+    if (hash == nullptr) {
+        activarHash(maxR > 0 ? 2.0f * maxR : 1.0f);
+    }
+    if (utiles > capacidadVecinas) {
+        delete[] vecinas;
+        capacidadVecinas = utiles;
+        vecinas = new int[capacidadVecinas];
+        actual.bytesReservados += (long)capacidadVecinas * sizeof(int);
+    }
+
+    long colisiones = 0;
+    candidatos = 0;
     for (int i = 0; i < utiles - 1; i++) {
-        for (int j = i + 1; j < utiles; j++) {
-            // Verificar si hay colisión entre las partículas i y j
-            if (set[i].colision(set[j])) {
-                // Si colisionan, aplica el choque elástico
-                set[i].choque(set[j]);
+        Escalar xi = columnaX[i], yi = columnaY[i], ri = columnaR[i];
+        int n = 0;
+        hash->paraCadaCandidata(xi, yi, ri + maxR, [&](int j) {
+            if (j <= i) {
+                return;
+            }
+            candidatos++;
+            if (solapan(columnaX[j] - xi, columnaY[j] - yi, ri + columnaR[j])) {
+                vecinas[n++] = j;
+            }
+        });
+        std::sort(vecinas, vecinas + n);
+        for (int k = 0; k < n; k++) {
+            set[i].choque(set[vecinas[k]]);
+        }
+        colisiones += n;
+    }
+    return colisiones;
+}
+
+/**
+ * Gestiona las colisiones en paralelo con el mismo resultado que
+ * gestionarColisiones(): detección en paralelo (todos contra todos o con la
+ * rejilla ordenada), reparto en lotes independientes y resolución lote a
+ * lote. Los lotes pequeños se resuelven en el hilo que llama, porque
+ * despertar al pool cuesta más que el lote
+ * @param pool Hilos
+ */
+void ConjuntoParticulas::gestionarColisiones(PoolTrabajo& pool) {
+    if (motorColisiones == HASH_ESPACIAL) {
+        gestionarColisiones();
+        return;
+    }
+
+    PERFIL_AMBITO("gestionarColisiones");
+
+    if (lotes == nullptr) {
+        lotes = new LotesColisiones();
+    }
+    copiarColumnas();
+    long candidatos = 0;
+    if (motorColisiones == REJILLA_ORDENADA) {
+        if (rejilla == nullptr) {
+            rejilla = new RejillaOrdenada();
+        }
+        int pares = rejilla->buscarPares(columnaX, columnaY, columnaR, utiles, &pool);
+        lotes->cargar(rejilla->paresI(), rejilla->paresJ(), pares);
+        candidatos = rejilla->getCandidatos();
+    } else {
+        lotes->detectar(columnaX, columnaY, columnaR, utiles, pool);
+        if (utiles > 1) {
+            candidatos = (long)utiles * (utiles - 1) / 2;
+        }
+    }
+    lotes->repartir(utiles);
+
+    int hilos = pool.getNumHilos();
+    for (int l = 0; l < lotes->getLotes(); l++) {
+        int desde = lotes->inicioLote(l), hasta = lotes->finLote(l);
+        if (hasta - desde < UMBRAL_LOTE_PARALELO || hilos == 1) {
+            for (int k = desde; k < hasta; k++) {
+                set[lotes->getI(k)].choque(set[lotes->getJ(k)]);
+            }
+            continue;
+        }
+        pool.enCadaHilo([&](int h) {
+            int a = desde + (int)((long)(hasta - desde) * h / hilos);
+            int b = desde + (int)((long)(hasta - desde) * (h + 1) / hilos);
+            for (int k = a; k < b; k++) {
+                set[lotes->getI(k)].choque(set[lotes->getJ(k)]);
             }
+        });
+    }
+
+    actual.paresCandidatos += candidatos;
+    actual.colisiones += lotes->getPares();
+    actual.choques += lotes->getPares();
+}
+
+/**
+ * Hace rebotar las partículas en los obstáculos estáticos
+ * @param obstaculos Obstáculos ya construidos
+ * @return Número de rebotes
+ */
+int ConjuntoParticulas::rebotarObstaculos(const ObstaculosEstaticos& obstaculos) {
+    PERFIL_AMBITO("obstaculos");
+
+    int rebotes = 0;
+    for (int i = 0; i < utiles; i++) {
+        rebotes += obstaculos.rebotar(set[i]);
+    }
+    actual.rebotesObstaculo += rebotes;
+    return rebotes;
+}
+
+/**
+ * Elimina las partículas que colisionan con un atractor
+ * @param atractor Partícula que absorbe a las que toca
+ * @return Número de partículas absorbidas
+ */
+int ConjuntoParticulas::absorber(const Particula& atractor) {
+    PERFIL_AMBITO("absorcion");
+
+    int absorbidas = 0;
+    // Se recorre de atrás hacia delante porque borrar() trae la última
+    // partícula al hueco, que así ya ha sido comprobada. Quitar no cambia
+    // las posiciones anteriores, así que la copia por columnas sigue valiendo
+    copiarColumnas();
+    Escalar xa = atractor.getPos().getX(), ya = atractor.getPos().getY(), ra = atractor.getRadio();
+    for (int i0 = (utiles - 1) / TAM_BLOQUE_COLISION * TAM_BLOQUE_COLISION; i0 >= 0; i0 -= TAM_BLOQUE_COLISION) {
+        int n = (utiles - i0 < TAM_BLOQUE_COLISION) ? utiles - i0 : TAM_BLOQUE_COLISION;
+        unsigned mascara = colisionesBloque(xa, ya, ra, columnaX + i0, columnaY + i0, columnaR + i0, n);
+        while (mascara != 0) {
+            int b = 31 - __builtin_clz(mascara);
+            mascara &= ~(1u << b);
+            quitar(i0 + b);
+            absorbidas++;
         }
     }
+    ajustarCapacidad();
+    actual.absorbidas += absorbidas;
+    return absorbidas;
+}
+
+/**
+ * Elimina las partículas que colisionan con cualquiera de los atractores
+ * @param atractores Conjunto de atractores (se reindexa)
+ * @return Número de partículas absorbidas
+ */
+int ConjuntoParticulas::absorber(ConjuntoAtractores& atractores) {
+    PERFIL_AMBITO("absorcion");
+
+    // La rejilla se construye con el radio de la mayor partícula como margen
+    float maxRadio = 0;
+    for (int i = 0; i < utiles; i++) {
+        if (set[i].getRadio() > maxRadio) maxRadio = set[i].getRadio();
+    }
+    atractores.indexar(maxRadio);
+
+    int absorbidas = 0;
+    for (int i = utiles - 1; i >= 0; i--) {
+        if (atractores.absorbe(set[i])) {
+            quitar(i);
+            absorbidas++;
+        }
+    }
+    ajustarCapacidad();
+    actual.absorbidas += absorbidas;
+    return absorbidas;
+}
+
+/**
+ * Descuenta un paso de vida a cada partícula y elimina de una vez las que
+ * caducan. La capacidad se ajusta una sola vez al final
+ * @return Número de partículas eliminadas
+ */
+int ConjuntoParticulas::envejecer() {
+    PERFIL_AMBITO("envejecer");
+
+    int caducadas = 0;
+    // De atrás hacia delante, como en absorber(): la partícula que ocupa
+    // el hueco ya ha envejecido
+    for (int i = utiles - 1; i >= 0; i--) {
+        if (set[i].envejecer()) {
+            quitar(i);
+            caducadas++;
+        }
+    }
+    ajustarCapacidad();
+    actual.caducadas += caducadas;
+    return caducadas;
+}
+
+/**
+ * Cierra el paso de simulación en curso
+ */
+/**
+ * Suma a actual los bytes que han reservado el hash, la rejilla y los
+ * lotes desde la última llamada. Sus contadores son acumulados, así que
+ * basta con la diferencia
+ */
+void ConjuntoParticulas::contarBytesMotores() {
+    long bytes = 0;
+    if (hash != nullptr) bytes += hash->getBytesReservados();
+    if (rejilla != nullptr) bytes += rejilla->getBytesReservados();
+    if (lotes != nullptr) bytes += lotes->getBytesReservados();
+    actual.bytesReservados += bytes - bytesMotores;
+    bytesMotores = bytes;
+}
+
+void ConjuntoParticulas::finPaso() {
+    contarBytesMotores();
+    ultimo = actual;
+    totales.sumar(actual);
+    actual = EstadisticasConjunto();
+    pasos++;
+}
+
+const EstadisticasConjunto& ConjuntoParticulas::getEstadisticasPaso() const {
+    return ultimo;
+}
+
+const EstadisticasConjunto& ConjuntoParticulas::getEstadisticasTotales() const {
+    return totales;
+}
+
+long ConjuntoParticulas::getReordenaciones() const {
+    return reordenaciones;
+}
+
+long ConjuntoParticulas::getPasos() const {
+    return pasos;
+}
+
+/**
+ * Escribe una métrica en formato de texto de Prometheus
+ */
+static void metrica(std::ostream& os, const char* nombre, const char* tipo,
+                    const char* ayuda, long valor) {
+    os << "# HELP " << nombre << " " << ayuda << "\n"
+       << "# TYPE " << nombre << " " << tipo << "\n"
+       << nombre << " " << valor << "\n";
+}
+
+/**
+ * Escribe los contadores en formato de texto de Prometheus
+ * @param ruta Fichero de salida
+ * @return false si no se pudo escribir
+ */
+bool ConjuntoParticulas::volcarPrometheus(const std::string& ruta) const {
+    std::string temporal = ruta + ".tmp";
+    {
+        std::ofstream os(temporal);
+        if (!os) return false;
+
+        // Totales: contadores monótonos
+        metrica(os, "particulas_pasos_total", "counter", "Pasos de simulacion cerrados", pasos);
+        metrica(os, "particulas_pares_candidatos_total", "counter", "Pares comprobados en gestionarColisiones", totales.paresCandidatos);
+        metrica(os, "particulas_colisiones_total", "counter", "Pares que colisionaban", totales.colisiones);
+        metrica(os, "particulas_choques_total", "counter", "Llamadas a Particula::choque", totales.choques);
+        metrica(os, "particulas_absorbidas_total", "counter", "Particulas eliminadas por un atractor", totales.absorbidas);
+        metrica(os, "particulas_caducadas_total", "counter", "Particulas eliminadas al acabar su vida", totales.caducadas);
+        metrica(os, "particulas_redimensiones_total", "counter", "Arrays reservados por redimensionar", totales.redimensiones);
+        metrica(os, "particulas_bytes_reservados_total", "counter", "Bytes reservados para particulas y colisiones", totales.bytesReservados);
+        metrica(os, "particulas_cambios_celda_total", "counter", "Particulas reubicadas en el hash espacial", totales.cambiosCelda);
+        metrica(os, "particulas_rebotes_obstaculo_total", "counter", "Rebotes en obstaculos estaticos", totales.rebotesObstaculo);
+
+        // Último paso y estado actual: medidas instantáneas
+        metrica(os, "particulas_paso_pares_candidatos", "gauge", "Pares comprobados en el ultimo paso", ultimo.paresCandidatos);
+        metrica(os, "particulas_paso_colisiones", "gauge", "Colisiones en el ultimo paso", ultimo.colisiones);
+        metrica(os, "particulas_paso_absorbidas", "gauge", "Particulas absorbidas en el ultimo paso", ultimo.absorbidas);
+        metrica(os, "particulas_paso_caducadas", "gauge", "Particulas caducadas en el ultimo paso", ultimo.caducadas);
+        metrica(os, "particulas_paso_redimensiones", "gauge", "Redimensiones en el ultimo paso", ultimo.redimensiones);
+        metrica(os, "particulas_paso_cambios_celda", "gauge", "Particulas reubicadas en el hash en el ultimo paso", ultimo.cambiosCelda);
+        metrica(os, "particulas_utiles", "gauge", "Particulas en el conjunto", utiles);
+        metrica(os, "particulas_capacidad", "gauge", "Capacidad del array de particulas", capacidad);
+
+        if (!os.good()) return false;
+    }
+    return std::rename(temporal.c_str(), ruta.c_str()) == 0;
+}
+
+/**
+ * Mezcla n bytes en una huella FNV-1a
+ */
+static void mezclarHuella(uint64_t& h, const void* datos, size_t n) {
+    const unsigned char* b = static_cast<const unsigned char*>(datos);
+    for (size_t k = 0; k < n; k++) {
+        h ^= b[k];
+        h *= 1099511628211ULL;
+    }
+}
+
+/**
+ * Huella de los bits de las partículas útiles, en orden
+ * @return Huella FNV-1a de 64 bits
+ */
+uint64_t ConjuntoParticulas::hashEstado() const {
+    uint64_t h = 14695981039346656037ULL;
+    for (int i = 0; i < utiles; i++) {
+        const Particula& p = set[i];
+        Escalar v[7] = {p.getPos().getX(), p.getPos().getY(),
+                        p.getVeloc().getX(), p.getVeloc().getY(),
+                        p.getAcel().getX(), p.getAcel().getY(), p.getRadio()};
+        int e[2] = {p.getTipo(), p.getVida()};
+        mezclarHuella(h, v, sizeof(v));
+        mezclarHuella(h, e, sizeof(e));
+    }
+    return h;
 }
 
 /**
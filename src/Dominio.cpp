@@ -0,0 +1,394 @@
+#include "Dominio.h"
+#include "Perfilador.h"
+#include <chrono>
+#include <csignal>
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Los contadores de los anillos se comparten entre procesos: tienen que ser
+// atómicos sin cerrojo para que valgan en memoria compartida
+static_assert(std::atomic<unsigned>::is_always_lock_free, "los anillos necesitan atómicos sin cerrojo");
+
+// Tamaño de línea de caché, para que cada contador tenga la suya
+const size_t LINEA_CACHE = 64;
+
+/**
+ * Cabecera del segmento compartido
+ */
+struct DescomposicionDominio::Cabecera {
+    pthread_barrier_t barrera;
+};
+
+/**
+ * Anillo de un productor y un consumidor. Los contadores sólo crecen; el
+ * mensaje i está en la posición i % capacidad. El productor escribe el
+ * mensaje y luego publica cabeza; el consumidor lee hasta cabeza y luego
+ * publica cola. Los mensajes van justo detrás de la estructura
+ */
+struct DescomposicionDominio::Anillo {
+    alignas(LINEA_CACHE) std::atomic<unsigned> cabeza;
+    alignas(LINEA_CACHE) std::atomic<unsigned> cola;
+
+    MensajeParticula* mensajes() {
+        return reinterpret_cast<MensajeParticula*>(this + 1);
+    }
+
+    /**
+     * Encola un mensaje
+     * @return false si el anillo está lleno
+     */
+    bool enviar(const MensajeParticula& m, int capacidad) {
+        unsigned c = cabeza.load(std::memory_order_relaxed);
+        if (c - cola.load(std::memory_order_acquire) >= (unsigned)capacidad) {
+            return false;
+        }
+        mensajes()[c % capacidad] = m;
+        cabeza.store(c + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Desencola un mensaje
+     * @return false si el anillo está vacío
+     */
+    bool recibir(MensajeParticula& m, int capacidad) {
+        unsigned c = cola.load(std::memory_order_relaxed);
+        if (c == cabeza.load(std::memory_order_acquire)) {
+            return false;
+        }
+        m = mensajes()[c % capacidad];
+        cola.store(c + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+/**
+ * Redondea un tamaño al múltiplo de la línea de caché
+ */
+static size_t alinear(size_t n) {
+    return (n + LINEA_CACHE - 1) / LINEA_CACHE * LINEA_CACHE;
+}
+
+DescomposicionDominio::DescomposicionDominio(int numFranjas, int capacidad, const ParametrosMundo& mundo)
+    : numFranjas(numFranjas > 0 ? numFranjas : 1), capacidad(capacidad > 0 ? capacidad : 1), mundo(mundo),
+      segmento(nullptr), tamSegmento(0), cabecera(nullptr), anillos(nullptr), tamAnillo(0),
+      resumenes(nullptr), resultados(nullptr) {
+    ancho = mundo.maxX / this->numFranjas;
+    margenHalo = 2 * mundo.radioMax;
+
+    // Cabecera | anillos | resúmenes | partículas de cada franja
+    tamAnillo = alinear(sizeof(Anillo) + (size_t)this->capacidad * sizeof(MensajeParticula));
+    size_t offAnillos = alinear(sizeof(Cabecera));
+    size_t offResumenes = offAnillos + 2 * this->numFranjas * tamAnillo;
+    size_t offResultados = alinear(offResumenes + this->numFranjas * sizeof(ResumenFranja));
+    tamSegmento = offResultados + (size_t)this->numFranjas * this->capacidad * sizeof(MensajeParticula);
+
+    // El nombre se desvincula nada más proyectarlo: los procesos hijos
+    // heredan la proyección y no queda nada que limpiar si alguno muere
+    std::string nombre = "/particulas_" + std::to_string(getpid()) + "_" + std::to_string((size_t)this);
+    int fd = shm_open(nombre.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd == -1) return;
+    void* p = MAP_FAILED;
+    if (ftruncate(fd, tamSegmento) == 0) {
+        p = mmap(nullptr, tamSegmento, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    shm_unlink(nombre.c_str());
+    if (p == MAP_FAILED) return;
+
+    unsigned char* base = static_cast<unsigned char*>(p);
+    cabecera = reinterpret_cast<Cabecera*>(base);
+    anillos = base + offAnillos;
+    resumenes = reinterpret_cast<ResumenFranja*>(base + offResumenes);
+    resultados = reinterpret_cast<MensajeParticula*>(base + offResultados);
+
+    pthread_barrierattr_t atributos;
+    pthread_barrierattr_init(&atributos);
+    pthread_barrierattr_setpshared(&atributos, PTHREAD_PROCESS_SHARED);
+    int error = pthread_barrier_init(&cabecera->barrera, &atributos, this->numFranjas);
+    pthread_barrierattr_destroy(&atributos);
+    if (error != 0) {
+        munmap(p, tamSegmento);
+        return;
+    }
+
+    for (int a = 0; a < 2 * this->numFranjas; a++) {
+        new (anillos + a * tamAnillo) Anillo();
+    }
+    for (int k = 0; k < this->numFranjas; k++) {
+        resumenes[k] = ResumenFranja();
+    }
+    segmento = p;
+}
+
+DescomposicionDominio::~DescomposicionDominio() {
+    if (segmento != nullptr) {
+        pthread_barrier_destroy(&cabecera->barrera);
+        munmap(segmento, tamSegmento);
+    }
+}
+
+bool DescomposicionDominio::valida() const {
+    return segmento != nullptr;
+}
+
+int DescomposicionDominio::getNumFranjas() const {
+    return numFranjas;
+}
+
+/**
+ * Franja a la que pertenece una coordenada X (las de los extremos llegan
+ * hasta el infinito)
+ */
+int DescomposicionDominio::franja(float x) const {
+    int k = (int)(x / ancho);
+    if (x < 0 || k < 0) return 0;
+    if (k >= numFranjas) return numFranjas - 1;
+    return k;
+}
+
+DescomposicionDominio::Anillo* DescomposicionDominio::anillo(int origen, bool derecha) const {
+    return reinterpret_cast<Anillo*>(anillos + (2 * origen + (derecha ? 1 : 0)) * tamAnillo);
+}
+
+MensajeParticula DescomposicionDominio::aMensaje(const Particula& p, int clase) {
+    MensajeParticula m;
+    m.px = p.getPos().getX();
+    m.py = p.getPos().getY();
+    m.vx = p.getVeloc().getX();
+    m.vy = p.getVeloc().getY();
+    m.ax = p.getAcel().getX();
+    m.ay = p.getAcel().getY();
+    m.radio = p.getRadio();
+    m.tipo = p.getTipo();
+    m.vida = p.getVida();
+    m.clase = clase;
+    return m;
+}
+
+Particula DescomposicionDominio::aParticula(const MensajeParticula& m) {
+    Particula p(Vector2D(m.px, m.py), Vector2D(m.ax, m.ay), Vector2D(m.vx, m.vy), m.radio, m.tipo);
+    p.setVida(m.vida);
+    return p;
+}
+
+/**
+ * Simula una franja en el proceso actual. Todas las franjas dan los mismos
+ * pasos y cruzan la barrera el mismo número de veces
+ * @param k Franja
+ * @param inicial Nube inicial completa
+ * @param pasos Pasos a simular
+ */
+void DescomposicionDominio::simularFranja(int k, const ConjuntoParticulas& inicial, int pasos) {
+    auto inicio = std::chrono::steady_clock::now();
+    sembrarAleatorio(1 + k);
+    ResumenFranja resumen = ResumenFranja();
+
+    ConjuntoParticulas nube(0, mundo);
+    for (int i = 0; i < inicial.getUtiles(); i++) {
+        if (franja(inicial.obtener(i).getPos().getX()) == k) {
+            nube.agregar(inicial.obtener(i));
+        }
+    }
+
+    float x0 = k * ancho, x1 = (k + 1) * ancho;
+    Anillo* salida[2] = {anillo(k, false), anillo(k, true)};
+    Anillo* entrada[2] = {(k > 0) ? anillo(k - 1, true) : nullptr,
+                          (k < numFranjas - 1) ? anillo(k + 1, false) : nullptr};
+
+    // Halo recibido en un paso (sólo crece)
+    MensajeParticula* halo = nullptr;
+    int capacidadHalo = 0;
+
+    // Pares que gestionarColisiones ve pero que cuenta otra franja
+    long colisionesAjenas = 0;
+    long candidatosAjenos = 0;
+
+    for (int paso = 0; paso < pasos; paso++) {
+        nube.mover(1);
+
+        // 1) Migración: de atrás hacia delante porque borrar() trae la
+        //    última partícula al hueco
+        for (int i = nube.getUtiles() - 1; i >= 0; i--) {
+            int f = franja(nube.obtener(i).getPos().getX());
+            if (f != k) {
+                salida[f > k ? 1 : 0]->enviar(aMensaje(nube.obtener(i), MensajeParticula::MIGRA), capacidad);
+                nube.borrar(i);
+                resumen.migradas++;
+            }
+        }
+
+        // 2) Copias de las partículas cercanas a los bordes interiores
+        for (int i = 0; i < nube.getUtiles(); i++) {
+            float x = nube.obtener(i).getPos().getX();
+            if (k > 0 && x < x0 + margenHalo) {
+                salida[0]->enviar(aMensaje(nube.obtener(i), MensajeParticula::HALO), capacidad);
+                resumen.halo++;
+            }
+            if (k < numFranjas - 1 && x >= x1 - margenHalo) {
+                salida[1]->enviar(aMensaje(nube.obtener(i), MensajeParticula::HALO), capacidad);
+                resumen.halo++;
+            }
+        }
+
+        // 3) Recepción entre dos barreras: la primera garantiza que los
+        //    vecinos han enviado todo, la segunda que nadie envía el paso
+        //    siguiente mientras aún se está vaciando este
+        pthread_barrier_wait(&cabecera->barrera);
+        int numHalo = 0;
+        int numHaloIzquierda = 0;
+        MensajeParticula m;
+        for (int lado = 0; lado < 2; lado++) {
+            if (lado == 1) numHaloIzquierda = numHalo;
+            if (entrada[lado] == nullptr) continue;
+            while (entrada[lado]->recibir(m, capacidad)) {
+                if (m.clase == MensajeParticula::MIGRA) {
+                    nube.agregar(aParticula(m));
+                    continue;
+                }
+                if (numHalo >= capacidadHalo) {
+                    int nuevaCapacidad = (capacidadHalo > 0) ? 2 * capacidadHalo : 64;
+                    MensajeParticula* nuevo = new MensajeParticula[nuevaCapacidad];
+                    for (int h = 0; h < numHalo; h++) {
+                        nuevo[h] = halo[h];
+                    }
+                    delete[] halo;
+                    halo = nuevo;
+                    capacidadHalo = nuevaCapacidad;
+                }
+                halo[numHalo++] = m;
+            }
+        }
+        pthread_barrier_wait(&cabecera->barrera);
+
+        // 4) Colisiones con el halo al final de la nube (primero el de la
+        //    izquierda), que luego se quita
+        int propias = nube.getUtiles();
+        for (int h = 0; h < numHalo; h++) {
+            nube.agregar(aParticula(halo[h]));
+        }
+        nube.gestionarColisiones();
+
+        // Cada par se cuenta en una sola franja: los de dos copias de halo
+        // son de otra (o de ninguna) y los de una propia con el halo de la
+        // izquierda los cuenta la franja de la izquierda. El choque no
+        // mueve las partículas, así que se pueden buscar después. La nube
+        // usa todos contra todos: los candidatos son todos los pares
+        for (int a = propias; a < propias + numHalo; a++) {
+            int desde = (a < propias + numHaloIzquierda) ? 0 : propias;
+            for (int b = desde; b < a; b++) {
+                if (nube.obtener(a).colision(nube.obtener(b))) {
+                    colisionesAjenas++;
+                }
+            }
+        }
+        candidatosAjenos += (long)numHalo * (numHalo - 1) / 2 + (long)propias * numHaloIzquierda;
+        for (int i = nube.getUtiles() - 1; i >= propias; i--) {
+            nube.borrar(i);
+        }
+        nube.finPaso();
+    }
+    delete[] halo;
+
+    MensajeParticula* destino = resultados + (size_t)k * capacidad;
+    for (int i = 0; i < nube.getUtiles(); i++) {
+        destino[i] = aMensaje(nube.obtener(i), MensajeParticula::MIGRA);
+    }
+    resumen.particulas = nube.getUtiles();
+    resumen.colisiones = nube.getEstadisticasTotales().colisiones - colisionesAjenas;
+    resumen.paresCandidatos = nube.getEstadisticasTotales().paresCandidatos - candidatosAjenos;
+    resumen.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    resumenes[k] = resumen;
+}
+
+/**
+ * Simula la nube repartida en un proceso por franja y espera a que
+ * terminen todos. Si alguno muere, los demás se quedarían esperando en la
+ * barrera, así que se matan
+ * @param inicial Partículas iniciales (como mucho capacidad)
+ * @param pasos Pasos a simular
+ * @return false si no se pudo crear algún proceso o alguno falló
+ */
+bool DescomposicionDominio::ejecutar(const ConjuntoParticulas& inicial, int pasos) {
+    PERFIL_AMBITO("dominio");
+
+    if (!valida() || inicial.getUtiles() > capacidad) {
+        return false;
+    }
+    for (int a = 0; a < 2 * numFranjas; a++) {
+        new (anillos + a * tamAnillo) Anillo();
+    }
+    for (int k = 0; k < numFranjas; k++) {
+        resumenes[k] = ResumenFranja();
+    }
+
+    pid_t* hijos = new pid_t[numFranjas];
+    bool correcto = true;
+    int lanzados = 0;
+    for (; lanzados < numFranjas; lanzados++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            simularFranja(lanzados, inicial, pasos);
+            _exit(0);
+        }
+        if (pid == -1) {
+            correcto = false;
+            break;
+        }
+        hijos[lanzados] = pid;
+    }
+
+    // Espera sin bloquearse en ningún hijo concreto, para enterarse a
+    // tiempo de si alguno falla
+    int vivos = lanzados;
+    if (!correcto) {
+        for (int k = 0; k < lanzados; k++) kill(hijos[k], SIGKILL);
+    }
+    while (vivos > 0) {
+        for (int k = 0; k < lanzados; k++) {
+            if (hijos[k] == 0) continue;
+            int estado;
+            if (waitpid(hijos[k], &estado, WNOHANG) != hijos[k]) continue;
+            hijos[k] = 0;
+            vivos--;
+            if (!WIFEXITED(estado) || WEXITSTATUS(estado) != 0) {
+                if (correcto) {
+                    for (int j = 0; j < lanzados; j++) {
+                        if (hijos[j] != 0) kill(hijos[j], SIGKILL);
+                    }
+                }
+                correcto = false;
+            }
+        }
+        if (vivos > 0) usleep(1000);
+    }
+    delete[] hijos;
+    return correcto;
+}
+
+const ResumenFranja& DescomposicionDominio::getResumen(int k) const {
+    return resumenes[k];
+}
+
+/**
+ * Agrega a una nube las partículas de todas las franjas tras ejecutar()
+ * @param destino Nube de destino
+ */
+void DescomposicionDominio::recoger(ConjuntoParticulas& destino) const {
+    if (!valida()) return;
+    int total = 0;
+    for (int k = 0; k < numFranjas; k++) {
+        total += resumenes[k].particulas;
+    }
+    destino.reservar(destino.getUtiles() + total);
+    for (int k = 0; k < numFranjas; k++) {
+        const MensajeParticula* origen = resultados + (size_t)k * capacidad;
+        for (int i = 0; i < resumenes[k].particulas; i++) {
+            destino.agregar(aParticula(origen[i]));
+        }
+    }
+    destino.reservar(0);
+}
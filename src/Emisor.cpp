@@ -0,0 +1,97 @@
+#include "Emisor.h"
+#include <cmath>
+
+Emisor::Emisor(const Vector2D& pos, float tasa, int vidaMin, int vidaMax,
+               const Vector2D& velocidad, float dispersionVeloc)
+    : pos(pos), dispersion(10.0f), tasa(0.0f), acumulado(0.0f),
+      velocidad(velocidad), dispersionVeloc(dispersionVeloc),
+      vidaMin(1), vidaMax(1), radioMin(MIN_R), radioMax(MAX_R), tipo(0) {
+    setTasa(tasa);
+    setVida(vidaMin, vidaMax);
+}
+
+void Emisor::setPos(const Vector2D& pos) {
+    this->pos = pos;
+}
+
+void Emisor::setTasa(float tasa) {
+    this->tasa = (tasa > 0) ? tasa : 0;
+}
+
+void Emisor::setDispersion(float dispersion) {
+    this->dispersion = (dispersion > 0) ? dispersion : 0;
+}
+
+void Emisor::setVelocidad(const Vector2D& velocidad, float dispersionVeloc) {
+    this->velocidad = velocidad;
+    this->dispersionVeloc = dispersionVeloc;
+}
+
+/**
+ * Fija el rango de vida de las partículas emitidas (como mínimo un paso)
+ */
+void Emisor::setVida(int vidaMin, int vidaMax) {
+    this->vidaMin = (vidaMin > 0) ? vidaMin : 1;
+    this->vidaMax = (vidaMax > this->vidaMin) ? vidaMax : this->vidaMin;
+}
+
+void Emisor::setRadio(float radioMin, float radioMax) {
+    this->radioMin = radioMin;
+    this->radioMax = (radioMax > radioMin) ? radioMax : radioMin;
+}
+
+void Emisor::setTipo(int tipo) {
+    this->tipo = tipo;
+}
+
+Vector2D Emisor::getPos() const {
+    return pos;
+}
+
+float Emisor::getTasa() const {
+    return tasa;
+}
+
+int Emisor::ocupacionMaxima() const {
+    return (int)std::ceil(tasa) * vidaMax;
+}
+
+/**
+ * Agrega a la nube las partículas de este paso
+ * @param nube Conjunto que recibe las partículas
+ * @return Número de partículas emitidas
+ */
+int Emisor::emitir(ConjuntoParticulas& nube) {
+    acumulado += tasa;
+    int lote = (int)acumulado;
+    acumulado -= lote;
+    if (lote == 0) {
+        return 0;
+    }
+
+    // Una sola ampliación para todo el lote, en vez de una cada
+    // TAM_BLOQUE partículas. Crece al doble para que el arranque no copie
+    // el array en cada paso, y se restaura la capacidad mínima de antes:
+    // fijarla es cosa de quien llama
+    int necesaria = nube.getUtiles() + lote;
+    if (necesaria > nube.getCapacidad()) {
+        int doble = 2 * nube.getCapacidad();
+        int minima = nube.getCapacidadMinima();
+        nube.reservar(necesaria > doble ? necesaria : doble);
+        nube.reservar(minima);
+    }
+
+    for (int k = 0; k < lote; k++) {
+        // Punto uniforme en el disco de emisión
+        float angulo = aleatorio(0.0f, 2.0f * (float)M_PI);
+        float dist = dispersion * std::sqrt(aleatorio(0.0f, 1.0f));
+        Vector2D p(pos.getX() + dist * std::cos(angulo), pos.getY() + dist * std::sin(angulo));
+        Vector2D v(velocidad.getX() + aleatorio(-dispersionVeloc, dispersionVeloc),
+                   velocidad.getY() + aleatorio(-dispersionVeloc, dispersionVeloc));
+
+        Particula part(p, Vector2D(), v, aleatorio(radioMin, radioMax), tipo);
+        part.setVida(aleatorioEntero(vidaMin, vidaMax));
+        nube.agregar(part);
+    }
+    return lote;
+}
@@ -0,0 +1,143 @@
+#include "Ensamble.h"
+#include "ConjuntoAtractores.h"
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
+ParametrosEjecucion::ParametrosEjecucion()
+    : semilla(1), numParticulas(500), modo(1), pasos(1000),
+      colisiones(true),
+      numAtractores(1), radioAtractor(35.0f), gravedad(0.0f) {}
+
+ResumenEjecucion::ResumenEjecucion()
+    : supervivientes(0), pasosSimulados(0), paresCandidatos(0), colisiones(0),
+      absorbidas(0), velocidadMedia(0.0f), segundos(0.0) {}
+
+Ensamble::Ensamble()
+    : parametros(nullptr), resumenes(nullptr), capacidad(0), utiles(0) {}
+
+Ensamble::~Ensamble() {
+    delete[] parametros;
+    delete[] resumenes;
+}
+
+/**
+ * Agrega una ejecución
+ * @param p Parámetros de la ejecución
+ * @return Índice de la ejecución
+ */
+int Ensamble::agregar(const ParametrosEjecucion& p) {
+    if (utiles >= capacidad) {
+        int nuevaCapacidad = (capacidad > 0) ? 2 * capacidad : 16;
+        ParametrosEjecucion* nuevosParametros = new ParametrosEjecucion[nuevaCapacidad];
+        ResumenEjecucion* nuevosResumenes = new ResumenEjecucion[nuevaCapacidad];
+        for (int i = 0; i < utiles; i++) {
+            nuevosParametros[i] = parametros[i];
+            nuevosResumenes[i] = resumenes[i];
+        }
+        delete[] parametros;
+        delete[] resumenes;
+        parametros = nuevosParametros;
+        resumenes = nuevosResumenes;
+        capacidad = nuevaCapacidad;
+    }
+    parametros[utiles] = p;
+    resumenes[utiles] = ResumenEjecucion();
+    return utiles++;
+}
+
+int Ensamble::getUtiles() const {
+    return utiles;
+}
+
+const ParametrosEjecucion& Ensamble::getParametros(int i) const {
+    return parametros[i];
+}
+
+const ResumenEjecucion& Ensamble::getResumen(int i) const {
+    return resumenes[i];
+}
+
+/**
+ * Ejecuta todas las simulaciones repartidas en el pool. Cada tarea escribe
+ * sólo en su propio resumen, así que no hace falta sincronizar nada más
+ * @param pool Hilos que ejecutan las simulaciones
+ */
+void Ensamble::ejecutar(PoolTrabajo& pool) {
+    pool.paraCada(utiles, [this](int i) {
+        resumenes[i] = simular(parametros[i]);
+    });
+}
+
+/**
+ * Ejecuta una simulación en el hilo actual
+ * @param p Parámetros de la ejecución
+ * @return Resumen de la ejecución
+ */
+ResumenEjecucion Ensamble::simular(const ParametrosEjecucion& p) {
+    auto inicio = std::chrono::steady_clock::now();
+    sembrarAleatorio(p.semilla);
+
+    ConjuntoParticulas nube(p.numParticulas, p.mundo);
+
+    ConjuntoAtractores atractores(p.mundo);
+    for (int a = 0; a < p.numAtractores; a++) {
+        Vector2D centro = (a == 0) ? Vector2D(p.mundo.maxX / 2, p.mundo.maxY / 2)
+                                   : Vector2D(aleatorio(0, p.mundo.maxX), aleatorio(0, p.mundo.maxY));
+        atractores.agregar(centro, p.radioAtractor);
+    }
+
+    ResumenEjecucion resumen;
+    while (resumen.pasosSimulados < p.pasos && nube.getUtiles() > 0) {
+        if (p.gravedad > 0) {
+            atractores.aplicarCampo(nube, p.gravedad);
+        }
+        nube.mover(p.modo);
+        if (p.colisiones) {
+            nube.gestionarColisiones();
+        }
+        nube.absorber(atractores);
+        nube.finPaso();
+        resumen.pasosSimulados++;
+    }
+
+    const EstadisticasConjunto& totales = nube.getEstadisticasTotales();
+    resumen.supervivientes = nube.getUtiles();
+    resumen.paresCandidatos = totales.paresCandidatos;
+    resumen.colisiones = totales.colisiones;
+    resumen.absorbidas = totales.absorbidas;
+
+    double suma = 0;
+    for (const Vector2D& v : nube.vistaVelocidades()) {
+        suma += v.modulo();
+    }
+    resumen.velocidadMedia = (nube.getUtiles() > 0) ? (float)(suma / nube.getUtiles()) : 0.0f;
+    resumen.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+    return resumen;
+}
+
+/**
+ * Escribe los parámetros y el resumen de cada ejecución en CSV
+ * @param ruta Fichero de salida
+ * @return false si no se pudo escribir
+ */
+bool Ensamble::volcarCSV(const std::string& ruta) const {
+    std::ofstream os(ruta);
+    if (!os) return false;
+
+    os << "ejecucion,semilla,particulas,modo,pasos,ancho,alto,velocidad_max,radio_min,radio_max,colisiones,"
+          "atractores,radio_atractor,gravedad,"
+          "supervivientes,pasos_simulados,pares_candidatos,colisiones_total,absorbidas,"
+          "velocidad_media,segundos\n";
+    for (int i = 0; i < utiles; i++) {
+        const ParametrosEjecucion& p = parametros[i];
+        const ResumenEjecucion& r = resumenes[i];
+        os << i << "," << p.semilla << "," << p.numParticulas << "," << p.modo << "," << p.pasos << ","
+           << p.mundo.maxX << "," << p.mundo.maxY << "," << p.mundo.maxVel << ","
+           << p.mundo.radioMin << "," << p.mundo.radioMax << "," << (p.colisiones ? 1 : 0) << ","
+           << p.numAtractores << "," << p.radioAtractor << "," << p.gravedad << ","
+           << r.supervivientes << "," << r.pasosSimulados << "," << r.paresCandidatos << ","
+           << r.colisiones << "," << r.absorbidas << "," << r.velocidadMedia << "," << r.segundos << "\n";
+    }
+    return os.good();
+}
@@ -0,0 +1,113 @@
+#include "EscritorVideo.h"
+
+// Tamaño del buffer de stdio: varios MB para escribir fotogramas enteros
+const size_t TAM_BUFFER_SALIDA = 8 << 20;
+
+EscritorVideo::EscritorVideo(const std::string& ruta, int ancho, int alto, int fps, Formato formato)
+    : salida(nullptr), propio(false), formato(formato), ancho(ancho), alto(alto),
+      yuv(nullptr), fotogramas(0) {
+    // Y4M 4:2:0 necesita dimensiones pares
+    if (ancho <= 0 || alto <= 0 || (formato == Y4M && (ancho % 2 || alto % 2))) {
+        return;
+    }
+
+    if (ruta == "-") {
+        salida = stdout;
+    } else {
+        salida = std::fopen(ruta.c_str(), "wb");
+        propio = true;
+    }
+    if (salida == nullptr) {
+        return;
+    }
+    std::setvbuf(salida, nullptr, _IOFBF, TAM_BUFFER_SALIDA);
+
+    if (formato == Y4M) {
+        yuv = new unsigned char[(size_t)ancho * alto * 3 / 2];
+        std::fprintf(salida, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", ancho, alto, fps);
+    }
+}
+
+EscritorVideo::~EscritorVideo() {
+    if (salida != nullptr) {
+        if (propio) {
+            std::fclose(salida);
+        } else {
+            std::fflush(salida);
+        }
+    }
+    delete[] yuv;
+}
+
+bool EscritorVideo::abierto() const {
+    return salida != nullptr;
+}
+
+long EscritorVideo::getFotogramas() const {
+    return fotogramas;
+}
+
+/**
+ * Convierte el framebuffer RGBA a YUV 4:2:0 (BT.601, rango completo) con
+ * aritmética entera; los bucles internos no tienen saltos y el compilador
+ * los vectoriza
+ */
+void EscritorVideo::convertirYUV(const ColorRGBA* pixeles) {
+    unsigned char* planoY = yuv;
+    unsigned char* planoU = yuv + (size_t)ancho * alto;
+    unsigned char* planoV = planoU + (size_t)ancho * alto / 4;
+
+    const unsigned char* rgba = reinterpret_cast<const unsigned char*>(pixeles);
+    size_t total = (size_t)ancho * alto;
+    for (size_t i = 0; i < total; i++) {
+        int r = rgba[4 * i], g = rgba[4 * i + 1], b = rgba[4 * i + 2];
+        planoY[i] = (unsigned char)((77 * r + 150 * g + 29 * b + 128) >> 8);
+    }
+
+    // Crominancia: media de cada bloque de 2x2 píxeles
+    int anchoC = ancho / 2;
+    for (int y = 0; y < alto / 2; y++) {
+        const unsigned char* f0 = rgba + (size_t)(2 * y) * ancho * 4;
+        const unsigned char* f1 = f0 + (size_t)ancho * 4;
+        for (int x = 0; x < anchoC; x++) {
+            int k = 8 * x;
+            int r = f0[k] + f0[k + 4] + f1[k] + f1[k + 4];
+            int g = f0[k + 1] + f0[k + 5] + f1[k + 1] + f1[k + 5];
+            int b = f0[k + 2] + f0[k + 6] + f1[k + 2] + f1[k + 6];
+            // r, g, b son sumas de 4 muestras: el desplazamiento incluye /4
+            int u = (-43 * r - 85 * g + 128 * b + 131072 + 512) >> 10;
+            int v = (128 * r - 107 * g - 21 * b + 131072 + 512) >> 10;
+            planoU[(size_t)y * anchoC + x] = (unsigned char)(u > 255 ? 255 : u);
+            planoV[(size_t)y * anchoC + x] = (unsigned char)(v > 255 ? 255 : v);
+        }
+    }
+}
+
+/**
+ * Añade un fotograma
+ * @param r Rasterizador con el mismo tamaño que el vídeo
+ * @return false si hubo un error de escritura o el tamaño no coincide
+ */
+bool EscritorVideo::escribir(const Rasterizador& r) {
+    if (salida == nullptr || r.getAncho() != ancho || r.getAlto() != alto) {
+        return false;
+    }
+
+    size_t bytes;
+    const void* datos;
+    if (formato == Y4M) {
+        convertirYUV(r.getPixeles());
+        std::fputs("FRAME\n", salida);
+        bytes = (size_t)ancho * alto * 3 / 2;
+        datos = yuv;
+    } else {
+        bytes = (size_t)ancho * alto * sizeof(ColorRGBA);
+        datos = r.getPixeles();
+    }
+
+    if (std::fwrite(datos, 1, bytes, salida) != bytes) {
+        return false;
+    }
+    fotogramas++;
+    return true;
+}
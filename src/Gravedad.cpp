@@ -0,0 +1,300 @@
+#include "Gravedad.h"
+#include "Perfilador.h"
+#include <cmath>
+
+// Profundidad máxima del árbol: por debajo, los cuerpos que caen en la
+// misma hoja (p.ej. varias partículas estáticas en el origen) se agrupan
+const int PROF_MAX_ARBOL = 32;
+
+MotorGravedad::MotorGravedad(Modo modo, float G, float theta, float suavizado)
+    : modo(modo), G(G), theta(theta), suavizado(suavizado),
+      x(nullptr), y(nullptr), m(nullptr), ax(nullptr), ay(nullptr),
+      capacidadCuerpos(0), numCuerpos(0),
+      nodos(nullptr), capacidadNodos(0), numNodos(0) {}
+
+MotorGravedad::~MotorGravedad() {
+    delete[] x;
+    delete[] y;
+    delete[] m;
+    delete[] ax;
+    delete[] ay;
+    delete[] nodos;
+}
+
+void MotorGravedad::setModo(Modo modo) {
+    this->modo = modo;
+}
+
+void MotorGravedad::setG(float G) {
+    this->G = G;
+}
+
+void MotorGravedad::setTheta(float theta) {
+    this->theta = (theta >= 0) ? theta : 0;
+}
+
+void MotorGravedad::setSuavizado(float suavizado) {
+    this->suavizado = suavizado;
+}
+
+MotorGravedad::Modo MotorGravedad::getModo() const {
+    return modo;
+}
+
+float MotorGravedad::getTheta() const {
+    return theta;
+}
+
+int MotorGravedad::getNumNodos() const {
+    return numNodos;
+}
+
+/**
+ * Copia posiciones y masas de la nube y los atractores a los arrays SoA
+ */
+void MotorGravedad::recogerCuerpos(const ConjuntoParticulas& nube, const Particula* atractores, int numAtractores) {
+    int n = nube.getUtiles();
+    numCuerpos = n + numAtractores;
+
+    // Los arrays sólo crecen
+    if (numCuerpos > capacidadCuerpos) {
+        delete[] x;
+        delete[] y;
+        delete[] m;
+        delete[] ax;
+        delete[] ay;
+        capacidadCuerpos = numCuerpos;
+        x = new float[capacidadCuerpos];
+        y = new float[capacidadCuerpos];
+        m = new float[capacidadCuerpos];
+        ax = new float[capacidadCuerpos];
+        ay = new float[capacidadCuerpos];
+    }
+
+    for (int i = 0; i < n; i++) {
+        const Particula& p = nube.obtener(i);
+        x[i] = p.getPos().getX();
+        y[i] = p.getPos().getY();
+        m[i] = p.getRadio() * p.getRadio();
+    }
+    for (int a = 0; a < numAtractores; a++) {
+        const Particula& p = atractores[a];
+        x[n + a] = p.getPos().getX();
+        y[n + a] = p.getPos().getY();
+        m[n + a] = p.getRadio() * p.getRadio();
+    }
+}
+
+/**
+ * Añade 4 hijos vacíos a un nodo
+ * @param padre Índice del nodo
+ */
+void MotorGravedad::subdividir(int padre) {
+    if (numNodos + 4 > capacidadNodos) {
+        int nuevaCapacidad = (capacidadNodos > 0) ? 2 * capacidadNodos : 64;
+        Nodo* nuevos = new Nodo[nuevaCapacidad];
+        for (int i = 0; i < numNodos; i++) {
+            nuevos[i] = nodos[i];
+        }
+        delete[] nodos;
+        nodos = nuevos;
+        capacidadNodos = nuevaCapacidad;
+    }
+
+    float mitad = nodos[padre].lado / 2;
+    nodos[padre].hijo = numNodos;
+    for (int k = 0; k < 4; k++) {
+        Nodo& h = nodos[numNodos + k];
+        h.x0 = nodos[padre].x0 + ((k & 1) ? mitad : 0);
+        h.y0 = nodos[padre].y0 + ((k & 2) ? mitad : 0);
+        h.lado = mitad;
+        h.masa = h.sx = h.sy = 0;
+        h.hijo = -1;
+        h.cuerpo = -1;
+    }
+    numNodos += 4;
+}
+
+/**
+ * Inserta un cuerpo en el árbol, bajando desde la raíz
+ * @param c Índice del cuerpo
+ */
+void MotorGravedad::insertar(int c) {
+    int n = 0;
+    int prof = 0;
+    while (true) {
+        if (nodos[n].hijo == -1) {
+            if (nodos[n].cuerpo == -1 || prof == PROF_MAX_ARBOL) {
+                // Hoja vacía, o ya no se puede subdividir más
+                nodos[n].cuerpo = (nodos[n].cuerpo == -1) ? c : -2;
+                nodos[n].masa += m[c];
+                nodos[n].sx += m[c] * x[c];
+                nodos[n].sy += m[c] * y[c];
+                return;
+            }
+
+            // Hoja ocupada: se subdivide y su cuerpo baja al hijo que le toca
+            int viejo = nodos[n].cuerpo;
+            nodos[n].cuerpo = -1;
+            subdividir(n);
+            float mx = nodos[n].x0 + nodos[n].lado / 2;
+            float my = nodos[n].y0 + nodos[n].lado / 2;
+            Nodo& h = nodos[nodos[n].hijo + (x[viejo] >= mx) + 2 * (y[viejo] >= my)];
+            h.cuerpo = viejo;
+            h.masa = m[viejo];
+            h.sx = m[viejo] * x[viejo];
+            h.sy = m[viejo] * y[viejo];
+        }
+
+        // Nodo interno: acumula el cuerpo y baja al cuadrante correspondiente
+        nodos[n].masa += m[c];
+        nodos[n].sx += m[c] * x[c];
+        nodos[n].sy += m[c] * y[c];
+        float mx = nodos[n].x0 + nodos[n].lado / 2;
+        float my = nodos[n].y0 + nodos[n].lado / 2;
+        n = nodos[n].hijo + (x[c] >= mx) + 2 * (y[c] >= my);
+        prof++;
+    }
+}
+
+/**
+ * Construye el árbol cuaternario con los cuerpos recogidos
+ */
+void MotorGravedad::construirArbol() {
+    // Caja cuadrada que contiene a todos los cuerpos
+    float minX = x[0], maxX = x[0], minY = y[0], maxY = y[0];
+    for (int i = 1; i < numCuerpos; i++) {
+        if (x[i] < minX) minX = x[i];
+        if (x[i] > maxX) maxX = x[i];
+        if (y[i] < minY) minY = y[i];
+        if (y[i] > maxY) maxY = y[i];
+    }
+    float lado = (maxX - minX > maxY - minY) ? maxX - minX : maxY - minY;
+
+    // La raíz ocupa el nodo 0; se reserva como si fuese un grupo de hijos
+    numNodos = 0;
+    if (capacidadNodos < 4) {
+        delete[] nodos;
+        capacidadNodos = 64;
+        nodos = new Nodo[capacidadNodos];
+    }
+    Nodo& raiz = nodos[0];
+    raiz.x0 = minX;
+    raiz.y0 = minY;
+    raiz.lado = lado * 1.0001f + 1e-3f;
+    raiz.masa = raiz.sx = raiz.sy = 0;
+    raiz.hijo = -1;
+    raiz.cuerpo = -1;
+    numNodos = 1;
+
+    for (int c = 0; c < numCuerpos; c++) {
+        insertar(c);
+    }
+
+    // Momentos -> centros de masas
+    for (int k = 0; k < numNodos; k++) {
+        if (nodos[k].masa > 0) {
+            nodos[k].sx /= nodos[k].masa;
+            nodos[k].sy /= nodos[k].masa;
+        }
+    }
+}
+
+/**
+ * Aceleración sobre los cuerpos [0, n) con la suma directa: cada par se
+ * calcula una vez y se aplica a los dos cuerpos
+ */
+void MotorGravedad::sumaDirecta(int n) {
+    float e2 = suavizado * suavizado;
+    for (int i = 0; i < numCuerpos; i++) {
+        ax[i] = ay[i] = 0;
+    }
+    for (int i = 0; i < n; i++) {
+        float axi = 0, ayi = 0;
+        for (int j = i + 1; j < numCuerpos; j++) {
+            float dx = x[j] - x[i];
+            float dy = y[j] - y[i];
+            float d2 = dx * dx + dy * dy + e2;
+            float inv = 1.0f / (d2 * std::sqrt(d2));
+            axi += m[j] * dx * inv;
+            ayi += m[j] * dy * inv;
+            ax[j] -= m[i] * dx * inv;
+            ay[j] -= m[i] * dy * inv;
+        }
+        ax[i] += axi;
+        ay[i] += ayi;
+    }
+}
+
+/**
+ * Aceleración sobre los cuerpos [0, n) recorriendo el árbol
+ */
+void MotorGravedad::sumaArbol(int n) {
+    float e2 = suavizado * suavizado;
+    float theta2 = theta * theta;
+    int pila[4 * PROF_MAX_ARBOL + 8];
+
+    for (int i = 0; i < n; i++) {
+        float axi = 0, ayi = 0;
+        int cima = 0;
+        pila[cima++] = 0;
+
+        while (cima > 0) {
+            const Nodo& nodo = nodos[pila[--cima]];
+            if (nodo.masa == 0 || nodo.cuerpo == i) continue;
+
+            float dx = nodo.sx - x[i];
+            float dy = nodo.sy - y[i];
+            float d2 = dx * dx + dy * dy;
+
+            if (nodo.hijo == -1 || nodo.lado * nodo.lado < theta2 * d2) {
+                // Hoja o nodo suficientemente lejano: un solo cuerpo
+                d2 += e2;
+                float inv = nodo.masa / (d2 * std::sqrt(d2));
+                axi += dx * inv;
+                ayi += dy * inv;
+            } else {
+                for (int k = 0; k < 4; k++) {
+                    pila[cima++] = nodo.hijo + k;
+                }
+            }
+        }
+        ax[i] = axi;
+        ay[i] = ayi;
+    }
+}
+
+/**
+ * Sustituye la aceleración de cada partícula de la nube por la atracción
+ * gravitatoria, limitada en módulo a MAX_ACC
+ * @param nube Partículas que se atraen entre sí
+ * @param atractores Cuerpos fijos que atraen a la nube (puede ser nullptr)
+ * @param numAtractores Número de atractores
+ */
+void MotorGravedad::calcular(ConjuntoParticulas& nube, const Particula* atractores, int numAtractores) {
+    PERFIL_AMBITO("gravedad");
+
+    int n = nube.getUtiles();
+    if (n == 0) return;
+
+    recogerCuerpos(nube, atractores, (atractores != nullptr) ? numAtractores : 0);
+
+    if (modo == DIRECTO) {
+        sumaDirecta(n);
+    } else {
+        construirArbol();
+        sumaArbol(n);
+    }
+
+    for (int i = 0; i < n; i++) {
+        float gx = G * ax[i];
+        float gy = G * ay[i];
+        float mod2 = gx * gx + gy * gy;
+        if (mod2 > MAX_ACC * MAX_ACC) {
+            float f = MAX_ACC / std::sqrt(mod2);
+            gx *= f;
+            gy *= f;
+        }
+        nube.obtener(i).setAcel(Vector2D(gx, gy));
+    }
+}
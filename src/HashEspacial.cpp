@@ -0,0 +1,183 @@
+#include "HashEspacial.h"
+
+HashEspacial::HashEspacial(float tamCelda, int numCubos)
+    : tamCelda(tamCelda > 0 ? tamCelda : 1.0f), siguiente(nullptr), anterior(nullptr),
+      celdaX(nullptr), celdaY(nullptr), capacidad(0), numElementos(0), bytesReservados(0) {
+    inverso = 1.0f / this->tamCelda;
+    this->numCubos = 1;
+    while (this->numCubos < numCubos) {
+        this->numCubos *= 2;
+    }
+    cabeza = new int[this->numCubos];
+    bytesReservados += (long)this->numCubos * sizeof(int);
+    for (int c = 0; c < this->numCubos; c++) {
+        cabeza[c] = -1;
+    }
+}
+
+HashEspacial::~HashEspacial() {
+    delete[] cabeza;
+    delete[] siguiente;
+    delete[] anterior;
+    delete[] celdaX;
+    delete[] celdaY;
+}
+
+float HashEspacial::getTamCelda() const {
+    return tamCelda;
+}
+
+int HashEspacial::getNumElementos() const {
+    return numElementos;
+}
+
+long HashEspacial::getBytesReservados() const {
+    return bytesReservados;
+}
+
+int HashEspacial::getCeldaX(int i) const {
+    return celdaX[i];
+}
+
+int HashEspacial::getCeldaY(int i) const {
+    return celdaY[i];
+}
+
+/**
+ * Asegura sitio para tam partículas, duplicando la capacidad para que
+ * insertar una a una no copie cada vez
+ * @param tam Número de partículas
+ */
+void HashEspacial::reservar(int tam) {
+    if (tam <= capacidad) {
+        return;
+    }
+    int nueva = capacidad * 2 > tam ? capacidad * 2 : tam;
+    int* sig = new int[nueva];
+    int* ant = new int[nueva];
+    int* cx = new int[nueva];
+    int* cy = new int[nueva];
+    bytesReservados += (long)nueva * 4 * sizeof(int);
+    for (int i = 0; i < numElementos; i++) {
+        sig[i] = siguiente[i];
+        ant[i] = anterior[i];
+        cx[i] = celdaX[i];
+        cy[i] = celdaY[i];
+    }
+    delete[] siguiente;
+    delete[] anterior;
+    delete[] celdaX;
+    delete[] celdaY;
+    siguiente = sig;
+    anterior = ant;
+    celdaX = cx;
+    celdaY = cy;
+    capacidad = nueva;
+}
+
+/**
+ * Mete la partícula i al principio de la lista del cubo de su celda
+ */
+void HashEspacial::enlazar(int i) {
+    int c = cubo(celdaX[i], celdaY[i]);
+    anterior[i] = -1;
+    siguiente[i] = cabeza[c];
+    if (cabeza[c] != -1) {
+        anterior[cabeza[c]] = i;
+    }
+    cabeza[c] = i;
+}
+
+/**
+ * Saca la partícula i de la lista de su cubo
+ */
+void HashEspacial::desenlazar(int i) {
+    if (anterior[i] != -1) {
+        siguiente[anterior[i]] = siguiente[i];
+    } else {
+        cabeza[cubo(celdaX[i], celdaY[i])] = siguiente[i];
+    }
+    if (siguiente[i] != -1) {
+        anterior[siguiente[i]] = anterior[i];
+    }
+}
+
+void HashEspacial::reconstruir(const Particula* set, int n) {
+    for (int c = 0; c < numCubos; c++) {
+        cabeza[c] = -1;
+    }
+    numElementos = 0;
+    reservar(n);
+    for (int i = 0; i < n; i++) {
+        insertar(set[i].getPos());
+    }
+}
+
+void HashEspacial::insertar(const Vector2D& pos) {
+    reservar(numElementos + 1);
+    int i = numElementos++;
+    celdaX[i] = celda(pos.getX());
+    celdaY[i] = celda(pos.getY());
+    enlazar(i);
+}
+
+/**
+ * Quita la partícula i. La última pasa al índice i: se cambian los enlaces
+ * que apuntaban a ella, sin moverla de su cubo
+ * @param i Índice de la partícula quitada
+ */
+void HashEspacial::quitar(int i) {
+    int ultima = numElementos - 1;
+    desenlazar(i);
+    if (i != ultima) {
+        siguiente[i] = siguiente[ultima];
+        anterior[i] = anterior[ultima];
+        celdaX[i] = celdaX[ultima];
+        celdaY[i] = celdaY[ultima];
+        if (anterior[i] != -1) {
+            siguiente[anterior[i]] = i;
+        } else {
+            cabeza[cubo(celdaX[i], celdaY[i])] = i;
+        }
+        if (siguiente[i] != -1) {
+            anterior[siguiente[i]] = i;
+        }
+    }
+    numElementos--;
+}
+
+bool HashEspacial::reubicar(int i, const Vector2D& pos) {
+    int cx = celda(pos.getX());
+    int cy = celda(pos.getY());
+    if (cx == celdaX[i] && cy == celdaY[i]) {
+        return false;
+    }
+    // Otra celda del mismo cubo: basta con cambiar la celda apuntada
+    if (cubo(cx, cy) != cubo(celdaX[i], celdaY[i])) {
+        desenlazar(i);
+        celdaX[i] = cx;
+        celdaY[i] = cy;
+        enlazar(i);
+    } else {
+        celdaX[i] = cx;
+        celdaY[i] = cy;
+    }
+    return true;
+}
+
+/**
+ * Comprueba la celda de todas las partículas. La comprobación es una
+ * pasada secuencial por las posiciones; sólo las que cambian de celda
+ * tocan las listas
+ * @param set Partículas
+ * @return Número de partículas que han cambiado de celda
+ */
+int HashEspacial::actualizar(const Particula* set) {
+    int cambios = 0;
+    for (int i = 0; i < numElementos; i++) {
+        if (reubicar(i, set[i].getPos())) {
+            cambios++;
+        }
+    }
+    return cambios;
+}
@@ -0,0 +1,147 @@
+#include "Instantanea.h"
+#include <cmath>
+
+/**
+ * Asegura espacio para al menos tam partículas (no conserva datos)
+ * @param tam Número de partículas
+ */
+void Instantanea::reservarMemoria(int tam) {
+    // Sólo reservamos de nuevo si no cabe en lo que ya tenemos
+    if (tam > capacidad) {
+        liberarMemoria();
+        x = new float[tam];
+        y = new float[tam];
+        radio = new float[tam];
+        tipo = new int[tam];
+        capacidad = tam;
+    }
+}
+
+/**
+ * Libera la memoria de los arrays
+ */
+void Instantanea::liberarMemoria() {
+    delete[] x;
+    delete[] y;
+    delete[] radio;
+    delete[] tipo;
+    x = y = radio = nullptr;
+    tipo = nullptr;
+    capacidad = 0;
+}
+
+Instantanea::Instantanea()
+    : x(nullptr), y(nullptr), radio(nullptr), tipo(nullptr),
+      capacidad(0), utiles(0), capacidadConjunto(0), paso(-1), reordenaciones(0), tiempo(0.0) {}
+
+Instantanea::Instantanea(const Instantanea& otra) : Instantanea() {
+    *this = otra;
+}
+
+Instantanea::~Instantanea() {
+    liberarMemoria();
+}
+
+Instantanea& Instantanea::operator=(const Instantanea& otra) {
+    if (this != &otra) {
+        reservarMemoria(otra.utiles);
+        for (int i = 0; i < otra.utiles; i++) {
+            x[i] = otra.x[i];
+            y[i] = otra.y[i];
+            radio[i] = otra.radio[i];
+            tipo[i] = otra.tipo[i];
+        }
+        utiles = otra.utiles;
+        capacidadConjunto = otra.capacidadConjunto;
+        paso = otra.paso;
+        reordenaciones = otra.reordenaciones;
+        tiempo = otra.tiempo;
+    }
+    return *this;
+}
+
+/**
+ * Copia las posiciones, radios y tipos del conjunto
+ * @param nube Conjunto a capturar
+ * @param paso Número de paso de simulación
+ * @param tiempo Instante de la captura en segundos
+ */
+void Instantanea::capturar(const ConjuntoParticulas& nube, long paso, double tiempo) {
+    int n = nube.getUtiles();
+    reservarMemoria(n);
+
+    VistaCampo<Particula> particulas = nube.vistaParticulas();
+    VistaCampo<Vector2D> posiciones = nube.vistaPosiciones();
+    for (int i = 0; i < n; i++) {
+        x[i] = posiciones[i].getX();
+        y[i] = posiciones[i].getY();
+        radio[i] = particulas[i].getRadio();
+        tipo[i] = particulas[i].getTipo();
+    }
+
+    utiles = n;
+    capacidadConjunto = nube.getCapacidad();
+    this->paso = paso;
+    reordenaciones = nube.getReordenaciones();
+    this->tiempo = tiempo;
+}
+
+/**
+ * Dos instantáneas se pueden interpolar si son de pasos consecutivos y no
+ * ha desaparecido ni aparecido ninguna partícula entre ellas: al quitar una
+ * partícula la última pasa a su hueco y el índice i ya no sería la misma
+ * partícula en las dos (aunque otra agregada deje igual el número)
+ * @param anterior Instantánea del paso previo
+ * @return true si se pueden interpolar
+ */
+bool Instantanea::interpolable(const Instantanea& anterior) const {
+    return anterior.paso >= 0 && anterior.paso == paso - 1
+        && anterior.reordenaciones == reordenaciones && anterior.utiles == utiles;
+}
+
+/**
+ * Interpola una coordenada; tras un wrap se queda en la actual
+ * @param a Coordenada en la instantánea anterior
+ * @param b Coordenada en la actual
+ * @param alfa Fracción del intervalo transcurrida
+ * @param tamMundo Tamaño del mundo en el eje de la coordenada
+ * @return Coordenada interpolada
+ */
+float Instantanea::interpolar(float a, float b, float alfa, float tamMundo) {
+    if (std::fabs(b - a) > tamMundo / 2) {
+        return b;
+    }
+    return a + (b - a) * alfa;
+}
+
+int Instantanea::getUtiles() const {
+    return utiles;
+}
+
+int Instantanea::getCapacidadConjunto() const {
+    return capacidadConjunto;
+}
+
+long Instantanea::getPaso() const {
+    return paso;
+}
+
+double Instantanea::getTiempo() const {
+    return tiempo;
+}
+
+float Instantanea::getX(int i) const {
+    return x[i];
+}
+
+float Instantanea::getY(int i) const {
+    return y[i];
+}
+
+float Instantanea::getRadio(int i) const {
+    return radio[i];
+}
+
+int Instantanea::getTipo(int i) const {
+    return tipo[i];
+}
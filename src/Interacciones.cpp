@@ -0,0 +1,302 @@
+#include "Interacciones.h"
+#include "Perfilador.h"
+#include <cmath>
+
+// Número máximo de celdas por eje de la rejilla de vecinos
+const int MAX_CELDAS_EJE = 256;
+
+// Fracción del alcance por debajo de la cual todos los tipos se repelen
+const float BETA_REPULSION = 0.3f;
+
+MotorInteracciones::MotorInteracciones(int numTipos, float alcance, float escala, float rozamiento)
+    : numTipos(numTipos > 0 ? numTipos : 1), escala(escala), rozamiento(rozamiento), periodico(false),
+      x(nullptr), y(nullptr), ax(nullptr), ay(nullptr), orden(nullptr), clave(nullptr),
+      capacidadParticulas(0), inicio(nullptr), capacidadBloques(0),
+      celdasX(0), celdasY(0), tamX(1.0f), tamY(1.0f), anchoMundo(MAX_X), altoMundo(MAX_Y) {
+    int pares = this->numTipos * this->numTipos;
+    fuerza = new float[pares];
+    this->alcance = new float[pares];
+    for (int k = 0; k < pares; k++) {
+        fuerza[k] = 0.0f;
+        this->alcance[k] = alcance;
+    }
+}
+
+MotorInteracciones::~MotorInteracciones() {
+    delete[] fuerza;
+    delete[] alcance;
+    delete[] x;
+    delete[] y;
+    delete[] ax;
+    delete[] ay;
+    delete[] orden;
+    delete[] clave;
+    delete[] inicio;
+}
+
+int MotorInteracciones::getNumTipos() const {
+    return numTipos;
+}
+
+float MotorInteracciones::getFuerza(int a, int b) const {
+    return fuerza[a * numTipos + b];
+}
+
+float MotorInteracciones::getAlcance(int a, int b) const {
+    return alcance[a * numTipos + b];
+}
+
+void MotorInteracciones::setFuerza(int a, int b, float fuerza) {
+    if (a >= 0 && a < numTipos && b >= 0 && b < numTipos) {
+        this->fuerza[a * numTipos + b] = fuerza;
+    }
+}
+
+void MotorInteracciones::setAlcance(int a, int b, float alcance) {
+    if (a >= 0 && a < numTipos && b >= 0 && b < numTipos && alcance > 0) {
+        this->alcance[a * numTipos + b] = alcance;
+    }
+}
+
+void MotorInteracciones::setEscala(float escala) {
+    this->escala = escala;
+}
+
+void MotorInteracciones::setRozamiento(float rozamiento) {
+    this->rozamiento = rozamiento;
+}
+
+void MotorInteracciones::setPeriodico(bool periodico) {
+    this->periodico = periodico;
+}
+
+/**
+ * Fuerzas aleatorias en [-1, 1] y alcances aleatorios en el rango dado
+ * @param alcanceMin Alcance mínimo
+ * @param alcanceMax Alcance máximo
+ */
+void MotorInteracciones::aleatorizar(float alcanceMin, float alcanceMax) {
+    for (int k = 0; k < numTipos * numTipos; k++) {
+        fuerza[k] = aleatorio(-1.0f, 1.0f);
+        alcance[k] = aleatorio(alcanceMin, alcanceMax);
+    }
+}
+
+/**
+ * Celda de la rejilla que contiene una coordenada. Las coordenadas fuera
+ * del mundo (en wrap una partícula puede asomar por el borde) se recortan
+ * a la celda del borde
+ */
+int MotorInteracciones::celda(float v, float tam, int numCeldas) const {
+    int c = (int)std::floor(v / tam);
+    if (c < 0) return 0;
+    if (c >= numCeldas) return numCeldas - 1;
+    return c;
+}
+
+/**
+ * Celdas vecinas (3x3) de una celda. En periódico los índices dan la
+ * vuelta; con menos de 3 celdas por eje una celda aparecería repetida y
+ * sus partículas se contarían dos veces, así que se descartan repetidas
+ * @param vecinas Salida, como mucho 9 celdas
+ * @return Número de celdas vecinas
+ */
+int MotorInteracciones::vecinas(int cx, int cy, int* vecinas) const {
+    int n = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        int vy = cy + dy;
+        if (periodico) vy = (vy + celdasY) % celdasY;
+        else if (vy < 0 || vy >= celdasY) continue;
+
+        for (int dx = -1; dx <= 1; dx++) {
+            int vx = cx + dx;
+            if (periodico) vx = (vx + celdasX) % celdasX;
+            else if (vx < 0 || vx >= celdasX) continue;
+
+            int v = vy * celdasX + vx;
+            bool repetida = false;
+            for (int k = 0; k < n; k++) {
+                repetida = repetida || vecinas[k] == v;
+            }
+            if (!repetida) vecinas[n++] = v;
+        }
+    }
+    return n;
+}
+
+/**
+ * Copia la nube a los arrays SoA ordenados por celda y, dentro de cada
+ * celda, por tipo (ordenación por cuentas en dos pasadas)
+ * @return Número de partículas que participan
+ */
+int MotorInteracciones::ordenar(const ConjuntoParticulas& nube) {
+    int n = nube.getUtiles();
+
+    // Los arrays sólo crecen
+    if (n > capacidadParticulas) {
+        delete[] x;
+        delete[] y;
+        delete[] ax;
+        delete[] ay;
+        delete[] orden;
+        delete[] clave;
+        capacidadParticulas = n;
+        x = new float[n];
+        y = new float[n];
+        ax = new float[n];
+        ay = new float[n];
+        orden = new int[n];
+        clave = new int[n];
+    }
+
+    // Celdas de al menos el mayor alcance, repartidas exactamente en el mundo
+    float maxAlcance = 0;
+    for (int k = 0; k < numTipos * numTipos; k++) {
+        if (alcance[k] > maxAlcance) maxAlcance = alcance[k];
+    }
+    anchoMundo = nube.getMundo().maxX;
+    altoMundo = nube.getMundo().maxY;
+    celdasX = (int)(anchoMundo / maxAlcance);
+    celdasY = (int)(altoMundo / maxAlcance);
+    if (celdasX < 1) celdasX = 1;
+    if (celdasY < 1) celdasY = 1;
+    if (celdasX > MAX_CELDAS_EJE) celdasX = MAX_CELDAS_EJE;
+    if (celdasY > MAX_CELDAS_EJE) celdasY = MAX_CELDAS_EJE;
+    tamX = anchoMundo / celdasX;
+    tamY = altoMundo / celdasY;
+
+    int numBloques = celdasX * celdasY * numTipos;
+    if (numBloques + 1 > capacidadBloques) {
+        delete[] inicio;
+        capacidadBloques = numBloques + 1;
+        inicio = new int[capacidadBloques];
+    }
+    for (int k = 0; k <= numBloques; k++) {
+        inicio[k] = 0;
+    }
+
+    // Primera pasada: cuántas partículas hay en cada bloque
+    for (int i = 0; i < n; i++) {
+        const Particula& p = nube.obtener(i);
+        int t = p.getTipo();
+        if (t < 0 || t >= numTipos) {
+            clave[i] = -1;
+            continue;
+        }
+        int c = celda(p.getPos().getY(), tamY, celdasY) * celdasX + celda(p.getPos().getX(), tamX, celdasX);
+        clave[i] = c * numTipos + t;
+        inicio[clave[i] + 1]++;
+    }
+    for (int k = 0; k < numBloques; k++) {
+        inicio[k + 1] += inicio[k];
+    }
+
+    // Segunda pasada: colocar, usando inicio como cursor y restaurándolo
+    for (int i = 0; i < n; i++) {
+        if (clave[i] == -1) continue;
+        int s = inicio[clave[i]]++;
+        const Particula& p = nube.obtener(i);
+        x[s] = p.getPos().getX();
+        y[s] = p.getPos().getY();
+        orden[s] = i;
+    }
+    for (int k = numBloques; k > 0; k--) {
+        inicio[k] = inicio[k - 1];
+    }
+    inicio[0] = 0;
+
+    return inicio[numBloques];
+}
+
+/**
+ * Sustituye (o incrementa) la aceleración de cada partícula por la que le
+ * causan sus vecinas según la matriz de tipos, limitada en módulo a MAX_ACC.
+ *
+ * Con r = distancia / alcance, la fuerza de b sobre a es:
+ *  - r < BETA: repulsión r/BETA - 1, igual para todos los tipos
+ *  - BETA <= r < 1: fuerza(a, b) con un perfil triangular que vale 0 en
+ *    los extremos y fuerza(a, b) en el punto medio
+ * @param nube Partículas que interactúan
+ * @param acumular true para sumar a la aceleración actual
+ */
+void MotorInteracciones::calcular(ConjuntoParticulas& nube, bool acumular) {
+    PERFIL_AMBITO("interacciones");
+
+    int total = ordenar(nube);
+    for (int s = 0; s < total; s++) {
+        ax[s] = ay[s] = 0.0f;
+    }
+
+    // Sin periodicidad, un umbral inalcanzable deja las distancias como están
+    // y el bucle interno no necesita una rama aparte
+    const float anchoX = anchoMundo, altoY = altoMundo;
+    float medioX = periodico ? anchoX / 2.0f : 1e30f;
+    float medioY = periodico ? altoY / 2.0f : 1e30f;
+    int vec[9];
+
+    for (int cy = 0; cy < celdasY; cy++) {
+        for (int cx = 0; cx < celdasX; cx++) {
+            int c = cy * celdasX + cx;
+            int numVecinas = vecinas(cx, cy, vec);
+
+            for (int a = 0; a < numTipos; a++) {
+                for (int s = inicio[c * numTipos + a]; s < inicio[c * numTipos + a + 1]; s++) {
+                    float xs = x[s], ys = y[s];
+                    float fx = 0, fy = 0;
+
+                    for (int v = 0; v < numVecinas; v++) {
+                        for (int b = 0; b < numTipos; b++) {
+                            int desde = inicio[vec[v] * numTipos + b];
+                            int hasta = inicio[vec[v] * numTipos + b + 1];
+                            float f = fuerza[a * numTipos + b];
+                            float invAlcance = 1.0f / alcance[a * numTipos + b];
+
+                            // Bloque contiguo con coeficientes fijos: sin
+                            // saltos, sólo selecciones, para que vectorice
+                            for (int k = desde; k < hasta; k++) {
+                                float dx = x[k] - xs;
+                                float dy = y[k] - ys;
+                                dx = (dx > medioX) ? dx - anchoX : ((dx < -medioX) ? dx + anchoX : dx);
+                                dy = (dy > medioY) ? dy - altoY : ((dy < -medioY) ? dy + altoY : dy);
+                                float d = std::sqrt(dx * dx + dy * dy);
+                                float r = d * invAlcance;
+                                float rep = r / BETA_REPULSION - 1.0f;
+                                float atr = f * (1.0f - std::fabs(2.0f * r - 1.0f - BETA_REPULSION) / (1.0f - BETA_REPULSION));
+                                float g = (r < BETA_REPULSION) ? rep : atr;
+                                g = (r < 1.0f && d > 0.0f) ? g / (d + 1e-6f) : 0.0f;
+                                fx += dx * g;
+                                fy += dy * g;
+                            }
+                        }
+                    }
+                    ax[s] = fx;
+                    ay[s] = fy;
+                }
+            }
+        }
+    }
+
+    // Las partículas fuera de la matriz no reciben fuerza
+    if (!acumular) {
+        for (int i = 0; i < nube.getUtiles(); i++) {
+            if (clave[i] == -1) nube.obtener(i).setAcel(Vector2D(0.0f, 0.0f));
+        }
+    }
+
+    for (int s = 0; s < total; s++) {
+        Particula& p = nube.obtener(orden[s]);
+        float bx = escala * ax[s] - rozamiento * p.getVeloc().getX();
+        float by = escala * ay[s] - rozamiento * p.getVeloc().getY();
+        if (acumular) {
+            bx += p.getAcel().getX();
+            by += p.getAcel().getY();
+        }
+        float mod2 = bx * bx + by * by;
+        if (mod2 > MAX_ACC * MAX_ACC) {
+            float k = MAX_ACC / std::sqrt(mod2);
+            bx *= k;
+            by *= k;
+        }
+        p.setAcel(Vector2D(bx, by));
+    }
+}
@@ -0,0 +1,156 @@
+#include "LotesColisiones.h"
+#include "Colision.h"
+#include "PoolTrabajo.h"
+#include <cmath>
+
+LotesColisiones::LotesColisiones()
+    : parI(nullptr), parJ(nullptr), lote(nullptr), numPares(0), capacidadPares(0),
+      orden(nullptr), inicio(nullptr), numLotes(0), capacidadLotes(0),
+      ultimo(nullptr), capacidadUltimo(0), bytesReservados(0) {}
+
+LotesColisiones::~LotesColisiones() {
+    delete[] parI;
+    delete[] parJ;
+    delete[] lote;
+    delete[] orden;
+    delete[] inicio;
+    delete[] ultimo;
+}
+
+/**
+ * Busca en paralelo los pares que se solapan. La fila i tiene n - 1 - i
+ * candidatas, así que los tramos de filas no son iguales sino de igual
+ * trabajo: el hilo h empieza en n * (1 - sqrt(1 - h / hilos))
+ * @param x Centros X (por columnas)
+ * @param y Centros Y
+ * @param r Radios
+ * @param n Número de círculos
+ * @param pool Hilos
+ */
+void LotesColisiones::detectar(const Escalar* x, const Escalar* y, const Escalar* r, int n, PoolTrabajo& pool) {
+    int numHilos = pool.getNumHilos();
+    hilos.preparar(numHilos);
+
+    pool.enCadaHilo([&](int h) {
+        int desde = (int)(n * (1.0 - std::sqrt(1.0 - (double)h / numHilos)));
+        int hasta = (h + 1 == numHilos) ? n : (int)(n * (1.0 - std::sqrt(1.0 - (double)(h + 1) / numHilos)));
+        hilos.vaciar(h);
+        for (int i = desde; i < hasta; i++) {
+            for (int j0 = i + 1; j0 < n; j0 += TAM_BLOQUE_COLISION) {
+                int m = (n - j0 < TAM_BLOQUE_COLISION) ? n - j0 : TAM_BLOQUE_COLISION;
+                unsigned mascara = colisionesBloque(x[i], y[i], r[i], x + j0, y + j0, r + j0, m);
+                while (mascara != 0) {
+                    hilos.agregar(h, i, j0 + __builtin_ctz(mascara));
+                    mascara &= mascara - 1;
+                }
+            }
+        }
+    });
+
+    // Concatenar en orden de hilo = orden serie
+    numPares = hilos.total();
+    reservarPares();
+    hilos.concatenar(parI, parJ);
+}
+
+void LotesColisiones::reservarPares() {
+    if (numPares > capacidadPares) {
+        delete[] parI;
+        delete[] parJ;
+        delete[] lote;
+        delete[] orden;
+        capacidadPares = numPares;
+        parI = new int[capacidadPares];
+        parJ = new int[capacidadPares];
+        lote = new int[capacidadPares];
+        orden = new int[capacidadPares];
+        bytesReservados += (long)capacidadPares * 4 * sizeof(int);
+    }
+}
+
+void LotesColisiones::cargar(const int* i, const int* j, int n) {
+    numPares = n;
+    reservarPares();
+    for (int k = 0; k < n; k++) {
+        parI[k] = i[k];
+        parJ[k] = j[k];
+    }
+}
+
+/**
+ * Colorea los pares en orden serie (lote = 1 + el mayor último lote de sus
+ * dos partículas) y los ordena por lote con una ordenación por cuentas
+ * @param n Número de partículas
+ */
+void LotesColisiones::repartir(int n) {
+    if (n > capacidadUltimo) {
+        delete[] ultimo;
+        capacidadUltimo = n;
+        ultimo = new int[capacidadUltimo];
+        bytesReservados += (long)capacidadUltimo * sizeof(int);
+    }
+    for (int i = 0; i < n; i++) {
+        ultimo[i] = -1;
+    }
+
+    numLotes = 0;
+    for (int k = 0; k < numPares; k++) {
+        int a = ultimo[parI[k]], b = ultimo[parJ[k]];
+        int l = ((a > b) ? a : b) + 1;
+        lote[k] = l;
+        ultimo[parI[k]] = ultimo[parJ[k]] = l;
+        if (l + 1 > numLotes) numLotes = l + 1;
+    }
+
+    if (numLotes + 1 > capacidadLotes) {
+        delete[] inicio;
+        capacidadLotes = numLotes + 1;
+        inicio = new int[capacidadLotes];
+        bytesReservados += (long)capacidadLotes * sizeof(int);
+    }
+    for (int l = 0; l <= numLotes; l++) {
+        inicio[l] = 0;
+    }
+    for (int k = 0; k < numPares; k++) {
+        inicio[lote[k] + 1]++;
+    }
+    for (int l = 0; l < numLotes; l++) {
+        inicio[l + 1] += inicio[l];
+    }
+    // inicio[l] hace de cursor y luego se restaura
+    for (int k = 0; k < numPares; k++) {
+        orden[inicio[lote[k]]++] = k;
+    }
+    for (int l = numLotes; l > 0; l--) {
+        inicio[l] = inicio[l - 1];
+    }
+    inicio[0] = 0;
+}
+
+int LotesColisiones::getPares() const {
+    return numPares;
+}
+
+int LotesColisiones::getLotes() const {
+    return numLotes;
+}
+
+int LotesColisiones::inicioLote(int l) const {
+    return inicio[l];
+}
+
+int LotesColisiones::finLote(int l) const {
+    return inicio[l + 1];
+}
+
+int LotesColisiones::getI(int k) const {
+    return parI[orden[k]];
+}
+
+int LotesColisiones::getJ(int k) const {
+    return parJ[orden[k]];
+}
+
+long LotesColisiones::getBytesReservados() const {
+    return bytesReservados + hilos.getBytesReservados();
+}
@@ -0,0 +1,140 @@
+#include "Memoria.h"
+#include <cstdint>
+#include <fstream>
+#include <new>
+#include <sched.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/**
+ * Reserva memoria sin inicializar. Los arrays grandes se proyectan con mmap
+ * (sus páginas no existen hasta que alguien las escribe) alineados a página
+ * enorme, para que el núcleo pueda usar páginas de 2 MB y ahorrar fallos
+ * de TLB
+ * @param bytes Bytes a reservar
+ * @return Memoria reservada
+ */
+void* reservarPaginas(size_t bytes) {
+    if (bytes < TAM_PAGINA_ENORME) {
+        return ::operator new(bytes);
+    }
+
+    // Se proyecta una página enorme de más y se recortan los extremos
+    size_t tam = (bytes + TAM_PAGINA_ENORME - 1) / TAM_PAGINA_ENORME * TAM_PAGINA_ENORME;
+    size_t total = tam + TAM_PAGINA_ENORME;
+    void* p = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    uintptr_t base = reinterpret_cast<uintptr_t>(p);
+    uintptr_t alineada = (base + TAM_PAGINA_ENORME - 1) / TAM_PAGINA_ENORME * TAM_PAGINA_ENORME;
+    if (alineada > base) {
+        munmap(p, alineada - base);
+    }
+    size_t sobra = (base + total) - (alineada + tam);
+    if (sobra > 0) {
+        munmap(reinterpret_cast<void*>(alineada + tam), sobra);
+    }
+
+#ifdef MADV_HUGEPAGE
+    // Sólo es una preferencia: sin páginas enormes se usan las normales
+    madvise(reinterpret_cast<void*>(alineada), tam, MADV_HUGEPAGE);
+#endif
+    return reinterpret_cast<void*>(alineada);
+}
+
+/**
+ * Libera memoria de reservarPaginas()
+ * @param p Memoria (puede ser nullptr)
+ * @param bytes Los mismos bytes que se pidieron al reservarla
+ */
+void liberarPaginas(void* p, size_t bytes) {
+    if (p == nullptr) {
+        return;
+    }
+    if (bytes < TAM_PAGINA_ENORME) {
+        ::operator delete(p);
+        return;
+    }
+    size_t tam = (bytes + TAM_PAGINA_ENORME - 1) / TAM_PAGINA_ENORME * TAM_PAGINA_ENORME;
+    munmap(p, tam);
+}
+
+/**
+ * Número de nodos NUMA: nodos consecutivos presentes en /sys
+ */
+int numNodos() {
+    int n = 0;
+    while (std::ifstream("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist").good()) {
+        n++;
+    }
+    return (n > 0) ? n : 1;
+}
+
+/**
+ * CPU de un nodo, leídas de su cpulist (p.ej. "0-7,16-23"). Sin
+ * información de topología, el nodo 0 tiene todas las CPU
+ * @param nodo Nodo
+ * @param cpus Salida
+ * @param max Tamaño de cpus
+ * @return Número de CPU del nodo (como mucho max)
+ */
+int cpusDeNodo(int nodo, int* cpus, int max) {
+    std::ifstream is("/sys/devices/system/node/node" + std::to_string(nodo) + "/cpulist");
+    int n = 0;
+    if (!is.good()) {
+        if (nodo != 0) return 0;
+        long total = sysconf(_SC_NPROCESSORS_ONLN);
+        for (int c = 0; c < total && n < max; c++) {
+            cpus[n++] = c;
+        }
+        return n;
+    }
+
+    std::string lista;
+    std::getline(is, lista);
+    size_t i = 0;
+    while (i < lista.size() && n < max) {
+        size_t fin = lista.find(',', i);
+        if (fin == std::string::npos) fin = lista.size();
+        std::string rango = lista.substr(i, fin - i);
+        size_t guion = rango.find('-');
+        if (!rango.empty()) {
+            int desde = std::stoi(rango.substr(0, guion));
+            int hasta = (guion == std::string::npos) ? desde : std::stoi(rango.substr(guion + 1));
+            for (int c = desde; c <= hasta && n < max; c++) {
+                cpus[n++] = c;
+            }
+        }
+        i = fin + 1;
+    }
+    return n;
+}
+
+/**
+ * Fija el hilo que llama a una CPU
+ * @return false si no se pudo
+ */
+bool fijarHilo(int cpu) {
+    cpu_set_t conjunto;
+    CPU_ZERO(&conjunto);
+    CPU_SET(cpu, &conjunto);
+    return sched_setaffinity(0, sizeof(conjunto), &conjunto) == 0;
+}
+
+/**
+ * Nodo NUMA de la página de una dirección, con get_mempolicy (sin libnuma)
+ * @return Nodo, o -1 si no se sabe
+ */
+int nodoDeDireccion(const void* p) {
+#ifdef SYS_get_mempolicy
+    const unsigned long MPOL_F_NODE = 1, MPOL_F_ADDR = 2;
+    int nodo = -1;
+    if (syscall(SYS_get_mempolicy, &nodo, nullptr, 0, p, MPOL_F_NODE | MPOL_F_ADDR) == 0) {
+        return nodo;
+    }
+#endif
+    return -1;
+}
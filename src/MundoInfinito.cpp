@@ -0,0 +1,469 @@
+#include "MundoInfinito.h"
+#include "Perfilador.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+// Columnas de 4 bytes por partícula al serializar: pos, veloc, acel (x e y),
+// radio, tipo y vida
+const int COLUMNAS_TROZO = 9;
+
+/**
+ * Comprime con RLE por bytes (PackBits). Cada bloque empieza con un byte de
+ * control: 0..127 son 1..128 bytes literales a continuación y 128..255 son
+ * 3..130 repeticiones del byte siguiente
+ * @param entrada Datos
+ * @param n Bytes de entrada
+ * @param salida Destino (como mínimo n + n/128 + 1 bytes)
+ * @return Bytes escritos
+ */
+static int comprimirRLE(const unsigned char* entrada, int n, unsigned char* salida) {
+    int i = 0, o = 0;
+    while (i < n) {
+        int rep = 1;
+        while (i + rep < n && rep < 130 && entrada[i + rep] == entrada[i]) {
+            rep++;
+        }
+        if (rep >= 3) {
+            salida[o++] = (unsigned char)(rep + 125);
+            salida[o++] = entrada[i];
+            i += rep;
+            continue;
+        }
+
+        // Literales hasta la siguiente racha de 3 iguales (o 128 bytes)
+        int inicio = i, literales = 0;
+        while (i < n && literales < 128) {
+            if (i + 2 < n && entrada[i] == entrada[i + 1] && entrada[i] == entrada[i + 2]) {
+                break;
+            }
+            i++;
+            literales++;
+        }
+        salida[o++] = (unsigned char)(literales - 1);
+        std::memcpy(salida + o, entrada + inicio, literales);
+        o += literales;
+    }
+    return o;
+}
+
+/**
+ * Descomprime datos de comprimirRLE
+ * @param entrada Datos comprimidos
+ * @param tam Bytes comprimidos
+ * @param salida Destino
+ * @param n Bytes esperados
+ * @return false si los datos no dan exactamente n bytes
+ */
+static bool descomprimirRLE(const unsigned char* entrada, int tam, unsigned char* salida, int n) {
+    int i = 0, o = 0;
+    while (i < tam) {
+        int control = entrada[i++];
+        if (control < 128) {
+            int literales = control + 1;
+            if (i + literales > tam || o + literales > n) return false;
+            std::memcpy(salida + o, entrada + i, literales);
+            i += literales;
+            o += literales;
+        } else {
+            int rep = control - 125;
+            if (i >= tam || o + rep > n) return false;
+            std::memset(salida + o, entrada[i++], rep);
+            o += rep;
+        }
+    }
+    return o == n;
+}
+
+MundoInfinito::MundoInfinito(float lado, int radioActivo, Almacen almacen, const std::string& directorio)
+    : lado(lado), radioActivo(radioActivo > 0 ? radioActivo : 0), almacen(almacen),
+      directorio(directorio), mundoTrozo(lado, lado),
+      trozos(nullptr), capacidadTrozos(0), numTrozos(0),
+      crudo(nullptr), comprimido(nullptr), capacidadBuffers(0),
+      pasos(0), cargas(0), descargas(0) {
+    capacidadTabla = 64;
+    tabla = new int[capacidadTabla];
+    for (int k = 0; k < capacidadTabla; k++) {
+        tabla[k] = -1;
+    }
+}
+
+MundoInfinito::~MundoInfinito() {
+    for (int t = 0; t < numTrozos; t++) {
+        delete trozos[t].particulas;
+        delete[] trozos[t].datos;
+        ::operator delete(trozos[t].pendientes);
+        if (almacen == DISCO && trozos[t].particulas == nullptr && trozos[t].tamDatos > 0) {
+            std::remove(rutaTrozo(trozos[t].cx, trozos[t].cy).c_str());
+        }
+    }
+    delete[] trozos;
+    delete[] tabla;
+    delete[] crudo;
+    delete[] comprimido;
+}
+
+/**
+ * Posición de un trozo en la tabla hash (sondeo lineal)
+ */
+int MundoInfinito::buscarHueco(int cx, int cy) const {
+    unsigned h = ((unsigned)cx * 73856093u) ^ ((unsigned)cy * 19349663u);
+    int mascara = capacidadTabla - 1;
+    int k = (int)(h & mascara);
+    while (tabla[k] != -1 && (trozos[tabla[k]].cx != cx || trozos[tabla[k]].cy != cy)) {
+        k = (k + 1) & mascara;
+    }
+    return k;
+}
+
+/**
+ * Duplica la tabla hash y recoloca los trozos
+ */
+void MundoInfinito::ampliarTabla() {
+    delete[] tabla;
+    capacidadTabla *= 2;
+    tabla = new int[capacidadTabla];
+    for (int k = 0; k < capacidadTabla; k++) {
+        tabla[k] = -1;
+    }
+    for (int t = 0; t < numTrozos; t++) {
+        tabla[buscarHueco(trozos[t].cx, trozos[t].cy)] = t;
+    }
+}
+
+/**
+ * Índice del trozo de unas coordenadas, creándolo vacío si no existe
+ */
+int MundoInfinito::obtenerTrozo(int cx, int cy) {
+    int k = buscarHueco(cx, cy);
+    if (tabla[k] != -1) {
+        return tabla[k];
+    }
+
+    if (numTrozos >= capacidadTrozos) {
+        int nuevaCapacidad = (capacidadTrozos > 0) ? 2 * capacidadTrozos : 16;
+        Trozo* nuevos = new Trozo[nuevaCapacidad];
+        for (int t = 0; t < numTrozos; t++) {
+            nuevos[t] = trozos[t];
+        }
+        delete[] trozos;
+        trozos = nuevos;
+        capacidadTrozos = nuevaCapacidad;
+    }
+
+    Trozo& nuevo = trozos[numTrozos];
+    nuevo.cx = cx;
+    nuevo.cy = cy;
+    nuevo.particulas = new ConjuntoParticulas(0, mundoTrozo);
+    nuevo.datos = nullptr;
+    nuevo.tamDatos = 0;
+    nuevo.numParticulas = 0;
+    nuevo.pendientes = nullptr;
+    nuevo.numPendientes = 0;
+    nuevo.capacidadPendientes = 0;
+    tabla[k] = numTrozos++;
+
+    // Carga máxima de la tabla: 1/2
+    if (2 * numTrozos > capacidadTabla) {
+        ampliarTabla();
+    }
+    return numTrozos - 1;
+}
+
+/**
+ * Asegura que los buffers de serialización tienen sitio para n bytes
+ */
+void MundoInfinito::reservarBuffers(int n) {
+    int necesaria = n + n / 128 + 16;
+    if (necesaria > capacidadBuffers) {
+        delete[] crudo;
+        delete[] comprimido;
+        capacidadBuffers = necesaria;
+        crudo = new unsigned char[capacidadBuffers];
+        comprimido = new unsigned char[capacidadBuffers];
+    }
+}
+
+std::string MundoInfinito::rutaTrozo(int cx, int cy) const {
+    return directorio + "/trozo_" + std::to_string(cx) + "_" + std::to_string(cy) + ".bin";
+}
+
+/**
+ * Serializa, comprime y guarda un trozo. Las partículas se escriben por
+ * columnas y con los bytes de cada valor separados en planos (primero el
+ * byte 0 de todos los valores, luego el 1...): radios, tipos, vidas y los
+ * bytes altos de las coordenadas se repiten mucho y el RLE los reduce.
+ * Si no se puede escribir el fichero, el trozo sigue activo
+ * @param t Índice del trozo
+ */
+void MundoInfinito::guardar(int t) {
+    ConjuntoParticulas* nube = trozos[t].particulas;
+    int n = nube->getUtiles();
+    int tamCrudo = n * COLUMNAS_TROZO * 4;
+    reservarBuffers(tamCrudo);
+
+    for (int i = 0; i < n; i++) {
+        const Particula& p = nube->obtener(i);
+        float campos[COLUMNAS_TROZO - 2] = {
+            p.getPos().getX(), p.getPos().getY(), p.getVeloc().getX(), p.getVeloc().getY(),
+            p.getAcel().getX(), p.getAcel().getY(), p.getRadio()
+        };
+        unsigned valores[COLUMNAS_TROZO];
+        std::memcpy(valores, campos, sizeof(campos));
+        int tipo = p.getTipo(), vida = p.getVida();
+        std::memcpy(&valores[COLUMNAS_TROZO - 2], &tipo, 4);
+        std::memcpy(&valores[COLUMNAS_TROZO - 1], &vida, 4);
+
+        for (int c = 0; c < COLUMNAS_TROZO; c++) {
+            for (int b = 0; b < 4; b++) {
+                crudo[(size_t)(c * 4 + b) * n + i] = (unsigned char)(valores[c] >> (8 * b));
+            }
+        }
+    }
+    int tam = comprimirRLE(crudo, tamCrudo, comprimido);
+
+    if (almacen == DISCO) {
+        if (n > 0) {
+            std::ofstream os(rutaTrozo(trozos[t].cx, trozos[t].cy), std::ios::binary);
+            os.write(reinterpret_cast<const char*>(comprimido), tam);
+            if (!os.good()) return;
+        }
+    } else {
+        trozos[t].datos = new unsigned char[tam > 0 ? tam : 1];
+        std::memcpy(trozos[t].datos, comprimido, tam);
+    }
+
+    trozos[t].tamDatos = tam;
+    trozos[t].numParticulas = n;
+    delete nube;
+    trozos[t].particulas = nullptr;
+    descargas++;
+}
+
+/**
+ * Recupera las partículas de un trozo guardado. Si los datos no se pueden
+ * leer (p.ej. alguien borró el fichero) el trozo vuelve vacío
+ * @param t Índice del trozo
+ */
+void MundoInfinito::cargar(int t) {
+    int n = trozos[t].numParticulas;
+    int tamCrudo = n * COLUMNAS_TROZO * 4;
+    int tam = trozos[t].tamDatos;
+    reservarBuffers(tamCrudo > tam ? tamCrudo : tam);
+
+    bool leido = true;
+    if (almacen == DISCO) {
+        if (n > 0) {
+            std::string ruta = rutaTrozo(trozos[t].cx, trozos[t].cy);
+            std::ifstream is(ruta, std::ios::binary);
+            is.read(reinterpret_cast<char*>(comprimido), tam);
+            leido = is.gcount() == tam;
+            is.close();
+            std::remove(ruta.c_str());
+        }
+    } else {
+        std::memcpy(comprimido, trozos[t].datos, tam);
+        delete[] trozos[t].datos;
+        trozos[t].datos = nullptr;
+    }
+    if (!leido || !descomprimirRLE(comprimido, tam, crudo, tamCrudo)) {
+        n = 0;
+    }
+
+    ConjuntoParticulas* nube = new ConjuntoParticulas(0, mundoTrozo);
+    nube->reservar(n);
+    for (int i = 0; i < n; i++) {
+        unsigned valores[COLUMNAS_TROZO];
+        for (int c = 0; c < COLUMNAS_TROZO; c++) {
+            valores[c] = 0;
+            for (int b = 0; b < 4; b++) {
+                valores[c] |= (unsigned)crudo[(size_t)(c * 4 + b) * n + i] << (8 * b);
+            }
+        }
+        float campos[COLUMNAS_TROZO - 2];
+        std::memcpy(campos, valores, sizeof(campos));
+        int tipo, vida;
+        std::memcpy(&tipo, &valores[COLUMNAS_TROZO - 2], 4);
+        std::memcpy(&vida, &valores[COLUMNAS_TROZO - 1], 4);
+
+        Particula p(Vector2D(campos[0], campos[1]), Vector2D(campos[4], campos[5]),
+                    Vector2D(campos[2], campos[3]), campos[6], tipo);
+        p.setVida(vida);
+        nube->agregar(p);
+    }
+    // Las que llegaron mientras estaba guardado
+    nube->agregar(trozos[t].pendientes, trozos[t].numPendientes);
+    trozos[t].numPendientes = 0;
+
+    // La capacidad reservada no debe impedir que el trozo encoja luego
+    nube->reservar(0);
+
+    trozos[t].particulas = nube;
+    trozos[t].tamDatos = 0;
+    trozos[t].numParticulas = 0;
+    cargas++;
+}
+
+/**
+ * Deja una partícula en un trozo. Si está guardado no se recupera: la
+ * partícula espera en sus pendientes hasta la próxima carga
+ * @param t Índice del trozo
+ * @param p Partícula (en posición local)
+ */
+void MundoInfinito::depositar(int t, const Particula& p) {
+    Trozo& trozo = trozos[t];
+    if (trozo.particulas != nullptr) {
+        trozo.particulas->agregar(p);
+        return;
+    }
+    if (trozo.numPendientes >= trozo.capacidadPendientes) {
+        int nuevaCapacidad = (trozo.capacidadPendientes > 0) ? 2 * trozo.capacidadPendientes : 16;
+        // Particula no se construye: se reserva sin inicializar
+        Particula* nuevas = static_cast<Particula*>(::operator new(sizeof(Particula) * nuevaCapacidad));
+        for (int i = 0; i < trozo.numPendientes; i++) {
+            nuevas[i] = trozo.pendientes[i];
+        }
+        ::operator delete(trozo.pendientes);
+        trozo.pendientes = nuevas;
+        trozo.capacidadPendientes = nuevaCapacidad;
+    }
+    trozo.pendientes[trozo.numPendientes++] = p;
+}
+
+/**
+ * Agrega una partícula en una posición global del mundo
+ * @param x Coordenada X global
+ * @param y Coordenada Y global
+ * @param part Partícula
+ */
+void MundoInfinito::agregar(double x, double y, const Particula& part) {
+    int cx = (int)std::floor(x / lado);
+    int cy = (int)std::floor(y / lado);
+    int t = obtenerTrozo(cx, cy);
+
+    Particula p = part;
+    p.setPos(Vector2D((float)(x - (double)cx * lado), (float)(y - (double)cy * lado)));
+    depositar(t, p);
+}
+
+/**
+ * Avanza un paso del mundo
+ * @param camX Coordenada X global de la cámara
+ * @param camY Coordenada Y global de la cámara
+ */
+void MundoInfinito::avanzar(double camX, double camY) {
+    PERFIL_AMBITO("mundoInfinito");
+
+    // 1) Guardar los trozos lejanos y recuperar los cercanos
+    int camCx = (int)std::floor(camX / lado);
+    int camCy = (int)std::floor(camY / lado);
+    for (int t = 0; t < numTrozos; t++) {
+        int dx = std::abs(trozos[t].cx - camCx);
+        int dy = std::abs(trozos[t].cy - camCy);
+        bool cerca = dx <= radioActivo && dy <= radioActivo;
+        if (trozos[t].particulas != nullptr && !cerca) {
+            guardar(t);
+        } else if (trozos[t].particulas == nullptr && cerca) {
+            cargar(t);
+        }
+    }
+
+    // 2) Simular los trozos activos. Las partículas se mueven sin bordes:
+    //    las que salen del trozo se reparten después
+    int activos = numTrozos;
+    for (int t = 0; t < activos; t++) {
+        ConjuntoParticulas* nube = trozos[t].particulas;
+        if (nube != nullptr) {
+            nube->mover(0);
+            nube->gestionarColisiones();
+            nube->finPaso();
+        }
+    }
+
+    // 3) Pasar a su trozo las partículas que han cruzado un borde. Los
+    //    trozos que se crean aquí no se han movido en este paso y sus
+    //    partículas nuevas ya están dentro, así que no se recorren
+    for (int t = 0; t < activos; t++) {
+        ConjuntoParticulas* nube = trozos[t].particulas;
+        if (nube == nullptr) continue;
+
+        int cx = trozos[t].cx, cy = trozos[t].cy;
+        for (int i = nube->getUtiles() - 1; i >= 0; i--) {
+            Particula p = nube->obtener(i);
+            float x = p.getPos().getX(), y = p.getPos().getY();
+            if (x >= 0 && x < lado && y >= 0 && y < lado) continue;
+
+            int dcx = (int)std::floor(x / lado);
+            int dcy = (int)std::floor(y / lado);
+            nube->borrar(i);
+
+            int destino = obtenerTrozo(cx + dcx, cy + dcy);
+            // El resto puede quedar en lado por redondeo: se recorta
+            float lx = x - dcx * lado, ly = y - dcy * lado;
+            if (lx >= lado) lx = std::nextafter(lado, 0.0f);
+            if (ly >= lado) ly = std::nextafter(lado, 0.0f);
+            if (lx < 0) lx = 0;
+            if (ly < 0) ly = 0;
+            p.setPos(Vector2D(lx, ly));
+            depositar(destino, p);
+        }
+    }
+    pasos++;
+}
+
+const ConjuntoParticulas* MundoInfinito::trozo(int cx, int cy) const {
+    int t = tabla[buscarHueco(cx, cy)];
+    return (t == -1) ? nullptr : trozos[t].particulas;
+}
+
+float MundoInfinito::getLado() const {
+    return lado;
+}
+
+int MundoInfinito::getTrozos() const {
+    return numTrozos;
+}
+
+int MundoInfinito::getTrozosActivos() const {
+    int activos = 0;
+    for (int t = 0; t < numTrozos; t++) {
+        if (trozos[t].particulas != nullptr) activos++;
+    }
+    return activos;
+}
+
+long MundoInfinito::getParticulas() const {
+    long total = 0;
+    for (int t = 0; t < numTrozos; t++) {
+        total += (trozos[t].particulas != nullptr) ? trozos[t].particulas->getUtiles()
+                                                   : trozos[t].numParticulas + trozos[t].numPendientes;
+    }
+    return total;
+}
+
+long MundoInfinito::getBytesActivos() const {
+    long total = 0;
+    for (int t = 0; t < numTrozos; t++) {
+        if (trozos[t].particulas != nullptr) {
+            total += (long)trozos[t].particulas->getCapacidad() * sizeof(Particula);
+        }
+    }
+    return total;
+}
+
+long MundoInfinito::getBytesGuardados() const {
+    long total = 0;
+    for (int t = 0; t < numTrozos; t++) {
+        if (trozos[t].particulas == nullptr) total += trozos[t].tamDatos;
+    }
+    return total;
+}
+
+long MundoInfinito::getCargas() const {
+    return cargas;
+}
+
+long MundoInfinito::getDescargas() const {
+    return descargas;
+}
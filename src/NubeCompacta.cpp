@@ -0,0 +1,397 @@
+#include "NubeCompacta.h"
+#include "Flotante16.h"
+#include "RejillaOrdenada.h"
+#include "PoolTrabajo.h"
+#include "Perfilador.h"
+#include <algorithm>
+
+#if defined(__AVX2__) && defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+// Último código de posición
+const float MAX_CODIGO = 65535.0f;
+
+// Partículas por bloque del núcleo vectorial
+const int BLOQUE_COMPACTA = 8;
+
+/**
+ * Mezcla los bits de un entero de 32 bits (lowbias32)
+ */
+static inline uint32_t mezclar(uint32_t x) {
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+#if defined(__AVX2__) && defined(__F16C__)
+// Las mismas operaciones que el bucle escalar, de 8 en 8 y en el mismo orden
+
+static inline __m256i mezclar8(__m256i x) {
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32(0x7FEB352D));
+    x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 15));
+    x = _mm256_mullo_epi32(x, _mm256_set1_epi32((int)0x846CA68Bu));
+    return _mm256_xor_si256(x, _mm256_srli_epi32(x, 16));
+}
+
+/**
+ * Los 16 bits bajos de 8 enteros (que caben en 16 bits sin signo)
+ */
+static inline __m128i empaquetar16(__m256i c) {
+    __m256i p = _mm256_packus_epi32(c, c);
+    return _mm256_castsi256_si128(_mm256_permute4x64_epi64(p, 0x08));
+}
+
+static inline __m256 decodificar8(const uint16_t* codigos, __m256 origen, __m256 paso) {
+    __m256i c = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)codigos));
+    return _mm256_add_ps(origen, _mm256_mul_ps(_mm256_cvtepi32_ps(c), paso));
+}
+
+static inline __m128i codificar8(__m256 v, __m256 origen, __m256 escala, __m256 azar) {
+    __m256 q = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(v, origen), escala), azar);
+    q = _mm256_min_ps(_mm256_max_ps(q, _mm256_setzero_ps()), _mm256_set1_ps(MAX_CODIGO));
+    return empaquetar16(_mm256_cvttps_epi32(q));
+}
+
+/**
+ * aFlotante16(f, azar) de 8 en 8
+ */
+static inline __m128i aFlotante16x8(__m256 f, __m256i azar) {
+    __m256i b = _mm256_castps_si256(f);
+    __m256i absoluto = _mm256_and_si256(b, _mm256_set1_epi32(0x7FFFFFFF));
+    __m256i enRango = _mm256_andnot_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(0x38800000), absoluto),
+                                          _mm256_cmpgt_epi32(_mm256_set1_epi32(0x477FE000), absoluto));
+    __m256i h = _mm256_add_epi32(absoluto, _mm256_and_si256(azar, _mm256_set1_epi32(0x1FFF)));
+    h = _mm256_srli_epi32(_mm256_sub_epi32(h, _mm256_set1_epi32(0x38000000)), 13);
+    h = _mm256_or_si256(h, _mm256_and_si256(_mm256_srli_epi32(b, 16), _mm256_set1_epi32(0x8000)));
+    __m256i cercano = _mm256_cvtepu16_epi32(_mm256_cvtps_ph(f, _MM_FROUND_TO_NEAREST_INT));
+    return empaquetar16(_mm256_blendv_epi8(cercano, h, enRango));
+}
+
+static inline void rebotar8(__m256& x, __m256& vel, __m256 r, __m256 max) {
+    __m256 menos = _mm256_sub_ps(x, r), mas = _mm256_add_ps(x, r), cero = _mm256_setzero_ps();
+    __m256 choca = _mm256_or_ps(_mm256_cmp_ps(menos, cero, _CMP_LE_OQ), _mm256_cmp_ps(mas, max, _CMP_GE_OQ));
+    vel = _mm256_xor_ps(vel, _mm256_and_ps(choca, _mm256_set1_ps(-0.0f)));
+    x = _mm256_blendv_ps(x, _mm256_sub_ps(max, r), _mm256_cmp_ps(mas, max, _CMP_GT_OQ));
+    x = _mm256_blendv_ps(x, r, _mm256_cmp_ps(menos, cero, _CMP_LT_OQ));
+}
+
+static inline void envolver8(__m256& x, __m256 r, __m256 max) {
+    __m256 sale = _mm256_cmp_ps(_mm256_add_ps(x, r), _mm256_setzero_ps(), _CMP_LT_OQ);
+    __m256 entra = _mm256_cmp_ps(_mm256_sub_ps(x, r), max, _CMP_GT_OQ);
+    x = _mm256_blendv_ps(x, r, entra);
+    x = _mm256_blendv_ps(x, _mm256_sub_ps(max, r), sale);
+}
+#endif
+
+NubeCompacta::NubeCompacta(const ParametrosMundo& mundo)
+    : mundo(mundo), mundoFijo(mundo.esFijo()),
+      px(nullptr), py(nullptr), vx(nullptr), vy(nullptr), ax(nullptr), ay(nullptr),
+      indicesRadio(nullptr), tipos(nullptr), capacidad(0), utiles(0), pasos(0),
+      columnaX(nullptr), columnaY(nullptr), columnaR(nullptr), capacidadColumnas(0),
+      rejilla(nullptr) {
+    // Mundo ampliado en radioMax por cada lado: caben las partículas que
+    // asoman por un borde antes de rebotar o dar la vuelta
+    origenX = -mundo.radioMax;
+    origenY = -mundo.radioMax;
+    pasoX = (mundo.maxX + 2 * mundo.radioMax) / MAX_CODIGO;
+    pasoY = (mundo.maxY + 2 * mundo.radioMax) / MAX_CODIGO;
+    escalaX = 1.0f / pasoX;
+    escalaY = 1.0f / pasoY;
+
+    float rango = mundo.radioMax - mundo.radioMin;
+    escalaRadio = rango > 0 ? 255.0f / rango : 0.0f;
+    for (int k = 0; k < 256; k++) {
+        radios[k] = mundo.radioMin + rango * k / 255.0f;
+    }
+    radios[255] = mundo.radioMax;
+}
+
+NubeCompacta::NubeCompacta(const ConjuntoParticulas& conjunto) : NubeCompacta(conjunto.getMundo()) {
+    redimensionar(conjunto.getUtiles());
+    for (int i = 0; i < conjunto.getUtiles(); i++) {
+        agregar(conjunto.obtener(i));
+    }
+}
+
+NubeCompacta::~NubeCompacta() {
+    delete[] px;
+    delete[] py;
+    delete[] vx;
+    delete[] vy;
+    delete[] ax;
+    delete[] ay;
+    delete[] indicesRadio;
+    delete[] tipos;
+    delete[] columnaX;
+    delete[] columnaY;
+    delete[] columnaR;
+    delete rejilla;
+}
+
+/**
+ * Copia una columna a un array nuevo de otro tamaño
+ */
+template <class T>
+static void crecer(T*& columna, int utiles, int nuevaCapacidad) {
+    T* nueva = new T[nuevaCapacidad];
+    for (int i = 0; i < utiles; i++) {
+        nueva[i] = columna[i];
+    }
+    delete[] columna;
+    columna = nueva;
+}
+
+void NubeCompacta::redimensionar(int nuevaCapacidad) {
+    if (nuevaCapacidad <= capacidad) {
+        return;
+    }
+    crecer(px, utiles, nuevaCapacidad);
+    crecer(py, utiles, nuevaCapacidad);
+    crecer(vx, utiles, nuevaCapacidad);
+    crecer(vy, utiles, nuevaCapacidad);
+    crecer(ax, utiles, nuevaCapacidad);
+    crecer(ay, utiles, nuevaCapacidad);
+    crecer(indicesRadio, utiles, nuevaCapacidad);
+    crecer(tipos, utiles, nuevaCapacidad);
+    capacidad = nuevaCapacidad;
+}
+
+int NubeCompacta::getUtiles() const {
+    return utiles;
+}
+
+const ParametrosMundo& NubeCompacta::getMundo() const {
+    return mundo;
+}
+
+float NubeCompacta::getPasoX() const {
+    return pasoX;
+}
+
+float NubeCompacta::getPasoY() const {
+    return pasoY;
+}
+
+/**
+ * Código de posición de v, recortado a [0, 65535]
+ */
+uint16_t NubeCompacta::codificar(float v, float origen, float escala, float azar) const {
+    float q = (v - origen) * escala + azar;
+    if (q <= 0.0f) return 0;
+    if (q >= MAX_CODIGO) return (uint16_t)MAX_CODIGO;
+    return (uint16_t)q;
+}
+
+/**
+ * Índice del radio de la tabla más cercano a r
+ */
+uint8_t NubeCompacta::indiceRadio(float r) const {
+    float q = (r - mundo.radioMin) * escalaRadio + 0.5f;
+    if (q <= 0.0f) return 0;
+    if (q >= 255.0f) return 255;
+    return (uint8_t)q;
+}
+
+void NubeCompacta::agregar(const Particula& p) {
+    if (utiles >= capacidad) {
+        redimensionar(capacidad > 0 ? 2 * capacidad : 64);
+    }
+    utiles++;
+    reemplazar(utiles - 1, p);
+}
+
+Particula NubeCompacta::obtener(int i) const {
+    Vector2D pos(origenX + px[i] * pasoX, origenY + py[i] * pasoY);
+    Vector2D acel(deFlotante16(ax[i]), deFlotante16(ay[i]));
+    Vector2D veloc(deFlotante16(vx[i]), deFlotante16(vy[i]));
+    return Particula(pos, acel, veloc, radios[indicesRadio[i]], tipos[i]);
+}
+
+void NubeCompacta::reemplazar(int i, const Particula& p) {
+    px[i] = codificar((float)p.getPos().getX(), origenX, escalaX, 0.5f);
+    py[i] = codificar((float)p.getPos().getY(), origenY, escalaY, 0.5f);
+    vx[i] = aFlotante16((float)p.getVeloc().getX());
+    vy[i] = aFlotante16((float)p.getVeloc().getY());
+    ax[i] = aFlotante16((float)p.getAcel().getX());
+    ay[i] = aFlotante16((float)p.getAcel().getY());
+    indicesRadio[i] = indiceRadio((float)p.getRadio());
+    tipos[i] = (uint8_t)p.getTipo();
+}
+
+void NubeCompacta::volcar(ConjuntoParticulas& destino) const {
+    for (int i = 0; i < utiles; i++) {
+        destino.agregar(obtener(i));
+    }
+}
+
+/**
+ * Descomprime, mueve y vuelve a comprimir cada partícula del tramo, con las
+ * mismas cuentas que Particula::mover, rebotar y wrap. La aceleración no
+ * cambia, así que no se vuelve a escribir. Con AVX2 y F16C va de 8 en 8 y
+ * el resto, una a una (con los mismos resultados)
+ * @param m Mundo
+ * @param tipo Tipo de movimiento: 0 = mover, 1 = mover+rebotar, 2 = mover+wrap
+ * @param desde Primera posición
+ * @param hasta Posición siguiente a la última
+ */
+template <class Mundo>
+void NubeCompacta::moverEn(const Mundo& m, int tipo, int desde, int hasta) {
+    const float maxVel = m.maxVel, maxX = m.maxX, maxY = m.maxY;
+    const float escalaAzar = 1.0f / 4096;
+    // El azar de la partícula i en este paso: h1 para las posiciones (12
+    // bits cada una) y h2 para las velocidades (13 bits cada una)
+    const uint32_t semilla = mezclar((uint32_t)pasos * 0x9E3779B9u);
+    int i = desde;
+#if defined(__AVX2__) && defined(__F16C__)
+    const __m256 origenX8 = _mm256_set1_ps(origenX), origenY8 = _mm256_set1_ps(origenY);
+    const __m256 pasoX8 = _mm256_set1_ps(pasoX), pasoY8 = _mm256_set1_ps(pasoY);
+    const __m256 escalaX8 = _mm256_set1_ps(escalaX), escalaY8 = _mm256_set1_ps(escalaY);
+    const __m256 maxVel8 = _mm256_set1_ps(maxVel), menosMaxVel8 = _mm256_set1_ps(-maxVel);
+    const __m256 maxX8 = _mm256_set1_ps(maxX), maxY8 = _mm256_set1_ps(maxY);
+    const __m256 escalaAzar8 = _mm256_set1_ps(escalaAzar);
+    const __m256i mascaraAzar = _mm256_set1_epi32(0xFFF);
+    const __m256i carriles = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (; i + BLOQUE_COMPACTA <= hasta; i += BLOQUE_COMPACTA) {
+        __m256 x = decodificar8(px + i, origenX8, pasoX8);
+        __m256 y = decodificar8(py + i, origenY8, pasoY8);
+        __m256 velX = _mm256_add_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(vx + i))),
+                                    _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(ax + i))));
+        __m256 velY = _mm256_add_ps(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(vy + i))),
+                                    _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(ay + i))));
+        velX = _mm256_min_ps(_mm256_max_ps(velX, menosMaxVel8), maxVel8);
+        velY = _mm256_min_ps(_mm256_max_ps(velY, menosMaxVel8), maxVel8);
+        x = _mm256_add_ps(x, velX);
+        y = _mm256_add_ps(y, velY);
+
+        __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(indicesRadio + i)));
+        __m256 r = _mm256_i32gather_ps(radios, indices, 4);
+        if (tipo == 1) {
+            rebotar8(x, velX, r, maxX8);
+            rebotar8(y, velY, r, maxY8);
+        } else if (tipo == 2) {
+            envolver8(x, r, maxX8);
+            envolver8(y, r, maxY8);
+        }
+
+        __m256i h1 = mezclar8(_mm256_xor_si256(_mm256_add_epi32(_mm256_set1_epi32(i), carriles),
+                                               _mm256_set1_epi32((int)semilla)));
+        __m256i h2 = mezclar8(h1);
+        __m256 azarX = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(h1, mascaraAzar)), escalaAzar8);
+        __m256 azarY = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(h1, 12), mascaraAzar)), escalaAzar8);
+        _mm_storeu_si128((__m128i*)(px + i), codificar8(x, origenX8, escalaX8, azarX));
+        _mm_storeu_si128((__m128i*)(py + i), codificar8(y, origenY8, escalaY8, azarY));
+        _mm_storeu_si128((__m128i*)(vx + i), aFlotante16x8(velX, h2));
+        _mm_storeu_si128((__m128i*)(vy + i), aFlotante16x8(velY, _mm256_srli_epi32(h2, 16)));
+    }
+#endif
+    for (; i < hasta; i++) {
+        float x = origenX + px[i] * pasoX;
+        float y = origenY + py[i] * pasoY;
+        float velX = deFlotante16(vx[i]) + deFlotante16(ax[i]);
+        float velY = deFlotante16(vy[i]) + deFlotante16(ay[i]);
+        velX = std::min(std::max(velX, -maxVel), maxVel);
+        velY = std::min(std::max(velY, -maxVel), maxVel);
+        x += velX;
+        y += velY;
+
+        float r = radios[indicesRadio[i]];
+        if (tipo == 1) {
+            if (x - r <= 0 || x + r >= maxX) {
+                velX = -velX;
+                if (x - r < 0) x = r;
+                else if (x + r > maxX) x = maxX - r;
+            }
+            if (y - r <= 0 || y + r >= maxY) {
+                velY = -velY;
+                if (y - r < 0) y = r;
+                else if (y + r > maxY) y = maxY - r;
+            }
+        } else if (tipo == 2) {
+            if (x + r < 0) x = maxX - r;
+            else if (x - r > maxX) x = r;
+            if (y + r < 0) y = maxY - r;
+            else if (y - r > maxY) y = r;
+        }
+
+        uint32_t h1 = mezclar((uint32_t)i ^ semilla);
+        uint32_t h2 = mezclar(h1);
+        px[i] = codificar(x, origenX, escalaX, (h1 & 0xFFF) * escalaAzar);
+        py[i] = codificar(y, origenY, escalaY, ((h1 >> 12) & 0xFFF) * escalaAzar);
+        vx[i] = aFlotante16(velX, h2);
+        vy[i] = aFlotante16(velY, h2 >> 16);
+    }
+}
+
+void NubeCompacta::mover(int tipo) {
+    PERFIL_AMBITO("mover");
+
+    if (mundoFijo) {
+        moverEn(MundoFijo(), tipo, 0, utiles);
+    } else {
+        moverEn(mundo, tipo, 0, utiles);
+    }
+    pasos++;
+}
+
+void NubeCompacta::moverParalelo(PoolTrabajo& pool, int tipo) {
+    PERFIL_AMBITO("mover");
+
+    // Tramos en múltiplos del bloque: cada partícula pasa por el mismo
+    // código que en serie
+    pool.enCadaHilo([&](int h) {
+        int numHilos = pool.getNumHilos();
+        int desde = (int)((long)utiles * h / numHilos) / BLOQUE_COMPACTA * BLOQUE_COMPACTA;
+        int hasta = (h == numHilos - 1) ? utiles
+                  : (int)((long)utiles * (h + 1) / numHilos) / BLOQUE_COMPACTA * BLOQUE_COMPACTA;
+        if (mundoFijo) {
+            moverEn(MundoFijo(), tipo, desde, hasta);
+        } else {
+            moverEn(mundo, tipo, desde, hasta);
+        }
+    });
+    pasos++;
+}
+
+/**
+ * Descomprime posiciones y radios en columnas, busca los pares con la
+ * rejilla y los resuelve en orden intercambiando velocidades y
+ * aceleraciones comprimidas (como Particula::choque)
+ * @param pool Hilos para buscar los pares (nullptr = en este hilo)
+ * @return Número de colisiones
+ */
+int NubeCompacta::gestionarColisiones(PoolTrabajo* pool) {
+    PERFIL_AMBITO("colisiones");
+
+    if (utiles > capacidadColumnas) {
+        delete[] columnaX;
+        delete[] columnaY;
+        delete[] columnaR;
+        capacidadColumnas = capacidad;
+        columnaX = new Escalar[capacidadColumnas];
+        columnaY = new Escalar[capacidadColumnas];
+        columnaR = new Escalar[capacidadColumnas];
+    }
+    for (int i = 0; i < utiles; i++) {
+        columnaX[i] = origenX + px[i] * pasoX;
+        columnaY[i] = origenY + py[i] * pasoY;
+        columnaR[i] = radios[indicesRadio[i]];
+    }
+    if (rejilla == nullptr) {
+        rejilla = new RejillaOrdenada();
+    }
+    int colisiones = rejilla->buscarPares(columnaX, columnaY, columnaR, utiles, pool);
+    for (int k = 0; k < colisiones; k++) {
+        int i = rejilla->getI(k), j = rejilla->getJ(k);
+        uint16_t t;
+        t = vx[i]; vx[i] = vx[j]; vx[j] = t;
+        t = vy[i]; vy[i] = vy[j]; vy[j] = t;
+        t = ax[i]; ax[i] = ax[j]; ax[j] = t;
+        t = ay[i]; ay[i] = ay[j]; ay[j] = t;
+    }
+    return colisiones;
+}
@@ -0,0 +1,315 @@
+#include "ObstaculosEstaticos.h"
+
+// Obstáculos por hoja como máximo (salvo que no se puedan separar)
+const int MAX_HOJA_BVH = 4;
+
+// Intervalos de centros por eje al buscar el corte
+const int INTERVALOS_SAH = 12;
+
+/**
+ * Intervalo de un centro entre INTERVALOS_SAH intervalos iguales de
+ * [cmin, cmin + extension]
+ */
+static inline int intervalo(float c, float cmin, float extension) {
+    int b = (int)((c - cmin) * (INTERVALOS_SAH / extension));
+    return b < INTERVALOS_SAH ? b : INTERVALOS_SAH - 1;
+}
+
+/**
+ * Lo mismo en coma fija, con enteros
+ */
+static inline int intervalo(Fijo c, Fijo cmin, Fijo extension) {
+    int b = (int)((int64_t)(c - cmin).getBruto() * INTERVALOS_SAH / extension.getBruto());
+    return b < INTERVALOS_SAH ? b : INTERVALOS_SAH - 1;
+}
+
+/**
+ * Valor exacto en double (los costes SAH se suman en double: son
+ * productos de enteros por valores exactos, sin redondeos)
+ */
+static inline double real(float v) {
+    return v;
+}
+
+static inline double real(Fijo v) {
+    return v.getBruto() / 65536.0;
+}
+
+/**
+ * Semiperímetro de una caja (la "superficie" de la SAH en el plano)
+ */
+static double semiperimetro(Escalar minX, Escalar minY, Escalar maxX, Escalar maxY) {
+    return real(maxX - minX) + real(maxY - minY);
+}
+
+ObstaculosEstaticos::ObstaculosEstaticos()
+    : x(nullptr), y(nullptr), radio(nullptr), capacidad(0), utiles(0),
+      nodos(nullptr), numNodos(0), capacidadNodos(0), profundidad(0) {}
+
+ObstaculosEstaticos::~ObstaculosEstaticos() {
+    delete[] x;
+    delete[] y;
+    delete[] radio;
+    delete[] nodos;
+}
+
+void ObstaculosEstaticos::redimensionar(int nuevaCapacidad) {
+    Escalar* nx = new Escalar[nuevaCapacidad];
+    Escalar* ny = new Escalar[nuevaCapacidad];
+    Escalar* nr = new Escalar[nuevaCapacidad];
+    for (int i = 0; i < utiles; i++) {
+        nx[i] = x[i];
+        ny[i] = y[i];
+        nr[i] = radio[i];
+    }
+    delete[] x;
+    delete[] y;
+    delete[] radio;
+    x = nx;
+    y = ny;
+    radio = nr;
+    capacidad = nuevaCapacidad;
+}
+
+void ObstaculosEstaticos::agregar(const Vector2D& pos, Escalar radio) {
+    if (utiles >= capacidad) {
+        redimensionar(capacidad > 0 ? 2 * capacidad : 64);
+    }
+    x[utiles] = pos.getX();
+    y[utiles] = pos.getY();
+    this->radio[utiles] = radio;
+    utiles++;
+}
+
+int ObstaculosEstaticos::getUtiles() const {
+    return utiles;
+}
+
+Vector2D ObstaculosEstaticos::getPos(int i) const {
+    return Vector2D(x[i], y[i]);
+}
+
+Escalar ObstaculosEstaticos::getRadio(int i) const {
+    return radio[i];
+}
+
+int ObstaculosEstaticos::getNodos() const {
+    return numNodos;
+}
+
+int ObstaculosEstaticos::getProfundidad() const {
+    return profundidad;
+}
+
+void ObstaculosEstaticos::intercambiar(int a, int b) {
+    Escalar t = x[a]; x[a] = x[b]; x[b] = t;
+    t = y[a]; y[a] = y[b]; y[b] = t;
+    t = radio[a]; radio[a] = radio[b]; radio[b] = t;
+}
+
+/**
+ * Caja de los obstáculos del nodo (que tiene al menos uno)
+ */
+void ObstaculosEstaticos::ajustarCaja(Nodo& nodo) const {
+    int k = nodo.primero;
+    nodo.minX = x[k] - radio[k];
+    nodo.minY = y[k] - radio[k];
+    nodo.maxX = x[k] + radio[k];
+    nodo.maxY = y[k] + radio[k];
+    for (k++; k < nodo.primero + nodo.cuenta; k++) {
+        if (x[k] - radio[k] < nodo.minX) nodo.minX = x[k] - radio[k];
+        if (y[k] - radio[k] < nodo.minY) nodo.minY = y[k] - radio[k];
+        if (x[k] + radio[k] > nodo.maxX) nodo.maxX = x[k] + radio[k];
+        if (y[k] + radio[k] > nodo.maxY) nodo.maxY = y[k] + radio[k];
+    }
+}
+
+/**
+ * Construye el árbol. Con n obstáculos hay como mucho 2n - 1 nodos
+ */
+void ObstaculosEstaticos::construir() {
+    numNodos = 0;
+    profundidad = 0;
+    if (utiles == 0) {
+        return;
+    }
+    if (2 * utiles - 1 > capacidadNodos) {
+        delete[] nodos;
+        capacidadNodos = 2 * utiles - 1;
+        nodos = new Nodo[capacidadNodos];
+    }
+    Nodo& raiz = nodos[numNodos++];
+    raiz.primero = 0;
+    raiz.cuenta = utiles;
+    ajustarCaja(raiz);
+    subdividir(0, 1);
+}
+
+/**
+ * Busca el mejor corte SAH del nodo; si partir cuesta más que la hoja (o
+ * no se puede), el nodo se queda como hoja. Si no, reparte sus obstáculos
+ * a cada lado del corte y sigue con los dos hijos
+ * @param indice Nodo
+ * @param nivel Profundidad del nodo (la raíz es 1)
+ */
+void ObstaculosEstaticos::subdividir(int indice, int nivel) {
+    if (nivel > profundidad) {
+        profundidad = nivel;
+    }
+    int primero = nodos[indice].primero;
+    int cuenta = nodos[indice].cuenta;
+    if (cuenta <= MAX_HOJA_BVH / 2 || nivel >= PROFUNDIDAD_MAX_BVH) {
+        return;
+    }
+
+    // Caja de los centros
+    Escalar cmin[2] = {x[primero], y[primero]}, cmax[2] = {x[primero], y[primero]};
+    for (int k = primero + 1; k < primero + cuenta; k++) {
+        if (x[k] < cmin[0]) cmin[0] = x[k];
+        if (x[k] > cmax[0]) cmax[0] = x[k];
+        if (y[k] < cmin[1]) cmin[1] = y[k];
+        if (y[k] > cmax[1]) cmax[1] = y[k];
+    }
+
+    // Mejor corte: eje e, entre el intervalo b - 1 y el b
+    double mejorCoste = 0;
+    int mejorEje = -1;
+    int mejorIntervalo = 0;
+    for (int e = 0; e < 2; e++) {
+        Escalar extension = cmax[e] - cmin[e];
+        if (extension <= Escalar(0)) {
+            continue;
+        }
+        const Escalar* c = (e == 0) ? x : y;
+
+        int n[INTERVALOS_SAH] = {0};
+        Escalar bminX[INTERVALOS_SAH], bminY[INTERVALOS_SAH], bmaxX[INTERVALOS_SAH], bmaxY[INTERVALOS_SAH];
+        for (int k = primero; k < primero + cuenta; k++) {
+            int b = intervalo(c[k], cmin[e], extension);
+            Escalar x0 = x[k] - radio[k], y0 = y[k] - radio[k];
+            Escalar x1 = x[k] + radio[k], y1 = y[k] + radio[k];
+            if (n[b] == 0) {
+                bminX[b] = x0; bminY[b] = y0; bmaxX[b] = x1; bmaxY[b] = y1;
+            } else {
+                if (x0 < bminX[b]) bminX[b] = x0;
+                if (y0 < bminY[b]) bminY[b] = y0;
+                if (x1 > bmaxX[b]) bmaxX[b] = x1;
+                if (y1 > bmaxY[b]) bmaxY[b] = y1;
+            }
+            n[b]++;
+        }
+
+        // Barrido desde la derecha: coste del lado derecho de cada corte
+        double costeDerecha[INTERVALOS_SAH];
+        Escalar rminX = 0, rminY = 0, rmaxX = 0, rmaxY = 0;
+        int nd = 0;
+        for (int b = INTERVALOS_SAH - 1; b > 0; b--) {
+            if (n[b] > 0) {
+                if (nd == 0) {
+                    rminX = bminX[b]; rminY = bminY[b]; rmaxX = bmaxX[b]; rmaxY = bmaxY[b];
+                } else {
+                    if (bminX[b] < rminX) rminX = bminX[b];
+                    if (bminY[b] < rminY) rminY = bminY[b];
+                    if (bmaxX[b] > rmaxX) rmaxX = bmaxX[b];
+                    if (bmaxY[b] > rmaxY) rmaxY = bmaxY[b];
+                }
+                nd += n[b];
+            }
+            costeDerecha[b] = nd * semiperimetro(rminX, rminY, rmaxX, rmaxY);
+        }
+        // Y desde la izquierda, sumando
+        Escalar lminX = 0, lminY = 0, lmaxX = 0, lmaxY = 0;
+        int ni = 0;
+        for (int b = 0; b < INTERVALOS_SAH - 1; b++) {
+            if (n[b] > 0) {
+                if (ni == 0) {
+                    lminX = bminX[b]; lminY = bminY[b]; lmaxX = bmaxX[b]; lmaxY = bmaxY[b];
+                } else {
+                    if (bminX[b] < lminX) lminX = bminX[b];
+                    if (bminY[b] < lminY) lminY = bminY[b];
+                    if (bmaxX[b] > lmaxX) lmaxX = bmaxX[b];
+                    if (bmaxY[b] > lmaxY) lmaxY = bmaxY[b];
+                }
+                ni += n[b];
+            }
+            if (ni == 0 || ni == cuenta) {
+                continue;
+            }
+            double coste = ni * semiperimetro(lminX, lminY, lmaxX, lmaxY) + costeDerecha[b + 1];
+            if (mejorEje < 0 || coste < mejorCoste) {
+                mejorCoste = coste;
+                mejorEje = e;
+                mejorIntervalo = b + 1;
+            }
+        }
+    }
+
+    // Coste de dejarlo como hoja (una prueba de caja cuesta lo que una de
+    // círculo: el corte tiene que ahorrar comparaciones)
+    const Nodo& nodo = nodos[indice];
+    double costeHoja = cuenta * semiperimetro(nodo.minX, nodo.minY, nodo.maxX, nodo.maxY);
+    if (mejorEje < 0 || (cuenta <= MAX_HOJA_BVH && mejorCoste >= costeHoja)) {
+        return;
+    }
+
+    // Reparto en el sitio: a la izquierda los de los intervalos anteriores
+    // al corte, calculados igual que arriba
+    const Escalar* c = (mejorEje == 0) ? x : y;
+    Escalar extension = cmax[mejorEje] - cmin[mejorEje];
+    int i = primero, j = primero + cuenta - 1;
+    while (i <= j) {
+        if (intervalo(c[i], cmin[mejorEje], extension) < mejorIntervalo) {
+            i++;
+        } else {
+            intercambiar(i, j);
+            j--;
+        }
+    }
+    int cuentaIzquierda = i - primero;
+    if (cuentaIzquierda == 0 || cuentaIzquierda == cuenta) {
+        return;
+    }
+
+    int hijo = numNodos;
+    numNodos += 2;
+    nodos[hijo].primero = primero;
+    nodos[hijo].cuenta = cuentaIzquierda;
+    nodos[hijo + 1].primero = i;
+    nodos[hijo + 1].cuenta = cuenta - cuentaIzquierda;
+    ajustarCaja(nodos[hijo]);
+    ajustarCaja(nodos[hijo + 1]);
+    nodos[indice].primero = hijo;
+    nodos[indice].cuenta = 0;
+
+    subdividir(hijo, nivel + 1);
+    subdividir(hijo + 1, nivel + 1);
+}
+
+/**
+ * Refleja la velocidad de la partícula respecto a la normal de cada
+ * obstáculo que toca y al que se acerca: v' = v - 2 (v·n) n
+ * @param p Partícula
+ * @return Número de rebotes
+ */
+int ObstaculosEstaticos::rebotar(Particula& p) const {
+    int rebotes = 0;
+    Vector2D v = p.getVeloc();
+    const Vector2D& pos = p.getPos();
+    paraCadaSolapado(pos.getX(), pos.getY(), p.getRadio(), [&](int k) {
+        Vector2D normal(pos.getX() - x[k], pos.getY() - y[k]);
+        Escalar d = normal.modulo();
+        if (d <= Escalar(0)) {
+            return;
+        }
+        normal /= d;
+        Escalar vn = v.producto(normal);
+        if (vn < Escalar(0)) {
+            v -= normal * (vn + vn);
+            rebotes++;
+        }
+    });
+    if (rebotes > 0) {
+        p.setVeloc(v);
+    }
+    return rebotes;
+}
@@ -0,0 +1,16 @@
+#include "ParametrosMundo.h"
+
+ParametrosMundo::ParametrosMundo()
+    : maxX(MAX_X), maxY(MAX_Y), maxVel(MAX_VEL), radioMin(MIN_R), radioMax(MAX_R) {}
+
+ParametrosMundo::ParametrosMundo(float maxX, float maxY)
+    : maxX(maxX), maxY(maxY), maxVel(MAX_VEL), radioMin(MIN_R), radioMax(MAX_R) {}
+
+/**
+ * Indica si todos los valores coinciden con los de params.h
+ * @return true si es el mundo de params.h
+ */
+bool ParametrosMundo::esFijo() const {
+    return maxX == MundoFijo::maxX && maxY == MundoFijo::maxY && maxVel == MundoFijo::maxVel &&
+           radioMin == MundoFijo::radioMin && radioMax == MundoFijo::radioMax;
+}
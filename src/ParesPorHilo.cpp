@@ -0,0 +1,85 @@
+#include "ParesPorHilo.h"
+
+ParesPorHilo::ParesPorHilo() : listas(nullptr), numHilos(0), bytesLiberados(0) {}
+
+ParesPorHilo::~ParesPorHilo() {
+    for (int h = 0; h < numHilos; h++) {
+        delete[] listas[h].i;
+        delete[] listas[h].j;
+    }
+    delete[] listas;
+}
+
+void ParesPorHilo::crecer(Lista& l) {
+    int nuevaCapacidad = (l.capacidad > 0) ? 2 * l.capacidad : 256;
+    int* nuevoI = new int[nuevaCapacidad];
+    int* nuevoJ = new int[nuevaCapacidad];
+    for (int k = 0; k < l.n; k++) {
+        nuevoI[k] = l.i[k];
+        nuevoJ[k] = l.j[k];
+    }
+    delete[] l.i;
+    delete[] l.j;
+    l.i = nuevoI;
+    l.j = nuevoJ;
+    l.capacidad = nuevaCapacidad;
+    l.bytes += (long)nuevaCapacidad * 2 * sizeof(int);
+}
+
+void ParesPorHilo::preparar(int hilos) {
+    if (hilos == numHilos) {
+        return;
+    }
+    for (int h = 0; h < numHilos; h++) {
+        bytesLiberados += listas[h].bytes;
+        delete[] listas[h].i;
+        delete[] listas[h].j;
+    }
+    delete[] listas;
+    numHilos = hilos;
+    listas = new Lista[numHilos];
+    bytesLiberados += (long)numHilos * sizeof(Lista);
+    for (int h = 0; h < numHilos; h++) {
+        listas[h].i = listas[h].j = nullptr;
+        listas[h].n = listas[h].capacidad = 0;
+        listas[h].bytes = 0;
+    }
+}
+
+void ParesPorHilo::vaciar(int h) {
+    listas[h].n = 0;
+}
+
+int ParesPorHilo::getPares(int h) const {
+    return listas[h].n;
+}
+
+int* ParesPorHilo::paresJ(int h) {
+    return listas[h].j;
+}
+
+int ParesPorHilo::total() const {
+    int n = 0;
+    for (int h = 0; h < numHilos; h++) {
+        n += listas[h].n;
+    }
+    return n;
+}
+
+void ParesPorHilo::concatenar(int* i, int* j) const {
+    int k = 0;
+    for (int h = 0; h < numHilos; h++) {
+        for (int q = 0; q < listas[h].n; q++, k++) {
+            i[k] = listas[h].i[q];
+            j[k] = listas[h].j[q];
+        }
+    }
+}
+
+long ParesPorHilo::getBytesReservados() const {
+    long bytes = bytesLiberados;
+    for (int h = 0; h < numHilos; h++) {
+        bytes += listas[h].bytes;
+    }
+    return bytes;
+}
@@ -1,9 +1,13 @@
 #include "Particula.h"
+#include "Colision.h"
 #include <sstream>
 #include <cmath>
 
-// Constructor con valor por defecto
-Particula::Particula(int tipoPart) : tipo(tipoPart) {
+// Constructor con valor por defecto (en el mundo de params.h)
+Particula::Particula(int tipoPart) : Particula(ParametrosMundo(), tipoPart) {}
+
+// Constructor de una partícula aleatoria o estática en un mundo dado
+Particula::Particula(const ParametrosMundo& mundo, int tipoPart) : tipo(tipoPart), vida(VIDA_INFINITA) {
     if (tipoPart != 0) {
         // Partícula estática
         pos.setXY(0, 0);
@@ -11,13 +15,15 @@ Particula::Particula(int tipoPart) : tipo(tipoPart) {
         veloc.setXY(0, 0);
         radio = 3.0f;
     } else {
+        // Radio aleatorio (antes que la posición, que depende de él)
+        radio = aleatorio(mundo.radioMin, mundo.radioMax);
         
         // Posición aleatoria dentro del mundo
-        pos.setXY(aleatorio(radio*2, MAX_X - radio*2), aleatorio(radio*2, MAX_Y - radio*2));
+        pos.setXY(aleatorio(radio*2, mundo.maxX - radio*2), aleatorio(radio*2, mundo.maxY - radio*2));
         
         // Velocidad aleatoria con valores mínimos garantizados
-        float vx = aleatorio(-MAX_VEL, MAX_VEL);
-        float vy = aleatorio(-MAX_VEL, MAX_VEL);
+        float vx = aleatorio(-mundo.maxVel, mundo.maxVel);
+        float vy = aleatorio(-mundo.maxVel, mundo.maxVel);
         
         // Asegurar un mínimo de velocidad para evitar partículas casi estáticas
         if (std::abs(vx) < 1.0f) vx = (vx >= 0) ? 1.0f : -1.0f;
@@ -27,36 +33,12 @@ Particula::Particula(int tipoPart) : tipo(tipoPart) {
         
         // Inicializar con aceleración cero para evitar que las partículas se frenen
         acel.setXY(0.0f, 0.0f);
-        
-        // Radio aleatorio
-        radio = aleatorio(MIN_R, MAX_R);
     }
 }
 
 // Constructor con parámetros
-Particula::Particula(const Vector2D& pos, const Vector2D& acel, const Vector2D& veloc, float radio, int tipo)
-    : pos(pos), acel(acel), veloc(veloc), radio(radio), tipo(tipo) {}
-
-// Métodos get
-Vector2D Particula::getPos() const {
-    return pos;
-}
-
-Vector2D Particula::getAcel() const {
-    return acel;
-}
-
-Vector2D Particula::getVeloc() const {
-    return veloc;
-}
-
-float Particula::getRadio() const {
-    return radio;
-}
-
-int Particula::getTipo() const {
-    return tipo;
-}
+Particula::Particula(const Vector2D& pos, const Vector2D& acel, const Vector2D& veloc, Escalar radio, int tipo)
+    : pos(pos), acel(acel), veloc(veloc), radio(radio), tipo(tipo), vida(VIDA_INFINITA) {}
 
 // Métodos set
 void Particula::setPos(const Vector2D& pos) {
@@ -71,88 +53,126 @@ void Particula::setVeloc(const Vector2D& veloc) {
     this->veloc = veloc;
 }
 
-void Particula::setRadio(float radio) {
+void Particula::setRadio(Escalar radio) {
     this->radio = radio;
 }
 
+void Particula::setTipo(int tipo) {
+    this->tipo = tipo;
+}
+
+void Particula::setVida(int vida) {
+    this->vida = vida;
+}
+
 // Actualiza la posición de la partícula
-void Particula::mover() {
+// (los límites del mundo se pasan a Escalar: en coma fija todo el cálculo
+// es entero)
+template <class Mundo>
+void Particula::mover(const Mundo& mundo) {
+    const Escalar maxVel = mundo.maxVel;
+
     // 1) Sumar aceleración a velocidad
     veloc.sumar(acel);
     
     // 2) Limitar la velocidad al máximo permitido
-    if (veloc.getX() > MAX_VEL) veloc.setX(MAX_VEL);
-    if (veloc.getX() < -MAX_VEL) veloc.setX(-MAX_VEL);
-    if (veloc.getY() > MAX_VEL) veloc.setY(MAX_VEL);
-    if (veloc.getY() < -MAX_VEL) veloc.setY(-MAX_VEL);
+    if (veloc.getX() > maxVel) veloc.setX(maxVel);
+    if (veloc.getX() < -maxVel) veloc.setX(-maxVel);
+    if (veloc.getY() > maxVel) veloc.setY(maxVel);
+    if (veloc.getY() < -maxVel) veloc.setY(-maxVel);
     
     // 3) Sumar velocidad a posición
     pos.sumar(veloc);
 }
 
 // Implementa el rebote contra los bordes del mundo
-void Particula::rebotar() {
+template <class Mundo>
+void Particula::rebotar(const Mundo& mundo) {
+    const Escalar maxX = mundo.maxX, maxY = mundo.maxY, cero = 0;
+
     // Verificar rebote en eje X
-    if (pos.getX() - radio <= 0 || pos.getX() + radio >= MAX_X) {
+    if (pos.getX() - radio <= cero || pos.getX() + radio >= maxX) {
         // Cambiar el signo de la velocidad en X (manteniendo la magnitud)
         veloc.setX(-veloc.getX());
         
         // Asegurar que la partícula no quede fuera de los límites
-        if (pos.getX() - radio < 0) {
+        if (pos.getX() - radio < cero) {
             pos.setX(radio);
-        } else if (pos.getX() + radio > MAX_X) {
-            pos.setX(MAX_X - radio);
+        } else if (pos.getX() + radio > maxX) {
+            pos.setX(maxX - radio);
         }
     }
     
     // Verificar rebote en eje Y
-    if (pos.getY() - radio <= 0 || pos.getY() + radio >= MAX_Y) {
+    if (pos.getY() - radio <= cero || pos.getY() + radio >= maxY) {
         // Cambiar el signo de la velocidad en Y (manteniendo la magnitud)
         veloc.setY(-veloc.getY());
         
         // Asegurar que la partícula no quede fuera de los límites
-        if (pos.getY() - radio < 0) {
+        if (pos.getY() - radio < cero) {
             pos.setY(radio);
-        } else if (pos.getY() + radio > MAX_Y) {
-            pos.setY(MAX_Y - radio);
+        } else if (pos.getY() + radio > maxY) {
+            pos.setY(maxY - radio);
         }
     }
 }
 
 // Implementa el comportamiento de "envolver" la partícula cuando sale del mundo
-void Particula::wrap() {
+template <class Mundo>
+void Particula::wrap(const Mundo& mundo) {
+    const Escalar maxX = mundo.maxX, maxY = mundo.maxY, cero = 0;
+
     // Verificar si la partícula ha salido por un borde horizontal y hacer que aparezca por el lado opuesto
-    if (pos.getX() + radio < 0) {
+    if (pos.getX() + radio < cero) {
         // Ha salido completamente por la izquierda, aparecer por la derecha
         // Teniendo en cuenta el radio para que la partícula aparezca justo entrando por el borde derecho
-        pos.setX(MAX_X - radio);
+        pos.setX(maxX - radio);
     } 
-    else if (pos.getX() - radio > MAX_X) {
+    else if (pos.getX() - radio > maxX) {
         // Ha salido completamente por la derecha, aparecer por la izquierda
         // Teniendo en cuenta el radio para que la partícula aparezca justo entrando por el borde izquierdo
         pos.setX(radio);
     }
     
     // Verificar si la partícula ha salido por un borde vertical y hacer que aparezca por el lado opuesto
-    if (pos.getY() + radio < 0) {
+    if (pos.getY() + radio < cero) {
         // Ha salido completamente por arriba, aparecer por abajo
         // Teniendo en cuenta el radio para que la partícula aparezca justo entrando por el borde inferior
-        pos.setY(MAX_Y - radio);
+        pos.setY(maxY - radio);
     } 
-    else if (pos.getY() - radio > MAX_Y) {
+    else if (pos.getY() - radio > maxY) {
         // Ha salido completamente por abajo, aparecer por arriba
         // Teniendo en cuenta el radio para que la partícula aparezca justo entrando por el borde superior
         pos.setY(radio);
     }
 }
 
+// Versiones en el mundo de params.h: usan las constantes de compilación
+void Particula::mover() {
+    mover(MundoFijo());
+}
+
+void Particula::rebotar() {
+    rebotar(MundoFijo());
+}
+
+void Particula::wrap() {
+    wrap(MundoFijo());
+}
+
+// Instanciaciones para los dos tipos de mundo
+template void Particula::mover<ParametrosMundo>(const ParametrosMundo&);
+template void Particula::mover<MundoFijo>(const MundoFijo&);
+template void Particula::rebotar<ParametrosMundo>(const ParametrosMundo&);
+template void Particula::rebotar<MundoFijo>(const MundoFijo&);
+template void Particula::wrap<ParametrosMundo>(const ParametrosMundo&);
+template void Particula::wrap<MundoFijo>(const MundoFijo&);
+
 // Detecta colisión con otra partícula
 bool Particula::colision(const Particula& otra) const {
-    // Calcular la distancia entre los centros de las partículas
-    float distancia = pos.distancia(otra.pos);
-    
     // Hay colisión si la distancia es menor que la suma de los radios
-    return distancia < (radio + otra.radio);
+    // (comparando cuadrados, sin raíz)
+    return solapan(otra.pos.getX() - pos.getX(), otra.pos.getY() - pos.getY(), radio + otra.radio);
 }
 
 // Implementa el choque elástico entre partículas
@@ -168,6 +188,14 @@ void Particula::choque(Particula& otra) {
     otra.acel = tempAcel;
 }
 
+// Descuenta un paso de vida; las partículas con VIDA_INFINITA no caducan
+bool Particula::envejecer() {
+    if (vida > 0) {
+        vida--;
+    }
+    return vida == 0;
+}
+
 // Representación como string de la partícula
 std::string Particula::toString() const {
     std::ostringstream oss;
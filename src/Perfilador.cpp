@@ -0,0 +1,275 @@
+#include "Perfilador.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PERFIL_RDTSC
+#endif
+
+// Estado global: nombres de las fases y registros de cada hilo.
+// Sólo se toma el cerrojo al registrar una fase o un hilo nuevo.
+static std::mutex cerrojoRegistro;
+static const char* nombresFases[PERFIL_MAX_FASES];
+static std::atomic<int> numFases(0);
+static std::atomic<int> numHilos(0);
+static int eventosPorHilo = 0;
+
+/**
+ * Dueño de los registros de los hilos: los libera al salir del programa,
+ * de modo que siguen disponibles para el informe después de que sus hilos
+ * hayan terminado
+ */
+static struct Registros {
+    Perfilador* hilos[PERFIL_MAX_HILOS];
+    ~Registros() {
+        for (int i = 0; i < numHilos.load(); i++) {
+            delete hilos[i];
+        }
+    }
+} registros;
+
+static thread_local Perfilador* propio = nullptr;
+
+/**
+ * Nanosegundos por unidad de reloj(). Con rdtsc se calibra una vez
+ * contra steady_clock durante unos milisegundos
+ */
+static double nsPorTick() {
+#ifdef PERFIL_RDTSC
+    static double factor = 0.0;
+    if (factor == 0.0) {
+        auto t0 = std::chrono::steady_clock::now();
+        uint64_t c0 = __rdtsc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        uint64_t c1 = __rdtsc();
+        auto t1 = std::chrono::steady_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        factor = (c1 > c0) ? ns / (c1 - c0) : 1.0;
+    }
+    return factor;
+#else
+    return 1.0;
+#endif
+}
+
+Perfilador::Perfilador(int id) : id(id), frames(0), eventos(nullptr), maxEventos(0), numEventos(0) {
+    for (int f = 0; f < PERFIL_MAX_FASES; f++) {
+        actual[f] = 0;
+        usada[f] = false;
+        muestras[f] = nullptr;
+    }
+    if (eventosPorHilo > 0) {
+        maxEventos = eventosPorHilo;
+        eventos = new Evento[maxEventos];
+    }
+}
+
+Perfilador::~Perfilador() {
+    for (int f = 0; f < PERFIL_MAX_FASES; f++) {
+        delete[] muestras[f];
+    }
+    delete[] eventos;
+}
+
+/**
+ * Registro del hilo que llama (se crea la primera vez)
+ * @return Perfilador del hilo actual
+ */
+Perfilador& Perfilador::hilo() {
+    if (propio == nullptr) {
+        std::lock_guard<std::mutex> bloqueo(cerrojoRegistro);
+        int n = numHilos.load();
+        if (n < PERFIL_MAX_HILOS) {
+            propio = new Perfilador(n);
+            registros.hilos[n] = propio;
+            numHilos.store(n + 1);
+        } else {
+            // Demasiados hilos: se mide, pero no se informa
+            static Perfilador descartado(-1);
+            propio = &descartado;
+        }
+    }
+    return *propio;
+}
+
+/**
+ * Obtiene el índice de una fase, registrándola si es nueva
+ * @param nombre Nombre de la fase
+ * @return Índice de la fase, o -1 si no caben más
+ */
+int Perfilador::fase(const char* nombre) {
+    std::lock_guard<std::mutex> bloqueo(cerrojoRegistro);
+    int n = numFases.load();
+    for (int f = 0; f < n; f++) {
+        if (std::strcmp(nombresFases[f], nombre) == 0) {
+            return f;
+        }
+    }
+    if (n == PERFIL_MAX_FASES) {
+        return -1;
+    }
+    nombresFases[n] = nombre;
+    numFases.store(n + 1);
+    return n;
+}
+
+/**
+ * Lee el reloj del perfilador
+ * @return Ciclos (rdtsc) o nanosegundos (steady_clock)
+ */
+uint64_t Perfilador::reloj() {
+#ifdef PERFIL_RDTSC
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/**
+ * Activa la grabación de eventos; afecta a los hilos que empiecen a medir
+ * después de la llamada, por lo que conviene hacerla al inicio del programa
+ * @param maxEventos Eventos que se guardan como máximo por hilo
+ */
+void Perfilador::activarTraza(int maxEventos) {
+    std::lock_guard<std::mutex> bloqueo(cerrojoRegistro);
+    eventosPorHilo = (maxEventos > 0) ? maxEventos : 0;
+}
+
+/**
+ * Suma un intervalo a una fase del frame en curso
+ * @param fase Índice de la fase
+ * @param inicio Marca de tiempo inicial
+ * @param fin Marca de tiempo final
+ */
+void Perfilador::acumular(int fase, uint64_t inicio, uint64_t fin) {
+    if (fase < 0 || id < 0) return;
+
+    actual[fase] += fin - inicio;
+    usada[fase] = true;
+
+    if (numEventos < maxEventos) {
+        eventos[numEventos].fase = fase;
+        eventos[numEventos].inicio = inicio;
+        eventos[numEventos].duracion = fin - inicio;
+        numEventos++;
+    }
+}
+
+/**
+ * Cierra el frame en curso: el acumulado de cada fase usada en este hilo
+ * pasa a su histórico (también si en este frame ha sido cero)
+ */
+void Perfilador::finFrame() {
+    if (id < 0) return;
+
+    int hueco = frames % PERFIL_MAX_FRAMES;
+    for (int f = 0; f < PERFIL_MAX_FASES; f++) {
+        if (usada[f]) {
+            if (muestras[f] == nullptr) {
+                // Los frames anteriores a la primera aparición cuentan como cero
+                muestras[f] = new uint64_t[PERFIL_MAX_FRAMES]();
+            }
+            muestras[f][hueco] = actual[f];
+        }
+        actual[f] = 0;
+    }
+    frames++;
+}
+
+/**
+ * Percentil del total por frame de una fase en este hilo: el elemento
+ * (n - 1) * p / 100 de los últimos n frames ordenados
+ * @param fase Índice de la fase
+ * @param p Percentil de 0 a 100
+ * @return Unidades de reloj(), o 0 si la fase no tiene frames
+ */
+uint64_t Perfilador::percentil(int fase, int p) const {
+    long n = std::min<long>(frames, PERFIL_MAX_FRAMES);
+    if (fase < 0 || n == 0 || muestras[fase] == nullptr) {
+        return 0;
+    }
+    std::vector<uint64_t> orden(muestras[fase], muestras[fase] + n);
+    long k = (n - 1) * p / 100;
+    std::nth_element(orden.begin(), orden.begin() + k, orden.end());
+    return orden[k];
+}
+
+/**
+ * Tabla con p50, p99 y máximo por hilo y fase, en milisegundos por frame
+ * @return Texto del informe
+ */
+std::string Perfilador::informe() {
+    std::ostringstream oss;
+    double msPorTick = nsPorTick() / 1e6;
+
+    oss << std::fixed << std::setprecision(3);
+    oss << std::left << std::setw(6) << "hilo" << std::setw(24) << "fase"
+        << std::right << std::setw(8) << "frames" << std::setw(10) << "p50 ms"
+        << std::setw(10) << "p99 ms" << std::setw(10) << "max ms" << std::endl;
+
+    for (int h = 0; h < numHilos.load(); h++) {
+        const Perfilador* p = registros.hilos[h];
+        long n = std::min<long>(p->frames, PERFIL_MAX_FRAMES);
+        if (n == 0) continue;
+
+        for (int f = 0; f < numFases.load(); f++) {
+            if (p->muestras[f] == nullptr) continue;
+
+            oss << std::left << std::setw(6) << h << std::setw(24) << nombresFases[f]
+                << std::right << std::setw(8) << n
+                << std::setw(10) << p->percentil(f, 50) * msPorTick
+                << std::setw(10) << p->percentil(f, 99) * msPorTick
+                << std::setw(10) << p->percentil(f, 100) * msPorTick << std::endl;
+        }
+    }
+    return oss.str();
+}
+
+/**
+ * Escribe los eventos grabados en formato trace_event de Chrome
+ * @param ruta Fichero de salida
+ * @return false si no se pudo escribir
+ */
+bool Perfilador::exportarTraza(const std::string& ruta) {
+    std::ofstream salida(ruta);
+    if (!salida) return false;
+
+    double usPorTick = nsPorTick() / 1e3;
+
+    // Los tiempos se expresan desde el primer evento grabado
+    uint64_t origen = UINT64_MAX;
+    for (int h = 0; h < numHilos.load(); h++) {
+        const Perfilador* p = registros.hilos[h];
+        for (int e = 0; e < p->numEventos; e++) {
+            origen = std::min(origen, p->eventos[e].inicio);
+        }
+    }
+
+    salida << std::fixed << std::setprecision(3);
+    salida << "{\"traceEvents\":[";
+    bool primero = true;
+    for (int h = 0; h < numHilos.load(); h++) {
+        const Perfilador* p = registros.hilos[h];
+        for (int e = 0; e < p->numEventos; e++) {
+            const Evento& ev = p->eventos[e];
+            salida << (primero ? "\n" : ",\n")
+                   << "{\"name\":\"" << nombresFases[ev.fase] << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << h
+                   << ",\"ts\":" << (ev.inicio - origen) * usPorTick
+                   << ",\"dur\":" << ev.duracion * usPorTick << "}";
+            primero = false;
+        }
+    }
+    salida << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return salida.good();
+}
@@ -0,0 +1,149 @@
+#include "PoolTrabajo.h"
+
+PoolTrabajo::PoolTrabajo(int numHilos)
+    : tarea(nullptr), trabajo(0), activos(0), conRobo(true), salir(false), robos(0) {
+    if (numHilos <= 0) {
+        numHilos = (int)std::thread::hardware_concurrency();
+    }
+    this->numHilos = (numHilos > 0) ? numHilos : 1;
+
+    colas = new Cola[this->numHilos];
+    for (int h = 0; h < this->numHilos; h++) {
+        colas[h].inicio = colas[h].fin = 0;
+    }
+    hilos = new std::thread[this->numHilos];
+    for (int h = 0; h < this->numHilos; h++) {
+        hilos[h] = std::thread(&PoolTrabajo::trabajar, this, h);
+    }
+}
+
+PoolTrabajo::~PoolTrabajo() {
+    {
+        std::lock_guard<std::mutex> cerrojo(m);
+        salir = true;
+    }
+    hayTrabajo.notify_all();
+    for (int h = 0; h < numHilos; h++) {
+        hilos[h].join();
+    }
+    delete[] hilos;
+    delete[] colas;
+}
+
+int PoolTrabajo::getNumHilos() const {
+    return numHilos;
+}
+
+long PoolTrabajo::getRobos() const {
+    return robos.load(std::memory_order_relaxed);
+}
+
+/**
+ * Saca el siguiente índice de la cola propia (por delante)
+ * @return false si la cola está vacía
+ */
+bool PoolTrabajo::tomar(int id, int& indice) {
+    std::lock_guard<std::mutex> cerrojo(colas[id].m);
+    if (colas[id].inicio >= colas[id].fin) {
+        return false;
+    }
+    indice = colas[id].inicio++;
+    return true;
+}
+
+/**
+ * Roba la mitad trasera de la cola de otro hilo (empezando por el
+ * siguiente, para que los ladrones no vayan todos a la misma víctima)
+ * @return false si no queda trabajo en ninguna cola
+ */
+bool PoolTrabajo::robar(int id) {
+    for (int k = 1; k < numHilos; k++) {
+        Cola& victima = colas[(id + k) % numHilos];
+        int desde, hasta;
+        {
+            std::lock_guard<std::mutex> cerrojo(victima.m);
+            int quedan = victima.fin - victima.inicio;
+            if (quedan <= 0) {
+                continue;
+            }
+            // Con un solo índice pendiente se lo lleva el ladrón: la víctima
+            // puede estar ocupada con una tarea larga
+            desde = victima.fin - (quedan + 1) / 2;
+            hasta = victima.fin;
+            victima.fin = desde;
+        }
+
+        std::lock_guard<std::mutex> cerrojo(colas[id].m);
+        colas[id].inicio = desde;
+        colas[id].fin = hasta;
+        robos.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Bucle de cada hilo: espera un trabajo nuevo, consume su cola, roba
+ * mientras quede algo y avisa al terminar
+ * @param id Número del hilo
+ */
+void PoolTrabajo::trabajar(int id) {
+    long visto = 0;
+    while (true) {
+        const Tarea* f;
+        bool robo;
+        {
+            std::unique_lock<std::mutex> cerrojo(m);
+            hayTrabajo.wait(cerrojo, [&] { return salir || trabajo != visto; });
+            if (salir) {
+                return;
+            }
+            visto = trabajo;
+            f = tarea;
+            robo = conRobo;
+        }
+
+        int indice;
+        while (true) {
+            if (tomar(id, indice)) {
+                f->llamar(f->objeto, indice);
+            } else if (!robo || !robar(id)) {
+                break;
+            }
+        }
+
+        std::lock_guard<std::mutex> cerrojo(m);
+        if (--activos == 0) {
+            terminado.notify_all();
+        }
+    }
+}
+
+/**
+ * Reparte las colas, lanza el trabajo y espera a que termine. En
+ * enCadaHilo (una tarea por hilo y sin robos) la tarea h sólo puede
+ * ejecutarla el hilo h
+ * @param n Número de tareas
+ * @param f Tarea
+ * @param robo true si los hilos pueden robarse índices
+ */
+void PoolTrabajo::lanzar(int n, const Tarea& f, bool robo) {
+    if (n <= 0) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> cerrojo(m);
+    // Los hilos están parados esperando: se pueden repartir las colas
+    for (int h = 0; h < numHilos; h++) {
+        std::lock_guard<std::mutex> cerrojoCola(colas[h].m);
+        colas[h].inicio = (int)((long)n * h / numHilos);
+        colas[h].fin = (int)((long)n * (h + 1) / numHilos);
+    }
+    tarea = &f;
+    conRobo = robo;
+    activos = numHilos;
+    trabajo++;
+    hayTrabajo.notify_all();
+    terminado.wait(cerrojo, [&] { return activos == 0; });
+    tarea = nullptr;
+}
@@ -0,0 +1,205 @@
+#include "Rasterizador.h"
+#include <cmath>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Fuente de 5x7 por columnas (bit 0 = fila superior) para ' ' .. 'Z'
+static const uint8_t FUENTE[][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, // ' '
+    {0x00,0x00,0x5F,0x00,0x00}, // '!'
+    {0x00,0x07,0x00,0x07,0x00}, // '"'
+    {0x14,0x7F,0x14,0x7F,0x14}, // '#'
+    {0x24,0x2A,0x7F,0x2A,0x12}, // '$'
+    {0x23,0x13,0x08,0x64,0x62}, // '%'
+    {0x36,0x49,0x56,0x20,0x50}, // '&'
+    {0x00,0x08,0x07,0x03,0x00}, // '''
+    {0x00,0x1C,0x22,0x41,0x00}, // '('
+    {0x00,0x41,0x22,0x1C,0x00}, // ')'
+    {0x2A,0x1C,0x7F,0x1C,0x2A}, // '*'
+    {0x08,0x08,0x3E,0x08,0x08}, // '+'
+    {0x00,0x80,0x70,0x30,0x00}, // ','
+    {0x08,0x08,0x08,0x08,0x08}, // '-'
+    {0x00,0x00,0x60,0x60,0x00}, // '.'
+    {0x20,0x10,0x08,0x04,0x02}, // '/'
+    {0x3E,0x51,0x49,0x45,0x3E}, // '0'
+    {0x00,0x42,0x7F,0x40,0x00}, // '1'
+    {0x72,0x49,0x49,0x49,0x46}, // '2'
+    {0x21,0x41,0x49,0x4D,0x33}, // '3'
+    {0x18,0x14,0x12,0x7F,0x10}, // '4'
+    {0x27,0x45,0x45,0x45,0x39}, // '5'
+    {0x3C,0x4A,0x49,0x49,0x31}, // '6'
+    {0x41,0x21,0x11,0x09,0x07}, // '7'
+    {0x36,0x49,0x49,0x49,0x36}, // '8'
+    {0x46,0x49,0x49,0x29,0x1E}, // '9'
+    {0x00,0x00,0x14,0x00,0x00}, // ':'
+    {0x00,0x40,0x34,0x00,0x00}, // ';'
+    {0x00,0x08,0x14,0x22,0x41}, // '<'
+    {0x14,0x14,0x14,0x14,0x14}, // '='
+    {0x00,0x41,0x22,0x14,0x08}, // '>'
+    {0x02,0x01,0x59,0x09,0x06}, // '?'
+    {0x3E,0x41,0x5D,0x59,0x4E}, // '@'
+    {0x7C,0x12,0x11,0x12,0x7C}, // 'A'
+    {0x7F,0x49,0x49,0x49,0x36}, // 'B'
+    {0x3E,0x41,0x41,0x41,0x22}, // 'C'
+    {0x7F,0x41,0x41,0x41,0x3E}, // 'D'
+    {0x7F,0x49,0x49,0x49,0x41}, // 'E'
+    {0x7F,0x09,0x09,0x09,0x01}, // 'F'
+    {0x3E,0x41,0x41,0x51,0x73}, // 'G'
+    {0x7F,0x08,0x08,0x08,0x7F}, // 'H'
+    {0x00,0x41,0x7F,0x41,0x00}, // 'I'
+    {0x20,0x40,0x41,0x3F,0x01}, // 'J'
+    {0x7F,0x08,0x14,0x22,0x41}, // 'K'
+    {0x7F,0x40,0x40,0x40,0x40}, // 'L'
+    {0x7F,0x02,0x1C,0x02,0x7F}, // 'M'
+    {0x7F,0x04,0x08,0x10,0x7F}, // 'N'
+    {0x3E,0x41,0x41,0x41,0x3E}, // 'O'
+    {0x7F,0x09,0x09,0x09,0x06}, // 'P'
+    {0x3E,0x41,0x51,0x21,0x5E}, // 'Q'
+    {0x7F,0x09,0x19,0x29,0x46}, // 'R'
+    {0x26,0x49,0x49,0x49,0x32}, // 'S'
+    {0x03,0x01,0x7F,0x01,0x03}, // 'T'
+    {0x3F,0x40,0x40,0x40,0x3F}, // 'U'
+    {0x1F,0x20,0x40,0x20,0x1F}, // 'V'
+    {0x3F,0x40,0x38,0x40,0x3F}, // 'W'
+    {0x63,0x14,0x08,0x14,0x63}, // 'X'
+    {0x03,0x04,0x78,0x04,0x03}, // 'Y'
+    {0x61,0x59,0x49,0x4D,0x43}, // 'Z'
+};
+
+Rasterizador::Rasterizador(int ancho, int alto) {
+    this->ancho = (ancho > 0) ? ancho : 0;
+    this->alto = (alto > 0) ? alto : 0;
+    // Las filas se recorren con cargas sin alinear, así que basta new[]
+    pixeles = new ColorRGBA[(size_t)this->ancho * this->alto];
+}
+
+Rasterizador::~Rasterizador() {
+    delete[] pixeles;
+}
+
+int Rasterizador::getAncho() const {
+    return ancho;
+}
+
+int Rasterizador::getAlto() const {
+    return alto;
+}
+
+const ColorRGBA* Rasterizador::getPixeles() const {
+    return pixeles;
+}
+
+/**
+ * Rellena n píxeles consecutivos con un color, varios por instrucción
+ */
+static void rellenar(ColorRGBA* p, size_t n, ColorRGBA color) {
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256i v8 = _mm256_set1_epi32((int)color);
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_si256((__m256i*)(p + i), v8);
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i v4 = _mm_set1_epi32((int)color);
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_si128((__m128i*)(p + i), v4);
+    }
+#endif
+    for (; i < n; i++) {
+        p[i] = color;
+    }
+}
+
+/**
+ * Rellena los píxeles [x0, x1) de la fila y (ya recortados)
+ */
+void Rasterizador::tramo(int y, int x0, int x1, ColorRGBA color) {
+    rellenar(pixeles + (size_t)y * ancho + x0, x1 - x0, color);
+}
+
+/**
+ * Rellena todo el framebuffer con un color
+ * @param color Color de fondo
+ */
+void Rasterizador::limpiar(ColorRGBA color) {
+    // Las filas son contiguas: el framebuffer entero es un único tramo
+    rellenar(pixeles, (size_t)ancho * alto, color);
+}
+
+/**
+ * Pinta un círculo relleno: un píxel se pinta si su centro cae dentro
+ * @param cx Centro X en píxeles
+ * @param cy Centro Y en píxeles
+ * @param radio Radio en píxeles
+ * @param color Color de relleno
+ */
+void Rasterizador::circulo(float cx, float cy, float radio, ColorRGBA color) {
+    if (radio <= 0) return;
+
+    int y0 = (int)std::ceil(cy - radio - 0.5f);
+    int y1 = (int)std::floor(cy + radio - 0.5f);
+    if (y0 < 0) y0 = 0;
+    if (y1 > alto - 1) y1 = alto - 1;
+
+    float r2 = radio * radio;
+    for (int y = y0; y <= y1; y++) {
+        // Semiancho de la cuerda a la altura del centro del píxel
+        float dy = (y + 0.5f) - cy;
+        float h2 = r2 - dy * dy;
+        if (h2 < 0) continue;
+        float h = std::sqrt(h2);
+
+        int x0 = (int)std::ceil(cx - h - 0.5f);
+        int x1 = (int)std::floor(cx + h - 0.5f) + 1;
+        if (x0 < 0) x0 = 0;
+        if (x1 > ancho) x1 = ancho;
+        if (x0 < x1) tramo(y, x0, x1, color);
+    }
+}
+
+/**
+ * Pinta un rectángulo relleno
+ */
+void Rasterizador::rectangulo(int x, int y, int w, int h, ColorRGBA color) {
+    int x0 = (x < 0) ? 0 : x;
+    int x1 = (x + w > ancho) ? ancho : x + w;
+    int y0 = (y < 0) ? 0 : y;
+    int y1 = (y + h > alto) ? alto : y + h;
+    if (x0 >= x1) return;
+    for (int fila = y0; fila < y1; fila++) {
+        tramo(fila, x0, x1, color);
+    }
+}
+
+/**
+ * Pinta texto con la fuente de 5x7. Como en raylib, tam es la altura de
+ * la línea, y la fuente por defecto ocupa la mitad de esa altura escalada
+ * @param texto Texto a pintar
+ * @param x Esquina superior izquierda X
+ * @param y Esquina superior izquierda Y
+ * @param tam Tamaño de letra
+ * @param color Color del texto
+ */
+void Rasterizador::texto(const std::string& texto, int x, int y, int tam, ColorRGBA color) {
+    int escala = tam / 10;
+    if (escala < 1) escala = 1;
+
+    int cursor = x;
+    for (unsigned char car : texto) {
+        if (car >= 'a' && car <= 'z') car = car - 'a' + 'A';
+        if (car >= ' ' && car <= 'Z') {
+            const uint8_t* glifo = FUENTE[car - ' '];
+            for (int col = 0; col < 5; col++) {
+                for (int fila = 0; fila < 7; fila++) {
+                    if (glifo[col] & (1 << fila)) {
+                        rectangulo(cursor + col * escala, y + fila * escala, escala, escala, color);
+                    }
+                }
+            }
+        }
+        cursor += 6 * escala;
+    }
+}
@@ -0,0 +1,338 @@
+#include "RejillaOrdenada.h"
+#include "PoolTrabajo.h"
+#include "Colision.h"
+#include <limits>
+
+// Celdas como máximo: si la caja es muy grande para el radio, las celdas
+// se agrandan (sigue siendo correcto, sólo hay más candidatas por celda)
+const long MAX_CELDAS_REJILLA = 1L << 22;
+
+/**
+ * Ejecuta f(h) en cada hilo del pool, o f(0) en el que llama si no hay pool
+ */
+template <class F>
+static void enHilos(PoolTrabajo* pool, const F& f) {
+    if (pool != nullptr) {
+        pool->enCadaHilo(f);
+    } else {
+        f(0);
+    }
+}
+
+RejillaOrdenada::RejillaOrdenada()
+    : hilos(nullptr), numHilos(0),
+      celdaDe(nullptr), clave(nullptr), indice(nullptr), claveAux(nullptr), indiceAux(nullptr),
+      xs(nullptr), ys(nullptr), rs(nullptr), capacidad(0),
+      minX(0), minY(0), tamCelda(1.0f), celdasX(0), celdasY(0), inicio(nullptr), capacidadCeldas(0),
+      cuentas(nullptr), capacidadCuentas(0),
+      parI(nullptr), parJ(nullptr), numPares(0), capacidadPares(0), candidatos(0), bytesReservados(0) {}
+
+RejillaOrdenada::~RejillaOrdenada() {
+    delete[] hilos;
+    delete[] celdaDe;
+    delete[] clave;
+    delete[] indice;
+    delete[] claveAux;
+    delete[] indiceAux;
+    delete[] xs;
+    delete[] ys;
+    delete[] rs;
+    delete[] inicio;
+    delete[] cuentas;
+    delete[] parI;
+    delete[] parJ;
+}
+
+void RejillaOrdenada::prepararHilos(int hilos) {
+    if (hilos != numHilos) {
+        delete[] this->hilos;
+        numHilos = hilos;
+        this->hilos = new Tramo[numHilos];
+        bytesReservados += (long)numHilos * sizeof(Tramo);
+    }
+    pares.preparar(numHilos);
+    if (256 * numHilos > capacidadCuentas) {
+        delete[] cuentas;
+        capacidadCuentas = 256 * numHilos;
+        cuentas = new unsigned[capacidadCuentas];
+        bytesReservados += (long)capacidadCuentas * sizeof(unsigned);
+    }
+}
+
+void RejillaOrdenada::reservar(int n) {
+    if (n <= capacidad) {
+        return;
+    }
+    delete[] celdaDe;
+    delete[] clave;
+    delete[] indice;
+    delete[] claveAux;
+    delete[] indiceAux;
+    delete[] xs;
+    delete[] ys;
+    delete[] rs;
+    capacidad = n;
+    celdaDe = new unsigned[capacidad];
+    clave = new unsigned[capacidad];
+    indice = new int[capacidad];
+    claveAux = new unsigned[capacidad];
+    indiceAux = new int[capacidad];
+    xs = new Escalar[capacidad];
+    ys = new Escalar[capacidad];
+    rs = new Escalar[capacidad];
+    bytesReservados += (long)capacidad * (3 * sizeof(unsigned) + 2 * sizeof(int) + 3 * sizeof(Escalar));
+}
+
+/**
+ * Ordenación radix LSD de (clave, indice), 8 bits por pasada y sólo las
+ * pasadas que hacen falta para el número de celdas. En cada pasada cada
+ * hilo cuenta los dígitos de su tramo; la suma prefija en orden (dígito,
+ * hilo) da a cada hilo su sitio de escritura, así que el reparto es
+ * estable y no necesita sincronización
+ * @param n Número de partículas
+ * @param pool Hilos (o nullptr)
+ */
+void RejillaOrdenada::ordenar(int n, PoolTrabajo* pool) {
+    unsigned numCeldas = (unsigned)(celdasX * celdasY);
+    int bits = 0;
+    while (bits < 32 && (1u << bits) < numCeldas) {
+        bits++;
+    }
+    int pasadas = (bits + 7) / 8;
+
+    for (int pasada = 0; pasada < pasadas; pasada++) {
+        int desplazamiento = 8 * pasada;
+        enHilos(pool, [&](int h) {
+            unsigned* c = cuentas + 256 * h;
+            for (int d = 0; d < 256; d++) {
+                c[d] = 0;
+            }
+            int desde = (int)((long)n * h / numHilos), hasta = (int)((long)n * (h + 1) / numHilos);
+            for (int k = desde; k < hasta; k++) {
+                c[(clave[k] >> desplazamiento) & 255]++;
+            }
+        });
+
+        unsigned suma = 0;
+        for (int d = 0; d < 256; d++) {
+            for (int h = 0; h < numHilos; h++) {
+                unsigned c = cuentas[256 * h + d];
+                cuentas[256 * h + d] = suma;
+                suma += c;
+            }
+        }
+
+        enHilos(pool, [&](int h) {
+            unsigned* c = cuentas + 256 * h;
+            int desde = (int)((long)n * h / numHilos), hasta = (int)((long)n * (h + 1) / numHilos);
+            for (int k = desde; k < hasta; k++) {
+                unsigned destino = c[(clave[k] >> desplazamiento) & 255]++;
+                claveAux[destino] = clave[k];
+                indiceAux[destino] = indice[k];
+            }
+        });
+
+        unsigned* t = clave;
+        clave = claveAux;
+        claveAux = t;
+        int* u = indice;
+        indice = indiceAux;
+        indiceAux = u;
+    }
+}
+
+/**
+ * Busca los pares que se solapan: celdas, ordenación, inicio de cada celda
+ * y recorrido de las vecinas. Cada hilo trabaja sobre un tramo de índices
+ * y los pares se juntan en orden de hilo, que es el orden serie
+ * @param x Centros X (por columnas)
+ * @param y Centros Y
+ * @param r Radios
+ * @param n Número de círculos
+ * @param pool Hilos (nullptr = en el hilo que llama)
+ * @return Número de pares
+ */
+int RejillaOrdenada::buscarPares(const Escalar* x, const Escalar* y, const Escalar* r, int n, PoolTrabajo* pool) {
+    prepararHilos(pool != nullptr ? pool->getNumHilos() : 1);
+    reservar(n);
+    numPares = 0;
+    candidatos = 0;
+    if (n < 2) {
+        return 0;
+    }
+
+    // Caja envolvente y radio máximo, por tramos
+    const float inf = std::numeric_limits<float>::infinity();
+    enHilos(pool, [&](int h) {
+        Tramo& p = hilos[h];
+        p.minX = p.minY = inf;
+        p.maxX = p.maxY = -inf;
+        p.maxR = 0;
+        int desde = (int)((long)n * h / numHilos), hasta = (int)((long)n * (h + 1) / numHilos);
+        for (int i = desde; i < hasta; i++) {
+            if (x[i] < p.minX) p.minX = x[i];
+            if (x[i] > p.maxX) p.maxX = x[i];
+            if (y[i] < p.minY) p.minY = y[i];
+            if (y[i] > p.maxY) p.maxY = y[i];
+            if (r[i] > p.maxR) p.maxR = r[i];
+        }
+    });
+    float maxX = -inf, maxY = -inf, maxR = 0;
+    minX = minY = inf;
+    for (int h = 0; h < numHilos; h++) {
+        if (hilos[h].minX < minX) minX = hilos[h].minX;
+        if (hilos[h].minY < minY) minY = hilos[h].minY;
+        if (hilos[h].maxX > maxX) maxX = hilos[h].maxX;
+        if (hilos[h].maxY > maxY) maxY = hilos[h].maxY;
+        if (hilos[h].maxR > maxR) maxR = hilos[h].maxR;
+    }
+
+    // Celdas de 2 * radio máximo, con un pequeño margen para que los
+    // redondeos no separen dos círculos que se tocan en celdas no vecinas
+    tamCelda = (maxR > 0) ? 2.0f * maxR * 1.001f : 1.0f;
+    do {
+        celdasX = (int)((maxX - minX) / tamCelda) + 1;
+        celdasY = (int)((maxY - minY) / tamCelda) + 1;
+        if ((long)celdasX * celdasY > MAX_CELDAS_REJILLA) {
+            tamCelda *= 2;
+        }
+    } while ((long)celdasX * celdasY > MAX_CELDAS_REJILLA);
+    int numCeldas = celdasX * celdasY;
+    if (numCeldas + 1 > capacidadCeldas) {
+        delete[] inicio;
+        capacidadCeldas = numCeldas + 1;
+        inicio = new int[capacidadCeldas];
+        bytesReservados += (long)capacidadCeldas * sizeof(int);
+    }
+
+    // Celda de cada partícula
+    enHilos(pool, [&](int h) {
+        int desde = (int)((long)n * h / numHilos), hasta = (int)((long)n * (h + 1) / numHilos);
+        for (int i = desde; i < hasta; i++) {
+            int cx = (int)((x[i] - minX) / tamCelda);
+            int cy = (int)((y[i] - minY) / tamCelda);
+            if (cx >= celdasX) cx = celdasX - 1;
+            if (cy >= celdasY) cy = celdasY - 1;
+            celdaDe[i] = (unsigned)(cy * celdasX + cx);
+            clave[i] = celdaDe[i];
+            indice[i] = i;
+        }
+    });
+
+    ordenar(n, pool);
+
+    // Copia en el orden de las celdas, para recorrer cada celda seguida
+    enHilos(pool, [&](int h) {
+        int desde = (int)((long)n * h / numHilos), hasta = (int)((long)n * (h + 1) / numHilos);
+        for (int k = desde; k < hasta; k++) {
+            xs[k] = x[indice[k]];
+            ys[k] = y[indice[k]];
+            rs[k] = r[indice[k]];
+        }
+    });
+
+    // Inicio de cada celda en el array ordenado
+    int k = 0;
+    for (int c = 0; c < numCeldas; c++) {
+        inicio[c] = k;
+        while (k < n && clave[k] == (unsigned)c) {
+            k++;
+        }
+    }
+    inicio[numCeldas] = n;
+
+    // Vecinas: la misma comparación que colisionesBloque()
+    enHilos(pool, [&](int h) {
+        Tramo& p = hilos[h];
+        p.candidatos = 0;
+        pares.vaciar(h);
+        int desde = (int)((long)n * h / numHilos), hasta = (int)((long)n * (h + 1) / numHilos);
+        for (int i = desde; i < hasta; i++) {
+            int cx = (int)(celdaDe[i] % (unsigned)celdasX), cy = (int)(celdaDe[i] / (unsigned)celdasX);
+            Escalar xi = x[i], yi = y[i], ri = r[i];
+            int primero = pares.getPares(h);
+            for (int vy = (cy > 0 ? cy - 1 : 0); vy <= cy + 1 && vy < celdasY; vy++) {
+                for (int vx = (cx > 0 ? cx - 1 : 0); vx <= cx + 1 && vx < celdasX; vx++) {
+                    int v = vy * celdasX + vx;
+                    for (int q = inicio[v]; q < inicio[v + 1]; q++) {
+                        int j = indice[q];
+                        if (j <= i) {
+                            continue;
+                        }
+                        p.candidatos++;
+                        if (solapan(xs[q] - xi, ys[q] - yi, ri + rs[q])) {
+                            pares.agregar(h, i, j);
+                        }
+                    }
+                }
+            }
+            // Los de i con j creciente (suelen ser pocos: por inserción)
+            int* js = pares.paresJ(h);
+            for (int a = primero + 1; a < pares.getPares(h); a++) {
+                int j = js[a];
+                int b = a - 1;
+                while (b >= primero && js[b] > j) {
+                    js[b + 1] = js[b];
+                    b--;
+                }
+                js[b + 1] = j;
+            }
+        }
+    });
+
+    // Concatenar en orden de hilo = orden serie
+    numPares = pares.total();
+    for (int h = 0; h < numHilos; h++) {
+        candidatos += hilos[h].candidatos;
+    }
+    if (numPares > capacidadPares) {
+        delete[] parI;
+        delete[] parJ;
+        capacidadPares = numPares;
+        parI = new int[capacidadPares];
+        parJ = new int[capacidadPares];
+        bytesReservados += (long)capacidadPares * 2 * sizeof(int);
+    }
+    pares.concatenar(parI, parJ);
+    return numPares;
+}
+
+int RejillaOrdenada::getPares() const {
+    return numPares;
+}
+
+int RejillaOrdenada::getI(int k) const {
+    return parI[k];
+}
+
+int RejillaOrdenada::getJ(int k) const {
+    return parJ[k];
+}
+
+const int* RejillaOrdenada::paresI() const {
+    return parI;
+}
+
+const int* RejillaOrdenada::paresJ() const {
+    return parJ;
+}
+
+long RejillaOrdenada::getCandidatos() const {
+    return candidatos;
+}
+
+int RejillaOrdenada::getCeldasX() const {
+    return celdasX;
+}
+
+int RejillaOrdenada::getCeldasY() const {
+    return celdasY;
+}
+
+float RejillaOrdenada::getTamCelda() const {
+    return tamCelda;
+}
+
+long RejillaOrdenada::getBytesReservados() const {
+    return bytesReservados + pares.getBytesReservados();
+}
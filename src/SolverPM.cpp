@@ -0,0 +1,294 @@
+#include "SolverPM.h"
+#include "Perfilador.h"
+#include <cmath>
+
+/**
+ * Menor potencia de 2 mayor o igual que n (como mínimo 2)
+ */
+static int potenciaDe2(int n) {
+    int p = 2;
+    while (p < n) p *= 2;
+    return p;
+}
+
+/**
+ * Raíces de la unidad exp(-2*pi*i*k/n) para k < n/2, calculadas en double
+ */
+static std::complex<float>* calcularRaices(int n) {
+    std::complex<float>* r = new std::complex<float>[n / 2];
+    for (int k = 0; k < n / 2; k++) {
+        double ang = -2.0 * M_PI * k / n;
+        r[k] = std::complex<float>((float)std::cos(ang), (float)std::sin(ang));
+    }
+    return r;
+}
+
+SolverPM::SolverPM(int celdasX, int celdasY, Contorno contorno, float G, float suavizado,
+                   const ParametrosMundo& mundo)
+    : contorno(contorno), G(G) {
+    nx = potenciaDe2(celdasX);
+    ny = potenciaDe2(celdasY);
+    fx = (contorno == AISLADO) ? 2 * nx : nx;
+    fy = (contorno == AISLADO) ? 2 * ny : ny;
+    hx = mundo.maxX / nx;
+    hy = mundo.maxY / ny;
+
+    verde = new Complejo[(size_t)fx * fy];
+    malla = new Complejo[(size_t)fx * fy];
+    columna = new Complejo[fy];
+    raicesX = calcularRaices(fx);
+    raicesY = calcularRaices(fy);
+    gx = new float[(size_t)nx * ny];
+    gy = new float[(size_t)nx * ny];
+
+    // Por debajo de una celda la malla no resuelve nada: suavizado mínimo
+    float minimo = (hx > hy) ? hx : hy;
+    prepararVerde((suavizado > minimo) ? suavizado : minimo);
+}
+
+SolverPM::~SolverPM() {
+    delete[] verde;
+    delete[] malla;
+    delete[] columna;
+    delete[] raicesX;
+    delete[] raicesY;
+    delete[] gx;
+    delete[] gy;
+}
+
+SolverPM::Contorno SolverPM::contornoPara(int modo) {
+    return (modo == 2) ? PERIODICO : AISLADO;
+}
+
+int SolverPM::getCeldasX() const {
+    return nx;
+}
+
+int SolverPM::getCeldasY() const {
+    return ny;
+}
+
+SolverPM::Contorno SolverPM::getContorno() const {
+    return contorno;
+}
+
+/**
+ * FFT compleja in situ (Cooley-Tukey iterativa, radix 2)
+ * @param a Datos
+ * @param n Tamaño (potencia de 2)
+ * @param raices Raíces exp(-2*pi*i*k/n), k < n/2
+ * @param inversa true para la transformada inversa (sin normalizar)
+ */
+void SolverPM::fft(Complejo* a, int n, const Complejo* raices, bool inversa) {
+    // Permutación por inversión de bits
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            Complejo t = a[i];
+            a[i] = a[j];
+            a[j] = t;
+        }
+    }
+
+    for (int lon = 2; lon <= n; lon <<= 1) {
+        int mitad = lon / 2;
+        int paso = n / lon;
+        for (int i = 0; i < n; i += lon) {
+            for (int k = 0; k < mitad; k++) {
+                Complejo w = inversa ? std::conj(raices[k * paso]) : raices[k * paso];
+                Complejo u = a[i + k];
+                Complejo v = a[i + k + mitad] * w;
+                a[i + k] = u + v;
+                a[i + k + mitad] = u - v;
+            }
+        }
+    }
+}
+
+/**
+ * FFT 2D de la rejilla de tamaño fx*fy. En contorno AISLADO sólo las ny
+ * primeras filas tienen masa, y sólo esas filas del potencial interesan:
+ * la directa empieza por filas (saltando las vacías) y la inversa termina
+ * por filas (calculando sólo las útiles)
+ */
+void SolverPM::fft2D(Complejo* datos, bool inversa) {
+    if (!inversa) {
+        for (int j = 0; j < ny; j++) {
+            fft(datos + (size_t)j * fx, fx, raicesX, false);
+        }
+    }
+
+    for (int i = 0; i < fx; i++) {
+        for (int j = 0; j < fy; j++) {
+            columna[j] = datos[(size_t)j * fx + i];
+        }
+        fft(columna, fy, raicesY, inversa);
+        for (int j = 0; j < fy; j++) {
+            datos[(size_t)j * fx + i] = columna[j];
+        }
+    }
+
+    if (inversa) {
+        for (int j = 0; j < ny; j++) {
+            fft(datos + (size_t)j * fx, fx, raicesX, true);
+        }
+    }
+}
+
+/**
+ * Pesos cloud-in-cell de una coordenada
+ * @param v Coordenada
+ * @param h Tamaño de celda
+ * @param n Celdas en el eje
+ * @param i0 Primera celda (-1 si cae fuera de la rejilla)
+ * @param i1 Segunda celda (-1 si cae fuera de la rejilla)
+ * @param t Peso de la segunda celda (el de la primera es 1 - t)
+ * @return false si ninguna de las dos celdas está en la rejilla
+ */
+bool SolverPM::pesos(float v, float h, int n, int& i0, int& i1, float& t) const {
+    float f = v / h - 0.5f;
+    float base = std::floor(f);
+    t = f - base;
+    i0 = (int)base;
+    i1 = i0 + 1;
+
+    if (contorno == PERIODICO) {
+        i0 = ((i0 % n) + n) % n;
+        i1 = ((i1 % n) + n) % n;
+        return true;
+    }
+    if (i0 < 0 || i0 >= n) i0 = -1;
+    if (i1 < 0 || i1 >= n) i1 = -1;
+    return i0 != -1 || i1 != -1;
+}
+
+/**
+ * Precalcula la transformada de la función de Green. La distancia de cada
+ * celda al origen se toma con la imagen más cercana, de modo que la
+ * convolución circular de la FFT trata bien los desplazamientos negativos
+ * @param suavizado Distancia de suavizado
+ */
+void SolverPM::prepararVerde(float suavizado) {
+    float e2 = suavizado * suavizado;
+    for (int j = 0; j < fy; j++) {
+        float dy = ((j <= fy / 2) ? j : j - fy) * hy;
+        for (int i = 0; i < fx; i++) {
+            float dx = ((i <= fx / 2) ? i : i - fx) * hx;
+            verde[(size_t)j * fx + i] = Complejo(-G / std::sqrt(dx * dx + dy * dy + e2), 0.0f);
+        }
+    }
+
+    // fft2D sólo transforma las ny primeras filas en la directa: aquí todas
+    // las filas tienen datos, así que se transforman a mano
+    for (int j = ny; j < fy; j++) {
+        fft(verde + (size_t)j * fx, fx, raicesX, false);
+    }
+    fft2D(verde, false);
+}
+
+/**
+ * Sustituye (o incrementa) la aceleración de cada partícula por la
+ * gravitatoria calculada en la malla, limitada en módulo a MAX_ACC
+ * @param nube Partículas que se atraen entre sí
+ * @param acumular true para sumar a la aceleración actual
+ */
+void SolverPM::calcular(ConjuntoParticulas& nube, bool acumular) {
+    PERFIL_AMBITO("gravedadPM");
+
+    int n = nube.getUtiles();
+    size_t total = (size_t)fx * fy;
+    for (size_t k = 0; k < total; k++) {
+        malla[k] = 0.0f;
+    }
+
+    // 1) Reparto de masa (cloud-in-cell)
+    for (int p = 0; p < n; p++) {
+        const Particula& part = nube.obtener(p);
+        float m = part.getRadio() * part.getRadio();
+        int i0, i1, j0, j1;
+        float tx, ty;
+        if (!pesos(part.getPos().getX(), hx, nx, i0, i1, tx)) continue;
+        if (!pesos(part.getPos().getY(), hy, ny, j0, j1, ty)) continue;
+
+        if (j0 != -1) {
+            if (i0 != -1) malla[(size_t)j0 * fx + i0] += m * (1 - tx) * (1 - ty);
+            if (i1 != -1) malla[(size_t)j0 * fx + i1] += m * tx * (1 - ty);
+        }
+        if (j1 != -1) {
+            if (i0 != -1) malla[(size_t)j1 * fx + i0] += m * (1 - tx) * ty;
+            if (i1 != -1) malla[(size_t)j1 * fx + i1] += m * tx * ty;
+        }
+    }
+
+    // 2) Potencial: convolución con la función de Green en frecuencias
+    fft2D(malla, false);
+    for (size_t k = 0; k < total; k++) {
+        malla[k] *= verde[k];
+    }
+    fft2D(malla, true);
+    float escala = 1.0f / total;
+
+    // 3) Aceleración = -gradiente del potencial (diferencias centradas;
+    //    en AISLADO, laterales en los bordes)
+    for (int j = 0; j < ny; j++) {
+        for (int i = 0; i < nx; i++) {
+            int ia = i - 1, ib = i + 1, ja = j - 1, jb = j + 1;
+            float sepX = 2 * hx, sepY = 2 * hy;
+            if (contorno == PERIODICO) {
+                ia = (ia + nx) % nx;
+                ib = ib % nx;
+                ja = (ja + ny) % ny;
+                jb = jb % ny;
+            } else {
+                if (ia < 0) ia = 0;
+                if (ib >= nx) ib = nx - 1;
+                if (ja < 0) ja = 0;
+                if (jb >= ny) jb = ny - 1;
+                sepX = (ib - ia) * hx;
+                sepY = (jb - ja) * hy;
+            }
+            float dphix = malla[(size_t)j * fx + ib].real() - malla[(size_t)j * fx + ia].real();
+            float dphiy = malla[(size_t)jb * fx + i].real() - malla[(size_t)ja * fx + i].real();
+            gx[(size_t)j * nx + i] = -dphix * escala / sepX;
+            gy[(size_t)j * nx + i] = -dphiy * escala / sepY;
+        }
+    }
+
+    // 4) Interpolación a las partículas con los mismos pesos
+    for (int p = 0; p < n; p++) {
+        Particula& part = nube.obtener(p);
+        float ax = 0, ay = 0;
+        int i0, i1, j0, j1;
+        float tx, ty;
+        if (pesos(part.getPos().getX(), hx, nx, i0, i1, tx) &&
+            pesos(part.getPos().getY(), hy, ny, j0, j1, ty)) {
+            int is[2] = {i0, i1}, js[2] = {j0, j1};
+            float wx[2] = {1 - tx, tx}, wy[2] = {1 - ty, ty};
+            for (int b = 0; b < 2; b++) {
+                if (js[b] == -1) continue;
+                for (int a = 0; a < 2; a++) {
+                    if (is[a] == -1) continue;
+                    size_t c = (size_t)js[b] * nx + is[a];
+                    ax += wx[a] * wy[b] * gx[c];
+                    ay += wx[a] * wy[b] * gy[c];
+                }
+            }
+        }
+
+        if (acumular) {
+            ax += part.getAcel().getX();
+            ay += part.getAcel().getY();
+        }
+        float mod2 = ax * ax + ay * ay;
+        if (mod2 > MAX_ACC * MAX_ACC) {
+            float f = MAX_ACC / std::sqrt(mod2);
+            ax *= f;
+            ay *= f;
+        }
+        part.setAcel(Vector2D(ax, ay));
+    }
+}
@@ -0,0 +1,131 @@
+#include "ConjuntoParticulas.h"
+#include "PoolTrabajo.h"
+#include "ObstaculosEstaticos.h"
+#include "params.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+
+// Compara los motores de colisiones (todos contra todos, rejilla ordenada
+// con radix y hash espacial incremental), en serie y con el pool, para
+// varios tamaños de nube: tiempo por paso de mover + gestionarColisiones,
+// pares candidatos por paso y si el resultado es idéntico al de todos
+// contra todos en serie. El mundo crece con la nube para que la densidad
+// sea la misma. Al final, obstáculos estáticos: como Particula(1) dentro de
+// la nube frente a ObstaculosEstaticos (árbol SAH aparte).
+
+using namespace std;
+
+struct Resultado {
+    double ms;          // Por paso
+    long candidatos;    // Por paso
+    bool iguales;       // Igual que la referencia
+};
+
+Resultado medir(const ConjuntoParticulas & inicial, const ConjuntoParticulas * referencia,
+                ConjuntoParticulas::MotorColisiones motor, PoolTrabajo * pool, int pasos) {
+    ConjuntoParticulas nube(inicial);
+    nube.setMotorColisiones(motor);
+    // un paso sin medir: los arrays de los motores crecen en la primera llamada
+    nube.mover(1);
+    if (pool != nullptr) nube.gestionarColisiones(*pool);
+    else nube.gestionarColisiones();
+    nube.finPaso();
+    long candidatosPrevios = nube.getEstadisticasTotales().paresCandidatos;
+
+    auto inicio = chrono::steady_clock::now();
+    for (int p = 0; p < pasos; p++) {
+        nube.mover(1);
+        if (pool != nullptr) nube.gestionarColisiones(*pool);
+        else nube.gestionarColisiones();
+        nube.finPaso();
+    }
+    Resultado r;
+    r.ms = chrono::duration<double>(chrono::steady_clock::now() - inicio).count() * 1e3 / pasos;
+    r.candidatos = (nube.getEstadisticasTotales().paresCandidatos - candidatosPrevios) / pasos;
+    r.iguales = true;
+    if (referencia != nullptr) {
+        for (int i = 0; i < nube.getUtiles(); i++) {
+            r.iguales = r.iguales && nube.obtener(i).getPos() == referencia->obtener(i).getPos()
+                                  && nube.obtener(i).getVeloc() == referencia->obtener(i).getVeloc();
+        }
+    }
+    return r;
+}
+
+int main(int argc, char* argv[]) {
+    int maxN = (argc > 1) ? atoi(argv[1]) : 32000;
+    int pasos = (argc > 2) ? atoi(argv[2]) : 10;
+    int numHilos = (argc > 3) ? atoi(argv[3]) : 0;
+    PoolTrabajo pool(numHilos);
+
+    const char * nombres[3] = {"todos", "ordenada", "hash"};
+    cout << "hilos del pool: " << pool.getNumHilos() << endl;
+    cout << setw(8) << "N" << setw(10) << "motor" << setw(8) << "pool"
+         << setw(12) << "ms/paso" << setw(14) << "candidatos" << setw(9) << "igual" << endl;
+
+    for (int n = 1000; n <= maxN; n *= 2) {
+        // densidad de la ventana por defecto con 1000 partículas
+        double escala = sqrt(n / 1000.0);
+        ParametrosMundo mundo(MAX_X * escala, MAX_Y * escala);
+        ConjuntoParticulas inicial(n, mundo);
+
+        // la referencia es todos contra todos en serie (con el paso sin medir)
+        ConjuntoParticulas referencia(inicial);
+        for (int p = 0; p <= pasos; p++) {
+            referencia.mover(1);
+            referencia.gestionarColisiones();
+        }
+
+        for (int m = 0; m < 3; m++) {
+            for (int conPool = 0; conPool < 2; conPool++) {
+                ConjuntoParticulas::MotorColisiones motor = (ConjuntoParticulas::MotorColisiones)m;
+                Resultado r = medir(inicial, &referencia, motor, conPool ? &pool : nullptr, pasos);
+                cout << setw(8) << n << setw(10) << nombres[m] << setw(8) << (conPool ? "si" : "no")
+                     << setw(12) << fixed << setprecision(3) << r.ms
+                     << setw(14) << r.candidatos << setw(9) << (r.iguales ? "si" : "NO") << endl;
+            }
+        }
+    }
+
+    // obstáculos: 2000 partículas móviles y cada vez más obstáculos
+    const int moviles = 2000;
+    cout << endl << setw(8) << "moviles" << setw(12) << "obstaculos"
+         << setw(14) << "en nube ms" << setw(12) << "arbol ms" << endl;
+    for (int numObstaculos = 1000; numObstaculos <= 16000; numObstaculos *= 2) {
+        ConjuntoParticulas conObstaculos(moviles);
+        ConjuntoParticulas sinObstaculos(conObstaculos);
+        conObstaculos.setMotorColisiones(ConjuntoParticulas::REJILLA_ORDENADA);
+        sinObstaculos.setMotorColisiones(ConjuntoParticulas::REJILLA_ORDENADA);
+        ObstaculosEstaticos arbol;
+        for (int k = 0; k < numObstaculos; k++) {
+            Vector2D pos(aleatorio(0, MAX_X), aleatorio(0, MAX_Y));
+            Particula estatica(1);
+            estatica.setPos(pos);
+            conObstaculos.agregar(estatica);
+            arbol.agregar(pos, estatica.getRadio());
+        }
+        arbol.construir();
+
+        auto inicio = chrono::steady_clock::now();
+        for (int p = 0; p < pasos; p++) {
+            conObstaculos.mover(1);
+            conObstaculos.gestionarColisiones();
+        }
+        double msNube = chrono::duration<double>(chrono::steady_clock::now() - inicio).count() * 1e3 / pasos;
+
+        inicio = chrono::steady_clock::now();
+        for (int p = 0; p < pasos; p++) {
+            sinObstaculos.mover(1);
+            sinObstaculos.rebotarObstaculos(arbol);
+            sinObstaculos.gestionarColisiones();
+        }
+        double msArbol = chrono::duration<double>(chrono::steady_clock::now() - inicio).count() * 1e3 / pasos;
+
+        cout << setw(8) << moviles << setw(12) << numObstaculos << setw(14) << fixed << setprecision(3)
+             << msNube << setw(12) << msArbol << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include "ConjuntoParticulas.h"
+#include "NubeCompacta.h"
+#include "PoolTrabajo.h"
+#include "params.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+
+// Compara el paso de una nube grande como ConjuntoParticulas y como
+// NubeCompacta: bytes por partícula, tiempo por paso de mover (con rebote)
+// en serie y con el pool, y distancia media entre las dos nubes al final.
+// El mundo crece con la nube para que la densidad sea la de la ventana por
+// defecto con 1000 partículas.
+
+using namespace std;
+
+template <class Nube>
+double msMover(Nube& nube, PoolTrabajo* pool, int pasos) {
+    auto inicio = chrono::steady_clock::now();
+    for (int p = 0; p < pasos; p++) {
+        if (pool != nullptr) nube.moverParalelo(*pool, 1);
+        else nube.mover(1);
+    }
+    return chrono::duration<double>(chrono::steady_clock::now() - inicio).count() * 1e3 / pasos;
+}
+
+int main(int argc, char* argv[]) {
+    int n = (argc > 1) ? atoi(argv[1]) : 4000000;
+    int pasos = (argc > 2) ? atoi(argv[2]) : 10;
+    int numHilos = (argc > 3) ? atoi(argv[3]) : 0;
+    PoolTrabajo pool(numHilos);
+
+    double escala = sqrt(n / 1000.0);
+    ParametrosMundo mundo(MAX_X * escala, MAX_Y * escala);
+    ConjuntoParticulas nube(n, mundo);
+    NubeCompacta compacta(nube);
+
+    cout << "particulas: " << n << ", hilos del pool: " << pool.getNumHilos() << endl;
+    cout << setw(12) << "formato" << setw(10) << "bytes" << setw(10) << "MB"
+         << setw(14) << "ms serie" << setw(14) << "ms pool" << endl;
+
+    // un paso sin medir en cada una (primer contacto con las páginas)
+    nube.mover(1);
+    compacta.mover(1);
+    double serie = msMover(nube, nullptr, pasos);
+    double paralelo = msMover(nube, &pool, pasos);
+    cout << setw(12) << "particula" << setw(10) << sizeof(Particula)
+         << setw(10) << fixed << setprecision(1) << (double)n * sizeof(Particula) / 1e6
+         << setw(14) << setprecision(3) << serie << setw(14) << paralelo << endl;
+
+    serie = msMover(compacta, nullptr, pasos);
+    paralelo = msMover(compacta, &pool, pasos);
+    cout << setw(12) << "compacta" << setw(10) << NubeCompacta::BYTES_POR_PARTICULA
+         << setw(10) << fixed << setprecision(1) << (double)n * NubeCompacta::BYTES_POR_PARTICULA / 1e6
+         << setw(14) << setprecision(3) << serie << setw(14) << paralelo << endl;
+
+    // las dos nubes han dado los mismos pasos
+    double suma = 0;
+    for (int i = 0; i < n; i++) {
+        suma += (float)nube.obtener(i).getPos().distancia(compacta.obtener(i).getPos());
+    }
+    cout << "distancia media tras " << 2 * pasos + 1 << " pasos: " << setprecision(4) << suma / n
+         << " (paso de posicion " << compacta.getPasoX() << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,97 @@
+
+#include "ConjuntoParticulas.h"
+#include "Gravedad.h"
+#include "SolverPM.h"
+#include "params.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+
+// Compara la suma directa con Barnes-Hut (varios theta) y con el solver
+// partícula-malla (varias rejillas) para varios tamaños de nube: tiempo por
+// llamada y error relativo de la aceleración. PM no incluye el atractor.
+
+using namespace std;
+
+double segundos(MotorGravedad & motor, ConjuntoParticulas & nube, const Particula & atractor, int reps) {
+    auto inicio = chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++)
+        motor.calcular(nube, &atractor, 1);
+    return chrono::duration<double>(chrono::steady_clock::now() - inicio).count() / reps;
+}
+
+double segundos(SolverPM & pm, ConjuntoParticulas & nube, int reps) {
+    auto inicio = chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++)
+        pm.calcular(nube);
+    return chrono::duration<double>(chrono::steady_clock::now() - inicio).count() / reps;
+}
+
+// error relativo en norma L2 sobre toda la nube
+double errorRelativo(ConjuntoParticulas & nube, const Vector2D * referencia) {
+    double err = 0, ref = 0;
+    for (int i = 0; i < nube.getUtiles(); i++) {
+        Vector2D a = nube.obtener(i).getAcel();
+        double dx = a.getX() - referencia[i].getX();
+        double dy = a.getY() - referencia[i].getY();
+        err += dx*dx + dy*dy;
+        ref += referencia[i].getX()*referencia[i].getX() + referencia[i].getY()*referencia[i].getY();
+    }
+    return sqrt(err / ref);
+}
+
+int main(int argc, char* argv[]) {
+    int maxN = (argc > 1) ? atoi(argv[1]) : 16000;
+
+    Particula atractor(1);
+    atractor.setPos(Vector2D(MAX_X/2.0, MAX_Y/2.0));
+    atractor.setRadio(35.0);
+
+    // G pequeña para que MAX_ACC no recorte y el error sea el del método
+    MotorGravedad directo(MotorGravedad::DIRECTO, 1e-3f);
+    MotorGravedad bh(MotorGravedad::BARNES_HUT, 1e-3f);
+
+    // Rejillas del PM, con el mismo suavizado que MotorGravedad
+    SolverPM pm64(64, 64, SolverPM::AISLADO, 1e-3f);
+    SolverPM pm128(128, 128, SolverPM::AISLADO, 1e-3f);
+    SolverPM pm256(256, 256, SolverPM::AISLADO, 1e-3f);
+
+    cout << setw(8) << "N" << setw(10) << "metodo" << setw(14) << "directo ms"
+         << setw(14) << "metodo ms" << setw(12) << "error rel" << endl;
+
+    for (int n = 1000; n <= maxN; n *= 2) {
+        ConjuntoParticulas nube(n);
+        int reps = (n <= 4000) ? 5 : 1;
+
+        double tDirecto = segundos(directo, nube, atractor, reps);
+        Vector2D* referencia = new Vector2D[n];
+        for (int i = 0; i < n; i++)
+            referencia[i] = nube.obtener(i).getAcel();
+
+        for (float theta : {0.3f, 0.5f, 0.8f}) {
+            bh.setTheta(theta);
+            double tBH = segundos(bh, nube, atractor, reps);
+            cout << setw(8) << n << setw(10) << "BH " + to_string(theta).substr(0, 3)
+                 << setw(14) << fixed << setprecision(3) << tDirecto * 1e3
+                 << setw(14) << tBH * 1e3 << setw(12) << scientific << setprecision(2)
+                 << errorRelativo(nube, referencia) << defaultfloat << endl;
+        }
+
+        // Referencia sin el atractor para el PM
+        directo.calcular(nube);
+        for (int i = 0; i < n; i++)
+            referencia[i] = nube.obtener(i).getAcel();
+
+        SolverPM * rejillas[3] = {&pm64, &pm128, &pm256};
+        for (SolverPM * pm : rejillas) {
+            double tPM = segundos(*pm, nube, reps);
+            cout << setw(8) << n << setw(10) << "PM " + to_string(pm->getCeldasX())
+                 << setw(14) << fixed << setprecision(3) << tDirecto * 1e3
+                 << setw(14) << tPM * 1e3 << setw(12) << scientific << setprecision(2)
+                 << errorRelativo(nube, referencia) << defaultfloat << endl;
+        }
+        delete [] referencia;
+    }
+    return 0;
+}
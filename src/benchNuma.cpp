@@ -0,0 +1,135 @@
+#include "ConjuntoParticulas.h"
+#include "Memoria.h"
+#include "PoolTrabajo.h"
+#include "params.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+// Ancho de banda por nodo NUMA: para cada nodo de memoria (el de los hilos
+// que escriben primero el buffer) y cada nodo de hilos (los que lo leen)
+// mide los GB/s de lectura. Después compara moverParalelo sobre una nube
+// creada en el hilo principal con otra reservada con reservar(n, pool).
+// Los hilos se fijan a las CPU de su nodo.
+
+using namespace std;
+
+const int MAX_CPUS = 1024;
+
+// pool con un hilo fijado a cada CPU de la lista
+PoolTrabajo* crearPool(const int* cpus, int n) {
+    PoolTrabajo* pool = new PoolTrabajo(n);
+    pool->enCadaHilo([&](int h) { fijarHilo(cpus[h]); });
+    return pool;
+}
+
+// GB/s leyendo el buffer entero, cada hilo su tramo
+double anchoDeBanda(PoolTrabajo& pool, const float* datos, size_t n, int reps) {
+    int hilos = pool.getNumHilos();
+    float* sumas = new float[hilos];
+    auto inicio = chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++) {
+        pool.enCadaHilo([&](int h) {
+            size_t desde = n * h / hilos, hasta = n * (h + 1) / hilos;
+            float s = 0;
+            for (size_t i = desde; i < hasta; i++)
+                s += datos[i];
+            sumas[h] = s;
+        });
+    }
+    double t = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    // que el compilador no quite la lectura
+    if (sumas[0] == -1.0f) cout << "";
+    delete[] sumas;
+    return (double)n * sizeof(float) * reps / t / 1e9;
+}
+
+double segundosMover(ConjuntoParticulas& nube, PoolTrabajo& pool, int reps) {
+    auto inicio = chrono::steady_clock::now();
+    for (int r = 0; r < reps; r++)
+        nube.moverParalelo(pool, 1);
+    return chrono::duration<double>(chrono::steady_clock::now() - inicio).count() / reps;
+}
+
+int main(int argc, char* argv[]) {
+    size_t mb = (argc > 1) ? atoi(argv[1]) : 512;
+    int N = (argc > 2) ? atoi(argv[2]) : 2000000;
+    int reps = (argc > 3) ? atoi(argv[3]) : 10;
+
+    int nodos = numNodos();
+    int** cpus = new int*[nodos];
+    int* numCpus = new int[nodos];
+    PoolTrabajo** pools = new PoolTrabajo*[nodos];
+    for (int n = 0; n < nodos; n++) {
+        cpus[n] = new int[MAX_CPUS];
+        numCpus[n] = cpusDeNodo(n, cpus[n], MAX_CPUS);
+        pools[n] = (numCpus[n] > 0) ? crearPool(cpus[n], numCpus[n]) : nullptr;
+        cout << "nodo " << n << ": " << numCpus[n] << " CPU" << endl;
+    }
+
+    // 1) Matriz de ancho de banda
+    size_t bytes = mb * 1024 * 1024;
+    size_t n = bytes / sizeof(float);
+    cout << endl << "Lectura (GB/s) de " << mb << " MB, filas = hilos, columnas = memoria" << endl;
+    cout << setw(10) << "";
+    for (int m = 0; m < nodos; m++)
+        cout << setw(10) << ("mem " + to_string(m));
+    cout << endl;
+
+    for (int h = 0; h < nodos; h++) {
+        if (pools[h] == nullptr) continue;
+        cout << setw(10) << ("hilos " + to_string(h));
+        for (int m = 0; m < nodos; m++) {
+            if (pools[m] == nullptr) {
+                cout << setw(10) << "-";
+                continue;
+            }
+            float* datos = static_cast<float*>(reservarPaginas(bytes));
+            int hilosM = pools[m]->getNumHilos();
+            pools[m]->enCadaHilo([&](int k) {
+                size_t desde = n * k / hilosM, hasta = n * (k + 1) / hilosM;
+                memset(static_cast<void*>(datos + desde), 0, (hasta - desde) * sizeof(float));
+            });
+            int nodoReal = nodoDeDireccion(datos);
+            double gbs = anchoDeBanda(*pools[h], datos, n, reps);
+            cout << setw(9) << fixed << setprecision(2) << gbs << ((nodoReal == -1 || nodoReal == m) ? " " : "*");
+            liberarPaginas(datos, bytes);
+        }
+        cout << endl;
+    }
+    cout << "(* = las páginas no quedaron en el nodo pedido)" << endl;
+
+    // 2) moverParalelo con todos los hilos de todos los nodos
+    int total = 0;
+    int* todas = new int[MAX_CPUS];
+    for (int k = 0; k < nodos; k++)
+        for (int c = 0; c < numCpus[k] && total < MAX_CPUS; c++)
+            todas[total++] = cpus[k][c];
+    PoolTrabajo* pool = crearPool(todas, total);
+
+    ConjuntoParticulas principal(N);
+    ConjuntoParticulas repartida;
+    repartida.reservar(N, *pool);
+    for (int i = 0; i < N; i++)
+        repartida.agregar(principal.obtener(i));
+
+    double tPrincipal = segundosMover(principal, *pool, reps);
+    double tRepartida = segundosMover(repartida, *pool, reps);
+    cout << endl << "moverParalelo de " << N << " partículas en " << total << " hilos" << endl
+         << "  memoria tocada por el hilo principal: " << tPrincipal * 1000 << " ms/paso" << endl
+         << "  memoria tocada por cada hilo:         " << tRepartida * 1000 << " ms/paso"
+         << " (" << tPrincipal / tRepartida << "x)" << endl;
+
+    delete pool;
+    delete[] todas;
+    for (int k = 0; k < nodos; k++) {
+        delete pools[k];
+        delete[] cpus[k];
+    }
+    delete[] pools;
+    delete[] cpus;
+    delete[] numCpus;
+    return 0;
+}
@@ -11,15 +11,62 @@
 #include "Particula.h"
 #include "Vector2D.h"
 #include "ConjuntoParticulas.h"
+#include "ConjuntoAtractores.h"
+#include "Interacciones.h"
+#include "Gravedad.h"
+#include "SolverPM.h"
+#include "Emisor.h"
+#include "Ensamble.h"
+#include "MundoInfinito.h"
+#include "Dominio.h"
+#include "Memoria.h"
+#include "Colision.h"
+#include "BuzonParticulas.h"
+#include "TripleBuffer.h"
+#include "Instantanea.h"
+#include "HashEspacial.h"
+#include "RejillaOrdenada.h"
+#include "ObstaculosEstaticos.h"
+#include "NubeCompacta.h"
+#include "Flotante16.h"
+#include "Rasterizador.h"
+#include "EscritorVideo.h"
+#include "Perfilador.h"
+#include <thread>
+#include <atomic>
 #include <cstring>
+#include <fstream>
+#include <new>
+#include <cstdlib>
+#include <type_traits>
 
 using namespace std;
 
+// cuenta las llamadas a new de todo el programa (también las de los hilos
+// del pool), para comprobar que los pasos en caliente no piden memoria
+static atomic<long> reservas(0);
+
+void * operator new(size_t tam){
+	reservas++;
+	void * p = malloc(tam > 0 ? tam : 1);
+	if (p == nullptr)
+		throw bad_alloc();
+	return p;
+}
+
+void operator delete(void * p) noexcept{
+	free(p);
+}
+
+void operator delete(void * p, size_t) noexcept{
+	free(p);
+}
+
 const float EPS = 10e-5;
 
 
 float distancia(const Particula & p1, const Particula & p2){
-  return ((p1.getPos()).distancia(p2.getPos()));
+  return p1.getPos().distancia(p2.getPos());
 
 }
 
@@ -46,6 +93,9 @@ void agregaPart(ConjuntoParticulas & c1, int n){
 
 
 TEST_CASE("Constructores") {
+	// se puede copiar al construir, pero no asignar (compartiría los arrays)
+	static_assert(is_copy_constructible<ConjuntoParticulas>::value, "copia");
+	static_assert(!is_copy_assignable<ConjuntoParticulas>::value, "asignacion");
 
     SUBCASE("Prueba constructores 1") {
 	ConjuntoParticulas c1;
@@ -70,6 +120,22 @@ TEST_CASE("Constructores") {
 		CHECK(distancia(p1,p2) <= EPS);
 	}
     }
+
+    SUBCASE("Particula aleatoria") {
+	// El radio se elige antes que la posición, que deja un margen de 2 radios
+	for (int i = 0; i < 200; i++) {
+		Particula p;
+		float r = (float)p.getRadio();
+		float x = (float)p.getPos().getX();
+		float y = (float)p.getPos().getY();
+		CHECK(r >= MIN_R);
+		CHECK(r <= MAX_R);
+		CHECK(x >= 2*r - EPS);
+		CHECK(x <= MAX_X - 2*r + EPS);
+		CHECK(y >= 2*r - EPS);
+		CHECK(y <= MAX_Y - 2*r + EPS);
+	}
+    }
 	 
 }
 
@@ -144,6 +210,1180 @@ TEST_CASE("Pruebas agregar/borrar") {
 }
 
 
+TEST_CASE("Estadisticas") {
+
+    SUBCASE("Colisiones") {
+	ConjuntoParticulas c1;
+	// tres particulas estaticas en el origen: todas colisionan entre si
+	agregaPart(c1, 3);
+	c1.gestionarColisiones();
+	c1.finPaso();
+	CHECK(c1.getEstadisticasPaso().paresCandidatos == 3);
+	CHECK(c1.getEstadisticasPaso().colisiones == 3);
+	CHECK(c1.getEstadisticasPaso().choques == 3);
+	CHECK(c1.getPasos() == 1);
+    }
+
+    SUBCASE("Absorcion y memoria") {
+	ConjuntoParticulas c1;
+	agregaPart(c1, TAM_BLOQUE + 1);
+	Particula atractor(1);
+	atractor.setRadio(10);
+
+	CHECK(c1.absorber(atractor) == TAM_BLOQUE + 1);
+	CHECK(c1.getUtiles() == 0);
+	c1.finPaso();
+
+	const EstadisticasConjunto & e = c1.getEstadisticasPaso();
+	CHECK(e.absorbidas == TAM_BLOQUE + 1);
+	CHECK(e.redimensiones >= 2);
+	CHECK(e.bytesReservados >= (long)(2*TAM_BLOQUE*sizeof(Particula)));
+
+	// el paso siguiente empieza de cero, los totales se acumulan
+	c1.finPaso();
+	CHECK(c1.getEstadisticasPaso().absorbidas == 0);
+	CHECK(c1.getEstadisticasTotales().absorbidas == TAM_BLOQUE + 1);
+    }
+
+    SUBCASE("Memoria de las colisiones") {
+	// cada motor cuenta sus arrays en el paso en que los pide, y luego no
+	ConjuntoParticulas c1(100);
+	c1.finPaso();
+	long particulas = c1.getEstadisticasTotales().bytesReservados;
+	c1.gestionarColisiones();
+	c1.finPaso();
+	CHECK(c1.getEstadisticasPaso().bytesReservados >= (long)(3*100*sizeof(Escalar)));
+
+	PoolTrabajo pool(2);
+	ConjuntoParticulas::MotorColisiones motores[3] = {ConjuntoParticulas::REJILLA_ORDENADA,
+		ConjuntoParticulas::HASH_ESPACIAL, ConjuntoParticulas::TODOS_CONTRA_TODOS};
+	for(int m = 0; m < 3; m++){
+		c1.setMotorColisiones(motores[m]);
+		if (m == 2)
+			c1.gestionarColisiones(pool);
+		else
+			c1.gestionarColisiones();
+		c1.finPaso();
+		CHECK(c1.getEstadisticasPaso().bytesReservados >= (long)(100*sizeof(int)));
+		if (m == 2)
+			c1.gestionarColisiones(pool);
+		else
+			c1.gestionarColisiones();
+		c1.finPaso();
+		CHECK(c1.getEstadisticasPaso().bytesReservados == 0);
+	}
+	CHECK(c1.getEstadisticasTotales().bytesReservados > particulas + (long)(8*100*sizeof(int)));
+    }
+}
+
+TEST_CASE("Manejadores") {
+
+    SUBCASE("Sobreviven a borrar y redimensionar") {
+	ConjuntoParticulas c1(5);
+	Manejador m[5];
+	Particula p[5];
+	for(int i = 0; i < 5; i++){
+		m[i] = c1.manejador(i);
+		p[i] = c1.obtener(i);
+	}
+
+	// borrar la primera trae la ultima a la posicion 0
+	c1.borrar(0);
+	CHECK(c1.valido(m[0]) == false);
+	CHECK(c1.posicion(m[0]) == -1);
+	CHECK(c1.posicion(m[4]) == 0);
+	for(int i = 1; i < 5; i++)
+		CHECK(distancia(p[i], c1.obtener(m[i])) < EPS);
+
+	// fuerzo redimensiones en ambos sentidos
+	for(int i = 0; i < 2*TAM_BLOQUE; i++)
+		c1.agregar(Particula(1));
+	c1.borrar(m[2]);  // su hueco lo ocupa una de las estaticas
+	for(int i = 0; i < 2*TAM_BLOQUE - 1; i++)
+		c1.borrar(c1.getUtiles() - 1);
+	CHECK(c1.getUtiles() == 4);
+	CHECK(c1.valido(m[2]) == false);
+	for(int i : {1, 3, 4})
+		CHECK(distancia(p[i], c1.obtener(m[i])) < EPS);
+    }
+
+    SUBCASE("Huecos reutilizados") {
+	ConjuntoParticulas c1;
+	Manejador a = c1.agregar(Particula(1));
+	c1.borrar(a);
+	Manejador b = c1.agregar(Particula(1));
+	// mismo hueco, distinta generacion
+	CHECK(a.indice == b.indice);
+	CHECK(c1.valido(a) == false);
+	CHECK(c1.valido(b) == true);
+	c1.borrar(a);
+	CHECK(c1.getUtiles() == 1);
+    }
+
+    SUBCASE("Copia") {
+	ConjuntoParticulas c1(4);
+	Manejador m = c1.manejador(2);
+	ConjuntoParticulas c2(c1);
+	CHECK(distancia(c1.obtener(m), c2.obtener(m)) < EPS);
+    }
+}
+
+TEST_CASE("Atractores") {
+	ConjuntoParticulas c1(300);
+	ConjuntoAtractores atractores;
+	for(int i = 0; i < 20; i++)
+		atractores.agregar(Vector2D(aleatorio(0, MAX_X), aleatorio(0, MAX_Y)), aleatorio(5, 40));
+
+	// resultado esperado comparando cada particula con cada atractor
+	int esperadas = 0;
+	for(int i = 0; i < c1.getUtiles(); i++){
+		bool tocada = false;
+		for(int a = 0; a < atractores.getUtiles(); a++){
+			Particula at(atractores.getPos(a), Vector2D(), Vector2D(), atractores.getRadio(a), 1);
+			tocada = tocada || at.colision(c1.obtener(i));
+		}
+		if (tocada) esperadas++;
+	}
+
+	CHECK(esperadas > 0);
+	CHECK(c1.absorber(atractores) == esperadas);
+	CHECK(c1.getUtiles() == 300 - esperadas);
+	CHECK(c1.absorber(atractores) == 0);
+}
+
+// Error relativo (norma L2) de las aceleraciones de la nube frente a ref
+double errorAcel(ConjuntoParticulas &c, const Vector2D *ref){
+	double err = 0, total = 0;
+	for(int i = 0; i < c.getUtiles(); i++){
+		double dx = (float)c.obtener(i).getAcel().getX() - (float)ref[i].getX();
+		double dy = (float)c.obtener(i).getAcel().getY() - (float)ref[i].getY();
+		double rx = (float)ref[i].getX(), ry = (float)ref[i].getY();
+		err += dx*dx + dy*dy;
+		total += rx*rx + ry*ry;
+	}
+	return sqrt(err / total);
+}
+
+TEST_CASE("Gravedad") {
+	ConjuntoParticulas c1(500);
+	Particula atractor(1);
+	atractor.setPos(Vector2D(MAX_X/2.0, MAX_Y/2.0));
+	atractor.setRadio(35.0);
+
+	// G pequeña para que MAX_ACC no recorte: el error es el del método
+	MotorGravedad directo(MotorGravedad::DIRECTO, 1e-3f);
+	directo.calcular(c1, &atractor, 1);
+	Vector2D *ref = new Vector2D[500];
+	for(int i = 0; i < 500; i++)
+		ref[i] = c1.obtener(i).getAcel();
+
+	// con theta = 0 se abren todos los nodos: es la suma directa, salvo el
+	// orden de las sumas
+	MotorGravedad bh(MotorGravedad::BARNES_HUT, 1e-3f, 0.0f);
+	bh.calcular(c1, &atractor, 1);
+	CHECK(bh.getNumNodos() > 500);
+	CHECK(errorAcel(c1, ref) < 1e-4);
+
+	// con theta = 0.5 el error relativo queda por debajo del 2%
+	bh.setTheta(0.5f);
+	bh.calcular(c1, &atractor, 1);
+	double err = errorAcel(c1, ref);
+	CHECK(err > 0);
+	CHECK(err < 0.02);
+	delete[] ref;
+}
+
+TEST_CASE("SolverPM") {
+	// unos cuerpos separados varias celdas (600/128 = 4.7); G pequeña para
+	// que MAX_ACC no recorte, pero no tanto que la coma fija lo redondee a 0
+	ConjuntoParticulas c1(5);
+	float pos[5][2] = {{150, 150}, {420, 180}, {300, 450}, {120, 400}, {480, 500}};
+	for(int i = 0; i < 5; i++){
+		c1.obtener(i).setPos(Vector2D(pos[i][0], pos[i][1]));
+		c1.obtener(i).setRadio(3 + i);
+	}
+
+	// AISLADO: lo mismo que la suma directa con el mismo suavizado, salvo
+	// el error de la malla
+	MotorGravedad directo(MotorGravedad::DIRECTO, 10.0f, 0.5f, 5.0f);
+	directo.calcular(c1);
+	Vector2D ref[5];
+	for(int i = 0; i < 5; i++)
+		ref[i] = c1.obtener(i).getAcel();
+	SolverPM aislado(128, 128, SolverPM::AISLADO, 10.0f, 5.0f);
+	aislado.calcular(c1);
+	CHECK(errorAcel(c1, ref) < 0.01);
+
+	// PERIODICO: a media caja en X, las dos imágenes del otro cuerpo tiran
+	// lo mismo por cada lado y la fuerza en X se anula
+	ConjuntoParticulas c2(2);
+	for(int i = 0; i < 2; i++){
+		c2.obtener(i).setPos(Vector2D(100 + i * MAX_X/4, 300));
+		c2.obtener(i).setRadio(5);
+	}
+	SolverPM periodico(128, 128, SolverPM::PERIODICO, 10.0f, 5.0f);
+	periodico.calcular(c2);
+	float fuerza = (float)c2.obtener(0).getAcel().getX();
+	CHECK(fuerza > 0);
+	CHECK((float)c2.obtener(1).getAcel().getX() == doctest::Approx(-fuerza).epsilon(0.01));
+
+	c2.obtener(1).setPos(Vector2D(100 + MAX_X/2, 300));
+	periodico.calcular(c2);
+	for(int i = 0; i < 2; i++){
+		CHECK(fabs((float)c2.obtener(i).getAcel().getX()) < 1e-3f * fuerza);
+		CHECK(fabs((float)c2.obtener(i).getAcel().getY()) < 1e-3f * fuerza);
+	}
+}
+
+TEST_CASE("Interacciones") {
+	ConjuntoParticulas c1(3);
+	float xs[3] = {100, 120, 110};
+	int tipos[3] = {0, 1, 5};
+	for(int i = 0; i < 3; i++){
+		c1.obtener(i).setPos(Vector2D(xs[i], 300));
+		c1.obtener(i).setVeloc(Vector2D(0, 0));
+		c1.obtener(i).setTipo(tipos[i]);
+	}
+
+	// el tipo 0 persigue al 1; el 1 ignora al 0; el tipo 5 no cuenta
+	MotorInteracciones motor(2, 40, 1, 0);
+	motor.setFuerza(0, 1, 1);
+	motor.calcular(c1);
+
+	// a distancia 20 (la mitad del alcance) el perfil vale 1 - 0.3/0.7
+	CHECK(c1.obtener(0).getAcel().getX() == doctest::Approx(1 - 0.3/0.7).epsilon(1e-4));
+	CHECK(fabs(c1.obtener(0).getAcel().getY()) <= EPS);
+	CHECK(fabs(c1.obtener(1).getAcel().getX()) <= EPS);
+	CHECK(fabs(c1.obtener(2).getAcel().getX()) <= EPS);
+
+	// en modo wrap la vecina más cercana está al otro lado del borde
+	c1.obtener(0).setPos(Vector2D(5, 300));
+	c1.obtener(1).setPos(Vector2D(MAX_X - 10, 300));
+	motor.calcular(c1);
+	CHECK(fabs(c1.obtener(0).getAcel().getX()) <= EPS);
+	motor.setPeriodico(true);
+	motor.calcular(c1);
+	CHECK(c1.obtener(0).getAcel().getX() < 0);
+}
+
+TEST_CASE("Emisores") {
+	ConjuntoParticulas c1;
+	Emisor emisor(Vector2D(MAX_X/2, MAX_Y/2), 2, 10, 10);
+	c1.reservar(emisor.ocupacionMaxima());
+	CHECK(c1.getCapacidad() == 20);
+
+	// con vida fija la nube se estabiliza en tasa * vida particulas
+	for(int paso = 0; paso < 10; paso++){
+		CHECK(emisor.emitir(c1) == 2);
+		c1.envejecer();
+		c1.finPaso();
+	}
+	CHECK(c1.getUtiles() == 18);
+
+	EstadisticasConjunto antes = c1.getEstadisticasTotales();
+	for(int paso = 0; paso < 50; paso++){
+		emisor.emitir(c1);
+		CHECK(c1.envejecer() == 2);
+		c1.finPaso();
+	}
+	CHECK(c1.getUtiles() == 18);
+	CHECK(c1.getCapacidad() == 20);
+
+	// en regimen estacionario no se reserva memoria
+	EstadisticasConjunto despues = c1.getEstadisticasTotales();
+	CHECK(despues.redimensiones == antes.redimensiones);
+	CHECK(despues.bytesReservados == antes.bytesReservados);
+	CHECK(despues.caducadas - antes.caducadas == 100);
+
+	// sin reserva previa, emitir amplia al doble y no fija la capacidad minima
+	ConjuntoParticulas c2;
+	Emisor rapido(Vector2D(MAX_X/2, MAX_Y/2), 50, 1000, 1000);
+	for(int paso = 0; paso < 40; paso++){
+		rapido.emitir(c2);
+		c2.finPaso();
+	}
+	CHECK(c2.getUtiles() == 2000);
+	CHECK(c2.getCapacidadMinima() == 0);
+	CHECK(c2.getEstadisticasTotales().redimensiones <= 7);
+
+	// las particulas sin vida limitada no caducan
+	c1.agregar(Particula());
+	for(int paso = 0; paso < 20; paso++)
+		c1.envejecer();
+	CHECK(c1.getUtiles() == 1);
+}
+
+TEST_CASE("Ensamble") {
+	// cada indice se ejecuta exactamente una vez, aunque haya robos
+	PoolTrabajo pool(4);
+	const int T = 1000;
+	atomic<int> veces[T];
+	for(int i = 0; i < T; i++)
+		veces[i] = 0;
+	pool.paraCada(T, [&](int i){ veces[i]++; });
+	bool todas = true;
+	for(int i = 0; i < T; i++)
+		todas = todas && veces[i] == 1;
+	CHECK(todas);
+
+	// los resultados dependen solo de los parametros, no del reparto en hilos
+	Ensamble e1, e2;
+	for(int i = 0; i < 12; i++){
+		ParametrosEjecucion p;
+		p.semilla = 1 + i % 6;
+		p.numParticulas = 80;
+		p.pasos = 60;
+		p.modo = 1 + i % 2;
+		e1.agregar(p);
+		e2.agregar(p);
+	}
+	PoolTrabajo uno(1);
+	e1.ejecutar(uno);
+	e2.ejecutar(pool);
+	bool iguales = true;
+	for(int i = 0; i < 12; i++){
+		iguales = iguales && e1.getResumen(i).supervivientes == e2.getResumen(i).supervivientes
+		                  && e1.getResumen(i).colisiones == e2.getResumen(i).colisiones
+		                  && e1.getResumen(i).velocidadMedia == e2.getResumen(i).velocidadMedia;
+	}
+	CHECK(iguales);
+	CHECK(e1.getResumen(0).pasosSimulados > 0);
+	CHECK(e1.getResumen(0).supervivientes < 80);
+}
+
+TEST_CASE("Mundo") {
+	// el mundo de params.h da los mismos movimientos por los dos caminos
+	Particula p1, p2;
+	p2 = p1;
+	ParametrosMundo fijo;
+	CHECK(fijo.esFijo());
+	for(int i = 0; i < 200; i++){
+		p1.mover();
+		p1.rebotar();
+		p2.mover(fijo);
+		p2.rebotar(fijo);
+	}
+	CHECK(distancia(p1, p2) <= EPS);
+
+	// en un mundo reducido las particulas nacen y se quedan dentro
+	ParametrosMundo reducido(200, 100);
+	CHECK(!reducido.esFijo());
+	ConjuntoParticulas c1(100, reducido);
+	for(int paso = 0; paso < 100; paso++)
+		c1.mover(1);
+	bool dentro = true;
+	for(int i = 0; i < c1.getUtiles(); i++){
+		Vector2D pos = c1.obtener(i).getPos();
+		dentro = dentro && pos.getX() >= 0 && pos.getX() <= 200 && pos.getY() >= 0 && pos.getY() <= 100;
+	}
+	CHECK(dentro);
+	CHECK(c1.getMundo().maxX == 200);
+
+	// los motores usan el mundo de la nube, no el de params.h
+	ParametrosMundo ancho(1200, 300);
+	ConjuntoAtractores atractores(ancho);
+	atractores.agregar(Vector2D(900, 150), 10, Vector2D(5, 0));
+	for(int paso = 0; paso < 20; paso++)
+		atractores.mover(1);
+	CHECK(atractores.getPos(0).getX() == 1000);
+
+	ConjuntoParticulas par(0, ancho);
+	par.agregar(Particula(Vector2D(1000, 150), Vector2D(), Vector2D(), 5, 0));
+	par.agregar(Particula(Vector2D(1100, 150), Vector2D(), Vector2D(), 5, 0));
+	SolverPM pm(128, 32, SolverPM::AISLADO, 100.0f, 5.0f, ancho);
+	pm.calcular(par);
+	CHECK(par.obtener(0).getAcel().getX() > 0);
+	CHECK(par.obtener(1).getAcel().getX() < 0);
+
+	// a 10 de distancia dando la vuelta por el borde de 1200
+	ConjuntoParticulas borde(0, ancho);
+	borde.agregar(Particula(Vector2D(5, 150), Vector2D(), Vector2D(), 3, 0));
+	borde.agregar(Particula(Vector2D(1195, 150), Vector2D(), Vector2D(), 3, 0));
+	MotorInteracciones motor(1, 40, 1, 0);
+	motor.setFuerza(0, 0, 1);
+	motor.setPeriodico(true);
+	motor.calcular(borde);
+	CHECK(borde.obtener(0).getAcel().getX() != 0);
+	CHECK(borde.obtener(0).getAcel().getX() == -borde.obtener(1).getAcel().getX());
+}
+
+TEST_CASE("MundoInfinito") {
+	for(int a = 0; a < 2; a++){
+		MundoInfinito mundo(100, 1, a == 0 ? MundoInfinito::MEMORIA : MundoInfinito::DISCO, ".");
+		Vector2D cero(0, 0);
+		mundo.agregar(10.5, 20.25, Particula(cero, cero, cero, 2.0f, 0));
+		mundo.agregar(1003.75, 1050, Particula(cero, cero, cero, 3.0f, 4));
+		mundo.agregar(-0.5, -250, Particula(cero, cero, cero, 2.0f, 0));
+		CHECK(mundo.getTrozos() == 3);
+		CHECK(mundo.trozo(-1, -3) != nullptr);
+
+		// con la camara en el origen solo queda activo el trozo (0, 0)
+		mundo.avanzar(50, 50);
+		CHECK(mundo.getTrozosActivos() == 1);
+		CHECK(mundo.getDescargas() == 2);
+		CHECK(mundo.trozo(10, 10) == nullptr);
+		CHECK(mundo.getParticulas() == 3);
+		CHECK(mundo.getBytesGuardados() > 0);
+
+		// al volver la camara el trozo se recupera con las mismas particulas
+		mundo.avanzar(1050, 1050);
+		const ConjuntoParticulas* t = mundo.trozo(10, 10);
+		REQUIRE(t != nullptr);
+		REQUIRE(t->getUtiles() == 1);
+		CHECK(t->obtener(0).getPos().getX() == 3.75f);
+		CHECK(t->obtener(0).getRadio() == 3.0f);
+		CHECK(t->obtener(0).getTipo() == 4);
+		CHECK(mundo.trozo(0, 0) == nullptr);
+		CHECK(mundo.getCargas() == 1);
+	}
+
+	// las particulas que cruzan un borde pasan al trozo vecino
+	MundoInfinito mundo(100, 2);
+	mundo.agregar(99, 50, Particula(Vector2D(0, 0), Vector2D(0, 0), Vector2D(2, 0), 1.0f, 0));
+	mundo.avanzar(0, 0);
+	REQUIRE(mundo.trozo(1, 0) != nullptr);
+	CHECK(mundo.trozo(0, 0)->getUtiles() == 0);
+	CHECK(mundo.trozo(1, 0)->obtener(0).getPos().getX() == doctest::Approx(1.0f));
+
+	// las que llegan a un trozo guardado esperan a que se recupere, sin
+	// cargarlo ni volver a guardarlo
+	MundoInfinito lejos(100, 0);
+	lejos.agregar(150, 50, Particula(Vector2D(0, 0), Vector2D(0, 0), Vector2D(0, 0), 1.0f, 0));
+	lejos.agregar(99, 50, Particula(Vector2D(0, 0), Vector2D(0, 0), Vector2D(2, 0), 1.0f, 0));
+	lejos.avanzar(50, 50);
+	CHECK(lejos.trozo(1, 0) == nullptr);
+	CHECK(lejos.getDescargas() == 1);
+	for(int p = 0; p < 3; p++){
+		lejos.agregar(98, 50, Particula(Vector2D(0, 0), Vector2D(0, 0), Vector2D(3, 0), 1.0f, 0));
+		lejos.avanzar(50, 50);
+	}
+	CHECK(lejos.trozo(1, 0) == nullptr);
+	CHECK(lejos.getCargas() == 0);
+	CHECK(lejos.getDescargas() == 1);
+	CHECK(lejos.getParticulas() == 5);
+	lejos.avanzar(150, 50);
+	REQUIRE(lejos.trozo(1, 0) != nullptr);
+	CHECK(lejos.trozo(1, 0)->getUtiles() == 5);
+	CHECK(lejos.getCargas() == 1);
+}
+
+TEST_CASE("Dominio") {
+	// las franjas se reparten las particulas sin perder ninguna
+	ConjuntoParticulas c1(300);
+	DescomposicionDominio dominio(3, 300);
+	REQUIRE(dominio.valida());
+	CHECK(dominio.franja(-5) == 0);
+	CHECK(dominio.franja(MAX_X / 2) == 1);
+	CHECK(dominio.franja(MAX_X + 5) == 2);
+	REQUIRE(dominio.ejecutar(c1, 200));
+
+	long migradas = 0, halo = 0;
+	for(int k = 0; k < 3; k++){
+		migradas += dominio.getResumen(k).migradas;
+		halo += dominio.getResumen(k).halo;
+	}
+	CHECK(migradas > 0);
+	CHECK(halo > 0);
+
+	ConjuntoParticulas c2;
+	dominio.recoger(c2);
+	CHECK(c2.getUtiles() == 300);
+	bool dentro = true;
+	for(int i = 0; i < c2.getUtiles(); i++){
+		Vector2D pos = c2.obtener(i).getPos();
+		dentro = dentro && pos.getX() >= 0 && pos.getX() <= MAX_X && pos.getY() >= 0 && pos.getY() <= MAX_Y;
+	}
+	CHECK(dentro);
+
+	// mas particulas que capacidad
+	ConjuntoParticulas c3(301);
+	CHECK(!dominio.ejecutar(c3, 1));
+
+	// quietas junto al borde x = 200: un par lo cruza (una propia y una
+	// copia de halo en cada franja) y el otro es de la franja 0 pero esta
+	// en el halo de la 1. Cada par se cuenta una vez: 2 colisiones y 6
+	// candidatos (todos los pares de 4 particulas)
+	ConjuntoParticulas c4(0);
+	float xs[4] = {195, 203, 190, 198};
+	float ys[4] = {100, 100, 300, 300};
+	for(int i = 0; i < 4; i++)
+		c4.agregar(Particula(Vector2D(xs[i], ys[i]), Vector2D(), Vector2D(), 5, 0));
+	REQUIRE(dominio.ejecutar(c4, 1));
+	long colisiones = 0, candidatos = 0;
+	for(int k = 0; k < 3; k++){
+		colisiones += dominio.getResumen(k).colisiones;
+		candidatos += dominio.getResumen(k).paresCandidatos;
+	}
+	CHECK(colisiones == 2);
+	CHECK(candidatos == 6);
+}
+
+TEST_CASE("Memoria") {
+	// arrays grandes en paginas enormes, alineados
+	void* p = reservarPaginas(3 * TAM_PAGINA_ENORME + 10);
+	CHECK((reinterpret_cast<size_t>(p) % TAM_PAGINA_ENORME) == 0);
+	liberarPaginas(p, 3 * TAM_PAGINA_ENORME + 10);
+
+	// reservar con el pool conserva las particulas y moverParalelo
+	// mueve igual que mover
+	PoolTrabajo pool(4);
+	const int N = 100000;
+	ConjuntoParticulas c1(N);
+	ConjuntoParticulas c2(c1);
+	c1.reservar(N + 10, pool);
+	CHECK(c1.getCapacidad() == N + 10);
+	CHECK(distancia(c1.obtener(N - 1), c2.obtener(N - 1)) == 0);
+	for(int paso = 0; paso < 10; paso++){
+		c1.moverParalelo(pool);
+		c2.mover();
+	}
+	bool iguales = true;
+	for(int i = 0; i < N; i++)
+		iguales = iguales && distancia(c1.obtener(i), c2.obtener(i)) == 0;
+	CHECK(iguales);
+	CHECK(numNodos() >= 1);
+}
+
+TEST_CASE("Vector2D") {
+	// las operaciones sin raiz se evaluan en compilacion
+	constexpr Vector2D a(3, 4), b(1, -2);
+	static_assert((a + b) == Vector2D(4, 2), "suma");
+	static_assert((a - b) * 2.0f == Vector2D(4, 12), "resta y escalado");
+	static_assert(2.0f * -b == Vector2D(-2, 4), "escalado por la izquierda");
+	static_assert(a.producto(b) == -5 && a.cruz(b) == -10, "productos");
+	static_assert(a.distancia2(b) == 40 && a.modulo2() == 25, "cuadrados");
+
+	Vector2D c = a;
+	c += b;
+	c *= 0.5f;
+	CHECK(c == Vector2D(2, 1));
+	c.sumar(Vector2D(1, 3));
+	CHECK(c.modulo() == 5);
+	CHECK(a.distancia(b) == doctest::Approx(std::sqrt(40.0f)));
+	CHECK(a.toString() == "(3,4)");
+}
+
+TEST_CASE("Colision") {
+	// la mascara por bloques coincide con la comprobacion par a par
+	ConjuntoParticulas c1(40);
+	float xs[TAM_BLOQUE_COLISION], ys[TAM_BLOQUE_COLISION], rs[TAM_BLOQUE_COLISION];
+	for(int k = 0; k < TAM_BLOQUE_COLISION; k++){
+		xs[k] = c1.obtener(k).getPos().getX();
+		ys[k] = c1.obtener(k).getPos().getY();
+		rs[k] = c1.obtener(k).getRadio() * 20;
+	}
+	bool iguales = true;
+	for(int i = 0; i < 40; i++){
+		const Particula & p = c1.obtener(i);
+		for(int n = 0; n <= TAM_BLOQUE_COLISION; n += 5){
+			unsigned mascara = colisionesBloque(p.getPos().getX(), p.getPos().getY(), p.getRadio(), xs, ys, rs, n);
+			for(int k = 0; k < n; k++){
+				Particula q(Vector2D(xs[k], ys[k]), Vector2D(), Vector2D(), rs[k], 0);
+				iguales = iguales && (((mascara >> k) & 1) != 0) == p.colision(q);
+			}
+			iguales = iguales && (n == 32 || (mascara >> n) == 0);
+		}
+	}
+	CHECK(iguales);
+
+	// absorber por bloques quita las mismas particulas que una a una
+	ConjuntoParticulas c2(300);
+	Particula atractor(Vector2D(MAX_X/2, MAX_Y/2), Vector2D(), Vector2D(), 150, 1);
+	int quedan = 0;
+	for(int i = 0; i < c2.getUtiles(); i++)
+		quedan += atractor.colision(c2.obtener(i)) ? 0 : 1;
+	c2.absorber(atractor);
+	CHECK(c2.getUtiles() == quedan);
+	bool fuera = true;
+	for(int i = 0; i < c2.getUtiles(); i++)
+		fuera = fuera && !atractor.colision(c2.obtener(i));
+	CHECK(fuera);
+}
+
+TEST_CASE("Vistas") {
+	ConjuntoParticulas c1(20);
+	VistaCampo<Vector2D> pos = c1.vistaPosiciones();
+	VistaCampo<Vector2D> vel = c1.vistaVelocidades();
+	CHECK(pos.getUtiles() == 20);
+	CHECK(!pos.contigua());
+	CHECK(c1.vistaParticulas().contigua());
+
+	// las vistas leen el array, sin copias
+	CHECK(&pos[3] == &c1.obtener(3).getPos());
+	c1.obtener(5).setVeloc(Vector2D(1, 2));
+	CHECK(vel[5] == Vector2D(1, 2));
+
+	int n = 0;
+	float suma = 0;
+	for(const Vector2D & v : c1.vistaAceleraciones()){
+		suma += v.modulo();
+		n++;
+	}
+	CHECK(n == 20);
+	CHECK(suma == 0);
+
+	ConjuntoParticulas vacio;
+	CHECK(vacio.vistaPosiciones().begin() == vacio.vistaPosiciones().end());
+}
+
+TEST_CASE("Colisiones en paralelo") {
+	// mismo resultado que en serie, paso a paso, aunque haya particulas
+	// con varios choques en el mismo paso
+	ParametrosMundo denso(150, 150);
+	ConjuntoParticulas c1(400, denso);
+	ConjuntoParticulas c2(c1);
+	PoolTrabajo pool(4);
+	for(int paso = 0; paso < 20; paso++){
+		c1.mover();
+		c1.gestionarColisiones();
+		c1.finPaso();
+		c2.mover();
+		c2.gestionarColisiones(pool);
+		c2.finPaso();
+	}
+	bool iguales = true;
+	for(int i = 0; i < c1.getUtiles(); i++){
+		iguales = iguales && c1.obtener(i).getVeloc() == c2.obtener(i).getVeloc()
+		                  && c1.obtener(i).getPos() == c2.obtener(i).getPos();
+	}
+	CHECK(iguales);
+	CHECK(c1.getEstadisticasTotales().colisiones > 400);
+	CHECK(c1.getEstadisticasTotales().colisiones == c2.getEstadisticasTotales().colisiones);
+}
+
+TEST_CASE("TripleBuffer") {
+	TripleBuffer<int> buffer;
+	CHECK(!buffer.actualizar());
+
+	// dos publicaciones sin leer: se lee la ultima
+	buffer.escribir() = 1;
+	buffer.publicar();
+	buffer.escribir() = 2;
+	buffer.publicar();
+	CHECK(buffer.actualizar());
+	CHECK(buffer.leer() == 2);
+
+	// sin nada nuevo no cambia
+	CHECK(!buffer.actualizar());
+	CHECK(buffer.leer() == 2);
+	buffer.escribir() = 3;
+	buffer.publicar();
+	CHECK(buffer.actualizar());
+	CHECK(buffer.leer() == 3);
+}
+
+TEST_CASE("Instantanea") {
+	// la particula 0 sale por la derecha y aparece por la izquierda
+	ConjuntoParticulas c1(0);
+	c1.agregar(Particula(Vector2D(598, 100), Vector2D(), Vector2D(6, 0), 3, 0));
+	c1.agregar(Particula(Vector2D(100, 100), Vector2D(), Vector2D(6, 0), 3, 0));
+
+	TripleBuffer<Instantanea> buffer;
+	buffer.escribir().capturar(c1, 0, 0.0);
+	buffer.publicar();
+	REQUIRE(buffer.actualizar());
+	Instantanea anterior = buffer.leer();
+
+	c1.mover(2);
+	buffer.escribir().capturar(c1, 1, 0.1);
+	buffer.publicar();
+	REQUIRE(buffer.actualizar());
+	const Instantanea& actual = buffer.leer();
+	REQUIRE(actual.getUtiles() == 2);
+	CHECK(actual.getX(0) == 3.0f);
+	CHECK(actual.interpolable(anterior));
+	CHECK(!anterior.interpolable(actual));
+
+	// a mitad de intervalo: la que da la vuelta se pinta donde esta y la
+	// otra a medio camino
+	CHECK(Instantanea::interpolar(anterior.getX(0), actual.getX(0), 0.5f, MAX_X) == 3.0f);
+	CHECK(Instantanea::interpolar(anterior.getX(1), actual.getX(1), 0.5f, MAX_X) == doctest::Approx(103.0f));
+	CHECK(Instantanea::interpolar(anterior.getY(1), actual.getY(1), 0.5f, MAX_Y) == doctest::Approx(100.0f));
+
+	// con pasos saltados no se interpola
+	Instantanea saltada;
+	saltada.capturar(c1, 3, 0.3);
+	CHECK(!saltada.interpolable(actual));
+
+	// si desaparece una particula y aparece otra el numero no cambia, pero
+	// la ultima ha pasado al hueco y los indices ya no corresponden
+	c1.borrar(0);
+	c1.agregar(Particula(Vector2D(300, 300), Vector2D(), Vector2D(), 3, 0));
+	Instantanea despues;
+	despues.capturar(c1, 2, 0.2);
+	CHECK(despues.getUtiles() == actual.getUtiles());
+	CHECK(!despues.interpolable(actual));
+
+	// en el paso siguiente, sin cambios, vuelve a ser interpolable
+	Instantanea siguiente;
+	siguiente.capturar(c1, 3, 0.3);
+	CHECK(siguiente.interpolable(despues));
+}
+
+TEST_CASE("Rasterizador") {
+	Rasterizador r(32, 24);
+	r.limpiar(RGBA_RAYWHITE);
+	r.circulo(16, 12, 5, RGBA_RED);
+	const ColorRGBA* px = r.getPixeles();
+
+	// dentro del circulo
+	CHECK(px[12 * 32 + 16] == RGBA_RED);
+	CHECK(px[12 * 32 + 12] == RGBA_RED);
+	CHECK(px[12 * 32 + 19] == RGBA_RED);
+	CHECK(px[9 * 32 + 16] == RGBA_RED);
+	CHECK(px[15 * 32 + 16] == RGBA_RED);
+	// fuera: a mas de un radio y en las esquinas de su caja
+	CHECK(px[12 * 32 + 9] == RGBA_RAYWHITE);
+	CHECK(px[12 * 32 + 23] == RGBA_RAYWHITE);
+	CHECK(px[5 * 32 + 16] == RGBA_RAYWHITE);
+	CHECK(px[7 * 32 + 11] == RGBA_RAYWHITE);
+	CHECK(px[17 * 32 + 21] == RGBA_RAYWHITE);
+	CHECK(px[0] == RGBA_RAYWHITE);
+
+	// los circulos que se salen se recortan
+	r.circulo(0, 0, 4, RGBA_BLUE);
+	CHECK(px[0] == RGBA_BLUE);
+	CHECK(px[23 * 32 + 31] == RGBA_RAYWHITE);
+}
+
+TEST_CASE("EscritorVideo") {
+	Rasterizador r(32, 24);
+	r.limpiar(RGBA_RAYWHITE);
+	r.circulo(16, 12, 5, RGBA_RED);
+	const char* ruta = "prueba_video.y4m";
+	{
+		EscritorVideo video(ruta, 32, 24, 30);
+		REQUIRE(video.abierto());
+		CHECK(video.escribir(r));
+		CHECK(video.escribir(r));
+		Rasterizador otro(16, 16);
+		CHECK(!video.escribir(otro));
+		CHECK(video.getFotogramas() == 2);
+	}
+	EscritorVideo impar("-", 31, 24, 30);
+	CHECK(!impar.abierto());
+
+	// cabecera y dos fotogramas de "FRAME\n" + Y + U/4 + V/4
+	FILE* f = fopen(ruta, "rb");
+	REQUIRE(f != nullptr);
+	char contenido[4096];
+	size_t tam = fread(contenido, 1, sizeof(contenido), f);
+	fclose(f);
+	remove(ruta);
+	string cabecera = "YUV4MPEG2 W32 H24 F30:1 Ip A1:1 C420jpeg\n";
+	size_t fotograma = 6 + 32 * 24 * 3 / 2;
+	REQUIRE(tam == cabecera.size() + 2 * fotograma);
+	CHECK(string(contenido, cabecera.size()) == cabecera);
+	CHECK(string(contenido + cabecera.size(), 6) == "FRAME\n");
+	CHECK(string(contenido + cabecera.size() + fotograma, 6) == "FRAME\n");
+
+	// luminancia BT.601 del fondo y del centro del circulo
+	const unsigned char* y = reinterpret_cast<const unsigned char*>(contenido + cabecera.size() + 6);
+	CHECK(y[0] == 245);
+	CHECK(y[12 * 32 + 16] == 99);
+}
+
+TEST_CASE("Perfilador") {
+	// en un hilo nuevo, para que su registro no tenga frames de otras
+	// pruebas; 100 frames con duraciones conocidas (1..100 ticks, en
+	// desorden) sin pasar por las macros
+	Perfilador::activarTraza(64);
+	int fase = Perfilador::fase("prueba perfilador");
+	uint64_t p50 = 0, p99 = 0, maximo = 0;
+	thread medidor([&](){
+		Perfilador& p = Perfilador::hilo();
+		for(int k = 0; k < 100; k++){
+			uint64_t duracion = (uint64_t)(k * 37 % 100 + 1);
+			p.acumular(fase, 1000 * k, 1000 * k + duracion);
+			p.finFrame();
+		}
+		p50 = p.percentil(fase, 50);
+		p99 = p.percentil(fase, 99);
+		maximo = p.percentil(fase, 100);
+	});
+	medidor.join();
+	Perfilador::activarTraza(0);
+	CHECK(p50 == 50);
+	CHECK(p99 == 99);
+	CHECK(maximo == 100);
+	CHECK(Perfilador::informe().find("prueba perfilador") != string::npos);
+
+	// la traza guarda como mucho 64 eventos por hilo, uno por linea
+	const char* ruta = "prueba_traza.json";
+	REQUIRE(Perfilador::exportarTraza(ruta));
+	ifstream traza(ruta);
+	string linea, todo;
+	int eventos = 0;
+	while(getline(traza, linea)){
+		todo += linea;
+		if (linea.find("\"name\":\"prueba perfilador\"") != string::npos) eventos++;
+	}
+	traza.close();
+	remove(ruta);
+	CHECK(eventos == 64);
+	CHECK(todo.find("{\"traceEvents\":[") == 0);
+	CHECK(todo.find("],\"displayTimeUnit\":\"ms\"}") != string::npos);
+}
+
+TEST_CASE("Buzon") {
+	ConjuntoParticulas c;
+	BuzonParticulas buzon(8192);
+
+	// varios hilos piden altas a la vez; se aplican todas en bloque
+	std::thread hilos[4];
+	for(int h = 0; h < 4; h++){
+		hilos[h] = std::thread([&buzon, h](){
+			for(int i = 0; i < 1000; i++)
+				buzon.pedirAlta(Particula(Vector2D(h, i), Vector2D(), Vector2D(), 3, h));
+		});
+	}
+	for(int h = 0; h < 4; h++)
+		hilos[h].join();
+	CHECK(c.getUtiles() == 0);
+	CHECK(buzon.aplicar(c) == 4000);
+	CHECK(c.getUtiles() == 4000);
+	CHECK(buzon.getRechazadas() == 0);
+
+	int porTipo[4] = {0, 0, 0, 0};
+	for(int i = 0; i < c.getUtiles(); i++)
+		porTipo[c.obtener(i).getTipo()]++;
+	CHECK(porTipo[0] == 1000);
+	CHECK(porTipo[3] == 1000);
+
+	// bajas de la mitad; las repetidas y las no válidas se ignoran
+	Manejador m[2000];
+	for(int i = 0; i < 2000; i++)
+		m[i] = c.manejador(2 * i);
+	for(int i = 0; i < 2000; i++)
+		buzon.pedirBaja(m[i]);
+	buzon.pedirBaja(m[0]);
+	CHECK(buzon.aplicar(c) == 2000);
+	CHECK(c.getUtiles() == 2000);
+	CHECK_FALSE(c.valido(m[0]));
+	CHECK(buzon.getBajas() == 2000);
+	CHECK(buzon.getAltas() == 4000);
+
+	// con la cola llena se rechaza sin esperar
+	BuzonParticulas pequeno(4);
+	int aceptadas = 0;
+	for(int i = 0; i < 10; i++)
+		aceptadas += pequeno.pedirAlta(Particula()) ? 1 : 0;
+	CHECK(aceptadas == 4);
+	CHECK(pequeno.getRechazadas() == 6);
+	CHECK(pequeno.aplicar(c) == 4);
+	CHECK(c.getUtiles() == 2004);
+}
+
+// Comprueba que cada partícula está en el hash y que las candidatas de un
+// radio incluyen a todas las que están a esa distancia
+bool hashCoherente(const ConjuntoParticulas & c, float radio){
+	const HashEspacial * h = c.getHash();
+	if (h->getNumElementos() != c.getUtiles())
+		return false;
+	for(int i = 0; i < c.getUtiles(); i += 7){
+		const Vector2D & p = c.obtener(i).getPos();
+		int encontradas = 0;
+		bool esta = false;
+		h->paraCadaCandidata(p.getX(), p.getY(), radio, [&](int j){
+			if (j == i) esta = true;
+			if (p.distancia(c.obtener(j).getPos()) <= radio) encontradas++;
+		});
+		int cerca = 0;
+		for(int j = 0; j < c.getUtiles(); j++)
+			if (p.distancia(c.obtener(j).getPos()) <= radio) cerca++;
+		if (!esta || encontradas != cerca)
+			return false;
+	}
+	return true;
+}
+
+TEST_CASE("Hash espacial") {
+	ConjuntoParticulas c(2000);
+	c.activarHash(4 * MAX_R);
+	CHECK(hashCoherente(c, 4 * MAX_R));
+
+	for(int paso = 0; paso < 20; paso++){
+		int antes[2000][2];
+		for(int i = 0; i < c.getUtiles(); i++){
+			antes[i][0] = c.getHash()->getCeldaX(i);
+			antes[i][1] = c.getHash()->getCeldaY(i);
+		}
+		c.mover(1);
+		c.finPaso();
+		int cambios = 0;
+		for(int i = 0; i < c.getUtiles(); i++)
+			if (antes[i][0] != c.getHash()->getCeldaX(i) || antes[i][1] != c.getHash()->getCeldaY(i))
+				cambios++;
+		CHECK(c.getEstadisticasPaso().cambiosCelda == cambios);
+		CHECK(cambios < c.getUtiles() / 2);
+	}
+	CHECK(c.getEstadisticasTotales().cambiosCelda > 0);
+	CHECK(hashCoherente(c, 4 * MAX_R));
+
+	// las altas y bajas lo mantienen al día
+	for(int i = 0; i < 500; i++)
+		c.borrar(i * 3);
+	c.agregar(Particula(Vector2D(10, 10), Vector2D(), Vector2D(), 3, 0));
+	Particula nuevas[100];
+	c.agregar(nuevas, 100);
+	c.reemplazar(0, Particula(Vector2D(MAX_X - 5, MAX_Y - 5), Vector2D(), Vector2D(), 3, 0));
+	c.envejecer();
+	CHECK(c.getUtiles() == 1601);
+	CHECK(hashCoherente(c, 4 * MAX_R));
+	CHECK(hashCoherente(c, 1.5f));
+
+	// fuera del mundo (sin límites) también vale
+	c.agregar(Particula(Vector2D(-1000, 5000), Vector2D(), Vector2D(), 3, 0));
+	CHECK(hashCoherente(c, 4 * MAX_R));
+
+	c.desactivarHash();
+	CHECK(c.getHash() == nullptr);
+}
+
+TEST_CASE("Motores de colisiones") {
+	// todos los motores dan exactamente el resultado de todos contra todos
+	ParametrosMundo denso(300, 200);
+	ConjuntoParticulas c1(1200, denso);
+	ConjuntoParticulas c2(c1), c3(c1), c4(c1);
+	c2.setMotorColisiones(ConjuntoParticulas::REJILLA_ORDENADA);
+	c3.setMotorColisiones(ConjuntoParticulas::HASH_ESPACIAL);
+	c4.setMotorColisiones(ConjuntoParticulas::REJILLA_ORDENADA);
+	CHECK(c2.getMotorColisiones() == ConjuntoParticulas::REJILLA_ORDENADA);
+	PoolTrabajo pool(3);
+	ConjuntoParticulas * c[4] = {&c1, &c2, &c3, &c4};
+	for(int paso = 0; paso < 15; paso++){
+		for(int k = 0; k < 4; k++){
+			c[k]->mover(paso < 10 ? 1 : 0);
+			if (k == 3)
+				c[k]->gestionarColisiones(pool);
+			else
+				c[k]->gestionarColisiones();
+			c[k]->finPaso();
+		}
+	}
+	for(int k = 1; k < 4; k++){
+		bool iguales = true;
+		for(int i = 0; i < c1.getUtiles(); i++){
+			iguales = iguales && c1.obtener(i).getVeloc() == c[k]->obtener(i).getVeloc()
+			                  && c1.obtener(i).getPos() == c[k]->obtener(i).getPos();
+		}
+		CHECK(iguales);
+		CHECK(c[k]->getEstadisticasTotales().colisiones == c1.getEstadisticasTotales().colisiones);
+		CHECK(c[k]->getEstadisticasTotales().paresCandidatos < c1.getEstadisticasTotales().paresCandidatos / 4);
+	}
+	CHECK(c1.getEstadisticasTotales().colisiones > 1000);
+	CHECK(c3.getHash() != nullptr);
+
+	// la rejilla sale igual con cualquier número de hilos
+	RejillaOrdenada r1, r2;
+	Escalar x[5] = {0, 5, 1000, 1003, -50};
+	Escalar y[5] = {0, 0, 1000, 1000, 7};
+	Escalar r[5] = {3, 3, 2, 2, 1};
+	CHECK(r1.buscarPares(x, y, r, 5) == 2);
+	CHECK(r2.buscarPares(x, y, r, 5, &pool) == 2);
+	CHECK(r1.getI(0) == 0);
+	CHECK(r1.getJ(0) == 1);
+	CHECK(r2.getI(1) == 2);
+	CHECK(r2.getJ(1) == 3);
+	CHECK(r1.getTamCelda() >= 6);
+}
+
+TEST_CASE("Sin reservas en caliente") {
+	// tras calentar, un paso de colisiones no llama a new con ningún motor,
+	// ni en serie ni en el pool (las partículas no se mueven: mismos pares)
+	ParametrosMundo denso(300, 200);
+	ConjuntoParticulas c1(1200, denso);
+	ConjuntoParticulas c2(c1), c3(c1), c4(c1);
+	c2.setMotorColisiones(ConjuntoParticulas::REJILLA_ORDENADA);
+	c4.setMotorColisiones(ConjuntoParticulas::REJILLA_ORDENADA);
+	PoolTrabajo pool(3);
+	ConjuntoParticulas * c[4] = {&c1, &c2, &c3, &c4};
+	for(int k = 0; k < 4; k++){
+		for(int paso = 0; paso < 3; paso++){
+			if (k >= 2)
+				c[k]->gestionarColisiones(pool);
+			else
+				c[k]->gestionarColisiones();
+			c[k]->finPaso();
+		}
+		long antes = reservas;
+		for(int paso = 0; paso < 10; paso++){
+			if (k >= 2)
+				c[k]->gestionarColisiones(pool);
+			else
+				c[k]->gestionarColisiones();
+			c[k]->finPaso();
+		}
+		long pedidas = reservas - antes;
+		CHECK(pedidas == 0);
+	}
+	CHECK(c2.getEstadisticasTotales().colisiones > 0);
+}
+
+TEST_CASE("Obstaculos") {
+	ObstaculosEstaticos obs;
+	for(int i = 0; i < 3000; i++)
+		obs.agregar(Vector2D(aleatorio(0, 2000), aleatorio(0, 2000)), aleatorio(2, 8));
+	obs.construir();
+	CHECK(obs.getUtiles() == 3000);
+	CHECK(obs.getNodos() < 2 * 3000);
+	CHECK(obs.getProfundidad() < 30);
+
+	// la consulta encuentra exactamente los que se solapan
+	bool iguales = true;
+	for(int q = 0; q < 300; q++){
+		float px = aleatorio(0, 2000), py = aleatorio(0, 2000), pr = aleatorio(1, 20);
+		int enArbol = 0, fuerza = 0;
+		obs.paraCadaSolapado(px, py, pr, [&](int){ enArbol++; });
+		for(int k = 0; k < obs.getUtiles(); k++){
+			float dx = obs.getPos(k).getX() - px, dy = obs.getPos(k).getY() - py;
+			float s = pr + obs.getRadio(k);
+			if (dx*dx + dy*dy < s*s) fuerza++;
+		}
+		iguales = iguales && enArbol == fuerza;
+	}
+	CHECK(iguales);
+
+	// rebote: se refleja la componente normal si se acerca; si se aleja, nada
+	ObstaculosEstaticos uno;
+	uno.agregar(Vector2D(100, 100), 10);
+	uno.construir();
+	Particula p(Vector2D(88, 100), Vector2D(), Vector2D(3, 2), 3, 0);
+	CHECK(uno.rebotar(p) == 1);
+	CHECK(p.getVeloc() == Vector2D(-3, 2));
+	CHECK(uno.rebotar(p) == 0);
+	CHECK(p.getVeloc() == Vector2D(-3, 2));
+	Particula lejos(Vector2D(50, 50), Vector2D(), Vector2D(3, 2), 3, 0);
+	CHECK(uno.rebotar(lejos) == 0);
+
+	// en la nube: los obstáculos no se mueven ni se roban la velocidad
+	ConjuntoParticulas c(500);
+	ObstaculosEstaticos muro;
+	for(int k = 0; k < 60; k++)
+		muro.agregar(Vector2D(MAX_X / 2.0f, k * 10.0f), 6);
+	muro.construir();
+	for(int paso = 0; paso < 100; paso++){
+		c.mover(1);
+		c.rebotarObstaculos(muro);
+		c.finPaso();
+	}
+	CHECK(c.getEstadisticasTotales().rebotesObstaculo > 0);
+	CHECK(muro.getPos(0).getX() == MAX_X / 2.0f);
+
+	ObstaculosEstaticos vacio;
+	vacio.construir();
+	CHECK(vacio.rebotar(p) == 0);
+}
+
+TEST_CASE("Coma fija") {
+	// aritmética Q16.16
+	CHECK(Fijo(1.5) * Fijo(2) == Fijo(3));
+	CHECK(Fijo(7) / Fijo(2) == Fijo(3.5));
+	CHECK(Fijo(1) / Fijo(0) == Fijo::desdeBruto(INT32_MAX));
+	CHECK(-Fijo(2.25) + Fijo(0.25) == Fijo(-2));
+	CHECK(sqrt(Fijo(4)) == Fijo(2));
+	CHECK(abs(Fijo(-3)) == Fijo(3));
+	CHECK(Fijo(0.5).getBruto() == 32768);
+	CHECK(Fijo(3) * 2 == Fijo(6));
+	CHECK((float)Fijo(-0.75) == -0.75f);
+	CHECK(hipotenusa(Fijo(300), Fijo(400)) == Fijo(500));
+	CHECK(Vector2DT<Fijo>(3, 4).modulo() == Fijo(5));
+	CHECK(solapan(Fijo(3), Fijo(4), Fijo(5.01)));
+	CHECK(!solapan(Fijo(3), Fijo(4), Fijo(5)));
+
+	// nube sin rand(): una rejilla de partículas con velocidades fijas
+	ParametrosMundo denso(200, 150);
+	ConjuntoParticulas a(0, denso);
+	for(int i = 0; i < 400; i++){
+		Vector2D pos(5 + (i % 20) * 9.5f, 5 + (i / 20) * 7.0f);
+		Vector2D veloc((i % 7) - 3, (i % 5) - 2);
+		a.agregar(Particula(pos, Vector2D(), veloc, 2 + (i % 3) * 0.5f, 0));
+	}
+	ConjuntoParticulas b(a), c(a);
+	c.setMotorColisiones(ConjuntoParticulas::REJILLA_ORDENADA);
+	CHECK(a.hashEstado() == b.hashEstado());
+	PoolTrabajo pool(3);
+	for(int paso = 0; paso < 30; paso++){
+		a.mover(1);
+		a.gestionarColisiones();
+		b.mover(1);
+		b.gestionarColisiones(pool);
+		c.mover(1);
+		c.gestionarColisiones(pool);
+		a.finPaso();
+		CHECK(a.hashEstado() == b.hashEstado());
+		CHECK(a.hashEstado() == c.hashEstado());
+	}
+	CHECK(a.getEstadisticasTotales().colisiones > 100);
+#ifdef SIMULACION_FIJA
+	// la misma huella en cualquier máquina y con cualquier compilador
+	// (comprobada con -O0, -O2 -march=native y -O3 -ffast-math)
+	CHECK(a.hashEstado() == 3790471326772931892ULL);
+#endif
+}
+
+TEST_CASE("Nube compacta") {
+	// flotantes de 16 bits
+	CHECK(aFlotante16(1.0f) == 0x3C00);
+	CHECK(deFlotante16(aFlotante16(-2.5f)) == -2.5f);
+	CHECK(deFlotante16(aFlotante16(65504.0f)) == 65504.0f);
+	CHECK(aFlotante16(70000.0f) == 0x7C00);
+	CHECK(fabs(deFlotante16(aFlotante16(0.1f)) - 0.1f) < 1e-4f);
+	CHECK(deFlotante16(aFlotante16(1e-7f)) > 0.0f);
+
+	CHECK(NubeCompacta::BYTES_POR_PARTICULA == 14);
+	CHECK(2 * NubeCompacta::BYTES_POR_PARTICULA <= (int)sizeof(Particula));
+
+	// compresión de una partícula
+	NubeCompacta vacia;
+	vacia.agregar(Particula(Vector2D(100.3f, 200.7f), Vector2D(0.5f, -0.25f), Vector2D(3, -6.5f), MAX_R, 1));
+	Particula q = vacia.obtener(0);
+	CHECK(fabs((float)q.getPos().getX() - 100.3f) <= vacia.getPasoX() / 2 + 1e-4f);
+	CHECK(fabs((float)q.getPos().getY() - 200.7f) <= vacia.getPasoY() / 2 + 1e-4f);
+	CHECK(q.getVeloc() == Vector2D(3, -6.5f));
+	CHECK(q.getAcel() == Vector2D(0.5f, -0.25f));
+	CHECK(q.getRadio() == MAX_R);
+	CHECK(q.getTipo() == 1);
+
+	// sigue de cerca al conjunto sin comprimir (las 3 últimas van por el
+	// bucle escalar)
+	ConjuntoParticulas c(2003);
+	NubeCompacta n1(c), n2(c);
+	CHECK(n1.getUtiles() == 2003);
+	PoolTrabajo pool(3);
+	for(int paso = 0; paso < 20; paso++){
+		c.mover(1);
+		n1.mover(1);
+		n2.moverParalelo(pool, 1);
+	}
+	int cerca = 0;
+	bool iguales = true;
+	for(int i = 0; i < 2003; i++){
+		Particula a = n1.obtener(i), b = n2.obtener(i);
+		iguales = iguales && a.getPos() == b.getPos() && a.getVeloc() == b.getVeloc();
+		if ((float)c.obtener(i).getPos().distancia(a.getPos()) < 0.5f)
+			cerca++;
+	}
+	CHECK(iguales);
+	CHECK(cerca > 1980);
+
+	// mismos choques que el conjunto con la rejilla ordenada
+	ConjuntoParticulas d(0, n1.getMundo());
+	n1.volcar(d);
+	d.setMotorColisiones(ConjuntoParticulas::REJILLA_ORDENADA);
+	d.gestionarColisiones();
+	d.finPaso();
+	int colisiones = n1.gestionarColisiones(&pool);
+	CHECK(colisiones > 0);
+	CHECK(colisiones == d.getEstadisticasPaso().colisiones);
+	iguales = true;
+	for(int i = 0; i < 2003; i++){
+		iguales = iguales && n1.obtener(i).getVeloc() == d.obtener(i).getVeloc()
+		                  && n1.obtener(i).getAcel() == d.obtener(i).getAcel();
+	}
+	CHECK(iguales);
+}
+
 TEST_CASE("Varios") {
 	const int N = 10;
 	ConjuntoParticulas *v = new ConjuntoParticulas[N];
@@ -0,0 +1,49 @@
+#include "Dominio.h"
+#include "params.h"
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+// Descomposición del mundo en franjas, una por proceso. Simula la misma nube
+// con 1, 2, 4... procesos hasta el máximo pedido y muestra el tiempo total,
+// el de cada franja y las partículas migradas y de halo.
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    if (argc < 3){
+        cerr << "USO: testDominio <nro particulas> <pasos> [max procesos]" << endl;
+        exit(-1);
+    }
+    int N = atoi(argv[1]);
+    int pasos = atoi(argv[2]);
+    int maxProcesos = (argc > 3) ? atoi(argv[3]) : 4;
+
+    // Mundo proporcional a la nube, para que la densidad no dependa de N
+    float lado = 600.0f * sqrt(N / 500.0f);
+    ParametrosMundo mundo(lado, lado);
+    ConjuntoParticulas nube(N, mundo);
+
+    for (int procesos = 1; procesos <= maxProcesos; procesos *= 2) {
+        DescomposicionDominio dominio(procesos, N, mundo);
+        if (!dominio.valida()) {
+            cerr << "No se puede crear la memoria compartida" << endl;
+            return 1;
+        }
+        auto inicio = chrono::steady_clock::now();
+        if (!dominio.ejecutar(nube, pasos)) {
+            cerr << "Falló la simulación con " << procesos << " procesos" << endl;
+            return 1;
+        }
+        double total = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+        cout << procesos << " procesos: " << total << " s" << endl;
+        for (int k = 0; k < procesos; k++) {
+            const ResumenFranja& r = dominio.getResumen(k);
+            cout << "  franja " << k << ": " << r.particulas << " particulas, "
+                 << r.segundos << " s, " << r.migradas << " migradas, "
+                 << r.halo << " de halo, " << r.colisiones << " colisiones" << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+#include "Ensamble.h"
+#include "PoolTrabajo.h"
+#include "params.h"
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+// Barrido de parámetros: muchas nubes pequeñas e independientes repartidas
+// en un pool de hilos, con una fila de resultados por ejecución en un CSV.
+// Se varían la semilla, el modo (rebotar/wrap), el radio del agujero negro
+// y el tamaño del mundo.
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    if (argc < 3){
+        cerr << "USO: testEnsamble <ejecuciones> <salida.csv> [hilos] [nro particulas] [pasos]" << endl
+             << "     hilos = 0 usa un hilo por núcleo" << endl;
+        exit(-1);
+    }
+    int K = atoi(argv[1]);
+    string ruta = argv[2];
+    int hilos = (argc > 3) ? atoi(argv[3]) : 0;
+    int N = (argc > 4) ? atoi(argv[4]) : 500;
+    int pasos = (argc > 5) ? atoi(argv[5]) : 1000;
+
+    Ensamble ensamble;
+    for (int i = 0; i < K; i++) {
+        ParametrosEjecucion p;
+        p.semilla = i + 1;
+        p.numParticulas = N;
+        p.pasos = pasos;
+        p.modo = 1 + i % 2;
+        p.radioAtractor = 10.0f + 10.0f * ((i / 2) % 5);
+        float lado = 400.0f + 100.0f * ((i / 10) % 3);
+        p.mundo = ParametrosMundo(lado, lado);
+        ensamble.agregar(p);
+    }
+
+    PoolTrabajo pool(hilos);
+    auto inicio = chrono::steady_clock::now();
+    ensamble.ejecutar(pool);
+    double total = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+
+    double suma = 0;
+    for (int i = 0; i < ensamble.getUtiles(); i++)
+        suma += ensamble.getResumen(i).segundos;
+
+    cout << K << " ejecuciones en " << pool.getNumHilos() << " hilos: " << total << " s"
+         << " (suma de ejecuciones " << suma << " s, aceleración " << suma / total << "x, "
+         << pool.getRobos() << " robos)" << endl;
+
+    if (!ensamble.volcarCSV(ruta)) {
+        cerr << "No se puede escribir " << ruta << endl;
+        return 1;
+    }
+    return 0;
+}
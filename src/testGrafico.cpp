@@ -2,78 +2,263 @@
 #include "raylib.h"
 #include "Particula.h"
 #include "ConjuntoParticulas.h"
+#include "Instantanea.h"
+#include "TripleBuffer.h"
+#include "Perfilador.h"
+#include "Gravedad.h"
+#include "SolverPM.h"
+#include "Interacciones.h"
+#include "Emisor.h"
+#include "BuzonParticulas.h"
+#include "ObstaculosEstaticos.h"
+#include "ConjuntoAtractores.h"
 #include "params.h"
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <cstdlib>
 
 const int screenWidth = MAX_X;
 const int screenHeight = MAX_Y;
 
 using namespace std;
 
-void pintarParticula(const Particula & p, Color c) {
-    DrawCircle(p.getPos().getX(), p.getPos().getY(), p.getRadio(), c);
+void pintarAtractores(const ConjuntoAtractores & atractores, Color c) {
+    for (int i = 0; i < atractores.getUtiles(); i++)
+        DrawCircle(atractores.getPos(i).getX(), atractores.getPos(i).getY(), atractores.getRadio(i), c);
 }
 
+void pintarObstaculos(const ObstaculosEstaticos & obstaculos, Color c) {
+    for (int i = 0; i < obstaculos.getUtiles(); i++)
+        DrawCircle(obstaculos.getPos(i).getX(), obstaculos.getPos(i).getY(), obstaculos.getRadio(i), c);
+}
+
+// constante de gravitación cuando se activa la gravedad
+const float G_ATRACTORES = 0.5f;
+
 const int N_COLOR = 6;
 const Color c[N_COLOR] = {RED, BLUE, BLACK, GREEN, YELLOW, MAGENTA};
+
+// segundos transcurridos en el reloj monótono
+double ahora() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// bucle del hilo de simulación: avanza la nube a su ritmo y publica
+// una instantánea tras cada paso
+void simular(ConjuntoParticulas & nube, ConjuntoAtractores & atractores, int modo, int pasosPorSegundo,
+             MotorGravedad * gravedad, SolverPM * pm, MotorInteracciones * interacciones,
+             Emisor * emisores, int numEmisores, const ObstaculosEstaticos & obstaculos, BuzonParticulas & buzon,
+             TripleBuffer<Instantanea> & buffer, atomic<bool> & terminar) {
+    long paso = 0;
+    // con METRICAS=fichero.prom se vuelcan los contadores cada 30 pasos
+    const char* metricas = getenv("METRICAS");
+    auto periodo = chrono::duration<double>(pasosPorSegundo > 0 ? 1.0 / pasosPorSegundo : 0.0);
+    auto siguiente = chrono::steady_clock::now();
+
+    buffer.escribir().capturar(nube, paso, ahora());
+    buffer.publicar();
+
+    while (!terminar.load(memory_order_relaxed) && (nube.getUtiles() > 0 || numEmisores > 0)) {
+        // las altas y bajas se hacen en bloque, en los límites del paso
+        buzon.aplicar(nube);
+        for (int e = 0; e < numEmisores; e++)
+            emisores[e].emitir(nube);
+
+        bool hayGravedad = gravedad != nullptr || pm != nullptr;
+        if (hayGravedad){
+            if (gravedad != nullptr)
+                gravedad->calcular(nube);
+            else
+                pm->calcular(nube);
+            atractores.aplicarCampo(nube, G_ATRACTORES, 5.0f, true);
+        }
+        if (interacciones != nullptr)
+            interacciones->calcular(nube, hayGravedad);
+        nube.mover(modo);
+        nube.rebotarObstaculos(obstaculos);
+        nube.gestionarColisiones();
+        nube.absorber(atractores);
+        nube.envejecer();
+        nube.finPaso();
+        paso++;
+
+        if (metricas != nullptr && paso % 30 == 0)
+            nube.volcarPrometheus(metricas);
+
+        {
+            PERFIL_AMBITO("publicar");
+            buffer.escribir().capturar(nube, paso, ahora());
+            buffer.publicar();
+        }
+        PERFIL_FIN_FRAME();
+
+        if (pasosPorSegundo > 0) {
+            siguiente += chrono::duration_cast<chrono::steady_clock::duration>(periodo);
+            this_thread::sleep_until(siguiente);
+        }
+    }
+}
+
 int main(int argc, char* argv[]) {
     // activación de ventana gráfica
     //---------------------------------------------------------
     int N, modo;
+    int pasosPorSegundo = 30; // velocidad de la simulación (0 = sin límite)
+    int gravedad = 0;
+    int numAtractores = 1;
+    int numTipos = 0;
+    int numEmisores = 0;
+    int numObstaculos = 0;
     if (argc < 3){
-        cout << "USO: testV <nro particulas> <modo>, donde modo = 1 (rebotar), modo=2 (wrap)" << endl;
+        cout << "USO: testV <nro particulas> <modo> [pasos/seg] [gravedad] [atractores] [tipos] [emisores] [obstaculos], donde modo = 1 (rebotar), modo=2 (wrap)" << endl
+             << "     gravedad = 0 (sin gravedad), 1 (suma directa), 2 (Barnes-Hut), 3 (partícula-malla)" << endl
+             << "     tipos = 0 (sin interacción por tipos) o número de tipos con una matriz de fuerzas al azar" << endl
+             << "     emisores = fuentes de partículas con vida limitada (por defecto 0)" << endl
+             << "     obstaculos = obstáculos estáticos en los que rebotan las partículas (por defecto 0)" << endl;
         exit(-1);
     }
     else{
         N = atoi(argv[1]);
         modo = atoi(argv[2]);
+        if (argc > 3)
+            pasosPorSegundo = atoi(argv[3]);
+        if (argc > 4)
+            gravedad = atoi(argv[4]);
+        if (argc > 5)
+            numAtractores = atoi(argv[5]);
+        if (argc > 6)
+            numTipos = atoi(argv[6]);
+        if (argc > 7)
+            numEmisores = atoi(argv[7]);
+        if (argc > 8)
+            numObstaculos = atoi(argv[8]);
     }
 
+#ifdef PERFILADO
+    // con TRAZA=fichero.json se graba además una traza para chrome://tracing
+    const char* traza = getenv("TRAZA");
+    if (traza != nullptr)
+        Perfilador::activarTraza(1 << 20);
+#endif
+
     InitWindow(screenWidth, screenHeight, "Minijuego");
-    int tiempo = 0;
-   
+
     // creación de objetos
     //---------------------------------------------------------
     ConjuntoParticulas nube(N);
 
-    // el agujero negro
-    Particula atractor(1);
-    Vector2D pos(screenWidth/2.0, screenHeight/2.0);
-    atractor.setPos(pos);
-    atractor.setRadio(35.0);
-    
-    
-    
-    SetTargetFPS(30); // velocidad de la simulación
+    // los agujeros negros: el primero en el centro y el resto repartidos al azar
+    ConjuntoAtractores atractores(nube.getMundo());
+    atractores.agregar(Vector2D(screenWidth/2.0, screenHeight/2.0), 35.0);
+    for (int i = 1; i < numAtractores; i++)
+        atractores.agregar(Vector2D(aleatorio(0, screenWidth), aleatorio(0, screenHeight)), aleatorio(5.0, 20.0));
+
+    // la gravedad, si se pide, hace que el agujero negro atraiga a la nube
+    MotorGravedad motor(gravedad == 1 ? MotorGravedad::DIRECTO : MotorGravedad::BARNES_HUT, G_ATRACTORES);
+    // con partícula-malla el contorno sigue al modo: periódico si hay wrap
+    SolverPM pm(128, 128, SolverPM::contornoPara(modo), G_ATRACTORES, 5.0f, nube.getMundo());
+
+    // con tipos, cada partícula recibe uno al azar y la matriz de fuerzas
+    // también se elige al azar
+    MotorInteracciones interacciones(numTipos > 0 ? numTipos : 1);
+    interacciones.aleatorizar(20.0f, 60.0f);
+    interacciones.setPeriodico(modo == 2);
+    for (int i = 0; i < nube.getUtiles() && numTipos > 0; i++)
+        nube.obtener(i).setTipo(aleatorioEntero(0, numTipos - 1));
+
+    // los emisores se reparten al azar; con la capacidad reservada para su
+    // ocupación máxima, la emisión continua no pide memoria
+    Emisor * emisores = new Emisor[numEmisores > 0 ? numEmisores : 1];
+    int reserva = N;
+    for (int e = 0; e < numEmisores; e++) {
+        emisores[e].setPos(Vector2D(aleatorio(0, screenWidth), aleatorio(0, screenHeight)));
+        if (numTipos > 0)
+            emisores[e].setTipo(e % numTipos);
+        reserva += emisores[e].ocupacionMaxima();
+    }
+    nube.reservar(reserva);
+
+    // los obstáculos no se mueven: el árbol se construye una vez
+    ObstaculosEstaticos obstaculos;
+    for (int i = 0; i < numObstaculos; i++)
+        obstaculos.agregar(Vector2D(aleatorio(0, screenWidth), aleatorio(0, screenHeight)), aleatorio(2.0, 6.0));
+    obstaculos.construir();
+
+    // la simulación corre en su propio hilo; a partir de aquí el hilo
+    // principal sólo lee las instantáneas que publica
+    // las partículas que se crean con el ratón se piden desde este hilo
+    // y las agrega el de simulación al principio del paso siguiente
+    TripleBuffer<Instantanea> buffer;
+    BuzonParticulas buzon;
+    atomic<bool> terminar(false);
+    thread hiloSimulacion(simular, ref(nube), ref(atractores), modo, pasosPorSegundo,
+                          (gravedad == 1 || gravedad == 2) ? &motor : nullptr,
+                          gravedad == 3 ? &pm : nullptr,
+                          numTipos > 0 ? &interacciones : nullptr,
+                          emisores, numEmisores, cref(obstaculos), ref(buzon), ref(buffer), ref(terminar));
+
+    SetTargetFPS(60); // velocidad del pintado
     //----------------------------------------------------------
     // bucle principal
     //---------------------------------------------------------
+    Instantanea anterior, actual;
     bool fin = false;
     while (!WindowShouldClose()) // Detect window close button or ESC key
-    {   nube.mover(modo);
-        nube.gestionarColisiones();
-        N = nube.getUtiles();
-        for(int i = N-1; i >= 0; i-- ){
-            if (atractor.colision(nube.obtener(i)))
-                nube.borrar(i);
+    {   if (buffer.actualizar()) {
+            anterior = actual;
+            actual = buffer.leer();
+        }
+
+        // clic: una ráfaga de partículas en la posición del ratón
+        if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+            Vector2 raton = GetMousePosition();
+            for (int k = 0; k < 20; k++) {
+                Vector2D veloc(aleatorio(-MAX_VEL, MAX_VEL), aleatorio(-MAX_VEL, MAX_VEL));
+                int tipo = numTipos > 0 ? aleatorioEntero(0, numTipos - 1) : 0;
+                buzon.pedirAlta(Particula(Vector2D(raton.x, raton.y), Vector2D(), veloc, MIN_R, tipo));
+            }
         }
-        tiempo++;
-        
+
+        // se pinta con un paso de retraso, interpolando entre las dos
+        // últimas instantáneas según el tiempo transcurrido
+        float alfa = 1.0f;
+        bool interpola = actual.interpolable(anterior);
+        if (interpola) {
+            double intervalo = actual.getTiempo() - anterior.getTiempo();
+            if (intervalo > 0)
+                alfa = (ahora() - actual.getTiempo()) / intervalo;
+            if (alfa > 1.0f) alfa = 1.0f;
+            if (alfa < 0.0f) alfa = 0.0f;
+        }
+
         //-----------------------------------------------------
         // pintar los objetos
         //-----------------------------------------------------
 
+        {
+        PERFIL_AMBITO("pintado");
         BeginDrawing();
 
          ClearBackground(RAYWHITE);
-         N = nube.getUtiles();
-         if (N > 0 && !fin){
-             for(int i = 0; i < N; i++)
-               pintarParticula(nube.obtener(i), c[i%N_COLOR]);
-             
-             pintarParticula(atractor, BLACK);
-             
-             string s = "particulas-> " + to_string(N) + " Cap:" + to_string(nube.getCapacidad());
+         N = actual.getUtiles();
+         if ((N > 0 || actual.getPaso() < 0 || numEmisores > 0) && !fin){
+             for(int i = 0; i < N; i++){
+               float x = actual.getX(i), y = actual.getY(i);
+               if (interpola){
+                   x = Instantanea::interpolar(anterior.getX(i), x, alfa, screenWidth);
+                   y = Instantanea::interpolar(anterior.getY(i), y, alfa, screenHeight);
+               }
+               int color = (numTipos > 0) ? actual.getTipo(i) : i;
+               DrawCircle(x, y, actual.getRadio(i), c[color%N_COLOR]);
+             }
+
+             pintarObstaculos(obstaculos, GRAY);
+             pintarAtractores(atractores, BLACK);
+
+             string s = "particulas-> " + to_string(N) + " Cap:" + to_string(actual.getCapacidadConjunto());
              DrawText("ESC para salir", 10, 10, 20, BLACK);
              DrawText(s.c_str(), 10, 40, 20, BLACK);
              }
@@ -83,16 +268,27 @@ int main(int argc, char* argv[]) {
              string s = "FIN DE LA EJECUCION";
              DrawText(s.c_str(), 300, 300, 40, BLACK);
          }
-             
-        
+
+
         EndDrawing();
+        }
+        PERFIL_FIN_FRAME();
         //-----------------------------------------------------
     }
 
-    // cerrar ventana
+    // parar la simulación y cerrar ventana
     //---------------------------------------------------------
-    CloseWindow(); 
+    terminar = true;
+    hiloSimulacion.join();
+    delete [] emisores;
+    CloseWindow();
     //----------------------------------------------------------
 
+#ifdef PERFILADO
+    cout << Perfilador::informe();
+    if (traza != nullptr && !Perfilador::exportarTraza(traza))
+        cerr << "No se puede escribir " << traza << endl;
+#endif
+
     return 0;
 }
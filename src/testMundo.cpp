@@ -0,0 +1,53 @@
+#include "MundoInfinito.h"
+#include "params.h"
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+// Mundo sin límites con la cámara avanzando en diagonal: sólo se simulan los
+// trozos cercanos y los demás se guardan comprimidos (en memoria o en disco).
+// Cada 100 pasos se muestra cuántos trozos hay activos y guardados y cuánta
+// memoria ocupan.
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    if (argc < 3){
+        cerr << "USO: testMundo <nro particulas> <pasos> [memoria|disco] [directorio]" << endl;
+        exit(-1);
+    }
+    int N = atoi(argv[1]);
+    int pasos = atoi(argv[2]);
+    MundoInfinito::Almacen almacen = (argc > 3 && strcmp(argv[3], "disco") == 0)
+                                         ? MundoInfinito::DISCO : MundoInfinito::MEMORIA;
+    string directorio = (argc > 4) ? argv[4] : ".";
+
+    const float LADO = 250.0f;
+    MundoInfinito mundo(LADO, 2, almacen, directorio);
+
+    // Partículas repartidas por una franja diagonal de 40x40 trozos
+    for (int i = 0; i < N; i++) {
+        double d = aleatorio(0.0f, 40 * LADO);
+        double x = d + aleatorio(-2 * LADO, 2 * LADO);
+        double y = d + aleatorio(-2 * LADO, 2 * LADO);
+        Vector2D veloc(aleatorio(-2.0f, 2.0f), aleatorio(-2.0f, 2.0f));
+        mundo.agregar(x, y, Particula(Vector2D(0, 0), Vector2D(0, 0), veloc,
+                                      aleatorio(MIN_R, MAX_R), 0));
+    }
+
+    for (int paso = 0; paso <= pasos; paso++) {
+        double cam = paso * (40 * LADO) / (pasos > 0 ? pasos : 1);
+        mundo.avanzar(cam, cam);
+
+        if (paso % 100 == 0) {
+            cout << "paso " << paso
+                 << "  trozos " << mundo.getTrozosActivos() << "/" << mundo.getTrozos()
+                 << "  particulas " << mundo.getParticulas()
+                 << "  activos " << mundo.getBytesActivos() / 1024 << " KB"
+                 << "  guardados " << mundo.getBytesGuardados() / 1024 << " KB"
+                 << "  cargas " << mundo.getCargas()
+                 << "  descargas " << mundo.getDescargas() << endl;
+        }
+    }
+    return 0;
+}
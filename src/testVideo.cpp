@@ -0,0 +1,140 @@
+
+#include "Particula.h"
+#include "ConjuntoParticulas.h"
+#include "Rasterizador.h"
+#include "EscritorVideo.h"
+#include "Perfilador.h"
+#include "params.h"
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+
+// Genera un vídeo de la simulación sin abrir ventana (servidores sin pantalla).
+// Pinta lo mismo que testGrafico: la nube, el agujero negro y los textos.
+
+using namespace std;
+
+const int N_COLOR = 6;
+const ColorRGBA c[N_COLOR] = {RGBA_RED, RGBA_BLUE, RGBA_BLACK, RGBA_GREEN, RGBA_YELLOW, RGBA_MAGENTA};
+
+// transformación mundo -> píxeles: el mundo se escala para llenar el alto
+// o el ancho del vídeo y se centra en el otro eje
+struct Vista {
+    float escala;
+    float dx, dy;
+};
+
+void pintarParticula(Rasterizador & r, const Vista & v, const Particula & p, ColorRGBA color) {
+    const Vector2D & pos = p.getPos();
+    r.circulo(v.dx + pos.getX() * v.escala, v.dy + pos.getY() * v.escala,
+              p.getRadio() * v.escala, color);
+}
+
+void pintarTexto(Rasterizador & r, const Vista & v, const string & s, int x, int y, int tam) {
+    r.texto(s, v.dx + x * v.escala, v.dy + y * v.escala, tam * v.escala, RGBA_BLACK);
+}
+
+int main(int argc, char* argv[]) {
+    int N, modo, fotogramas;
+    int ancho = 1920, alto = 1080;
+    EscritorVideo::Formato formato = EscritorVideo::Y4M;
+    if (argc < 5){
+        cerr << "USO: testVideo <nro particulas> <modo> <fotogramas> <salida|-> [ancho alto] [y4m|raw]" << endl
+             << "     modo = 1 (rebotar), modo=2 (wrap); '-' escribe en la salida estándar" << endl;
+        exit(-1);
+    }
+    N = atoi(argv[1]);
+    modo = atoi(argv[2]);
+    fotogramas = atoi(argv[3]);
+    string ruta = argv[4];
+    if (argc > 6){
+        ancho = atoi(argv[5]);
+        alto = atoi(argv[6]);
+    }
+    if (argc > 7 && string(argv[7]) == "raw")
+        formato = EscritorVideo::RAW;
+
+#ifdef PERFILADO
+    // con TRAZA=fichero.json se graba además una traza para chrome://tracing
+    const char* traza = getenv("TRAZA");
+    if (traza != nullptr)
+        Perfilador::activarTraza(1 << 20);
+#endif
+
+    Rasterizador r(ancho, alto);
+    EscritorVideo video(ruta, ancho, alto, 30, formato);
+    if (!video.abierto()){
+        cerr << "No se puede abrir " << ruta << " (en y4m el tamaño debe ser par)" << endl;
+        exit(-1);
+    }
+
+    Vista v;
+    v.escala = min(ancho / (float)MAX_X, alto / (float)MAX_Y);
+    v.dx = (ancho - MAX_X * v.escala) / 2;
+    v.dy = (alto - MAX_Y * v.escala) / 2;
+
+    // creación de objetos
+    //---------------------------------------------------------
+    ConjuntoParticulas nube(N);
+
+    // el agujero negro
+    Particula atractor(1);
+    Vector2D pos(MAX_X/2.0, MAX_Y/2.0);
+    atractor.setPos(pos);
+    atractor.setRadio(35.0);
+
+    auto inicio = chrono::steady_clock::now();
+    for (int f = 0; f < fotogramas; f++){
+        nube.mover(modo);
+        nube.gestionarColisiones();
+        nube.absorber(atractor);
+        nube.finPaso();
+
+        // pintar los objetos
+        //-----------------------------------------------------
+        {
+        PERFIL_AMBITO("raster");
+        r.limpiar(RGBA_RAYWHITE);
+        N = nube.getUtiles();
+        if (N > 0){
+            for(const Particula & p : nube.vistaParticulas())
+                pintarParticula(r, v, p, c[p.getTipo() % N_COLOR]);
+            pintarParticula(r, v, atractor, RGBA_BLACK);
+
+            string s = "particulas-> " + to_string(N) + " Cap:" + to_string(nube.getCapacidad());
+            pintarTexto(r, v, "ESC para salir", 10, 10, 20);
+            pintarTexto(r, v, s, 10, 40, 20);
+        }
+        else{
+            pintarTexto(r, v, "ESC para salir", 10, 10, 20);
+            pintarTexto(r, v, "FIN DE LA EJECUCION", 300, 300, 40);
+        }
+        }
+
+        {
+            PERFIL_AMBITO("escritura");
+            if (!video.escribir(r)){
+                cerr << "Error escribiendo el fotograma " << f << endl;
+                exit(-1);
+            }
+        }
+        PERFIL_FIN_FRAME();
+    }
+
+    double seg = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    cerr << video.getFotogramas() << " fotogramas " << ancho << "x" << alto << " en " << seg
+         << " s (" << video.getFotogramas() / seg << " fps)" << endl;
+
+    // con METRICAS=fichero.prom se vuelcan los contadores de la ejecución
+    const char* metricas = getenv("METRICAS");
+    if (metricas != nullptr && !nube.volcarPrometheus(metricas))
+        cerr << "No se puede escribir " << metricas << endl;
+
+#ifdef PERFILADO
+    cerr << Perfilador::informe();
+    if (traza != nullptr && !Perfilador::exportarTraza(traza))
+        cerr << "No se puede escribir " << traza << endl;
+#endif
+
+    return 0;
+}